@@ -0,0 +1,245 @@
+/*
+ * Microbenchmarks for the dialplan functions and applications of res_json,
+ * called the way the pbx core calls them, across document sizes and path
+ * depths.  For every case it prints the time per operation and the number of
+ * allocations per operation (made by the module or by jansson through the
+ * ast_json allocator).
+ *
+ * usage: bench_exec [seconds per case] [case name filter]
+ */
+
+#include "asterisk.h"
+
+#include <time.h>
+
+#include "asterisk/utils.h"
+#include "asterisk/strings.h"
+#include "asterisk/channel.h"
+#include "asterisk/pbx.h"
+#include "asterisk/module.h"
+#include "asterisk/json.h"
+#include "stubs.h"
+
+static double seconds_per_case = 0.3;
+static const char *filter;
+
+static double now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/*! one benchmark case: op runs one operation, on a channel prepared by the caller */
+struct bench_case {
+	const char *name;
+	const char *doc;
+	const char *alternate;    /*!< if set, the doc variable flips between doc and this before each op */
+	void (*op)(struct ast_channel *chan, const struct bench_case *c);
+	const char *arg;
+};
+
+static void op_function(struct ast_channel *chan, const struct bench_case *c)
+{
+	static char buf[1024 * 1024];
+
+	bench_function_read(chan, c->arg, buf, sizeof(buf));
+}
+
+static void op_app(struct ast_channel *chan, const struct bench_case *c)
+{
+	char *app = ast_strdupa(c->arg);
+	char *data = strchr(app, '(');
+
+	*data++ = '\0';
+	data[strlen(data) - 1] = '\0';
+	bench_app_exec(chan, app, data);
+}
+
+static void op_add_delete(struct ast_channel *chan, const struct bench_case *c)
+{
+	/* arg is the parent path: add a member under it, then delete it, so the doc stays the same */
+	char data[512];
+
+	snprintf(data, sizeof(data), "doc,%s,string,benchkey,benchvalue", S_OR(c->arg, "/"));
+	bench_app_exec(chan, "JsonAdd", data);
+	snprintf(data, sizeof(data), "doc,%s/benchkey", c->arg);
+	bench_app_exec(chan, "JsonDelete", data);
+}
+
+static void run(const struct bench_case *c, size_t size, int depth)
+{
+	struct ast_channel *chan;
+	uint64_t allocs;
+	double start, elapsed;
+	long iterations = 0;
+	char *alternate = NULL;
+	const char *result;
+
+	if (filter && !strstr(c->name, filter)) {
+		return;
+	}
+	chan = bench_channel_alloc("Bench/1");
+	pbx_builtin_setvar_helper(chan, "doc", c->doc);
+	/* warm up: compiled paths and cached documents (a document read with a single path is
+	 * only parsed and cached the second time it is read) */
+	c->op(chan, c);
+	c->op(chan, c);
+	result = pbx_builtin_getvar_helper(chan, "JSONRESULT");
+	if (strcmp(S_OR(result, ""), "0")) {
+		printf("%-22s JSONRESULT is %s, skipped\n", c->name, S_OR(result, "not set"));
+		bench_channel_destroy(chan);
+		return;
+	}
+	if (c->alternate) {
+		alternate = ast_strdup(c->alternate);
+	}
+
+	allocs = bench_alloc_count;
+	start = now();
+	do {
+		if (alternate) {
+			pbx_builtin_setvar_helper(chan, "doc", (iterations & 1) ? c->doc : alternate);
+		}
+		c->op(chan, c);
+		iterations++;
+	} while ((elapsed = now() - start) < seconds_per_case);
+	allocs = bench_alloc_count - allocs;
+
+	printf("%-22s %9zu %6d %14.0f %12.1f\n", c->name, size, depth,
+		elapsed / iterations * 1e9, (double)allocs / iterations);
+	ast_free(alternate);
+	bench_channel_destroy(chan);
+}
+
+/*! a document of about size bytes, whose "value" member sits depth levels down */
+static char *make_document(size_t size, int depth, char **path)
+{
+	struct ast_json *doc = ast_json_object_create();
+	struct ast_json *node = doc, *filler = ast_json_array_create();
+	struct ast_str *pathstr = ast_str_create(64);
+	char *text = NULL;
+	int i;
+
+	for (i = 1; i < depth; i++) {
+		struct ast_json *child = ast_json_object_create();
+		char name[16];
+
+		snprintf(name, sizeof(name), "level%d", i);
+		ast_json_object_set(node, "id", ast_json_integer_create(i));
+		ast_json_object_set(node, name, child);
+		ast_str_append(&pathstr, 0, "/%s", name);
+		node = child;
+	}
+	ast_json_object_set(node, "value", ast_json_string_create("the value"));
+	ast_json_object_set(node, "count", ast_json_integer_create(42));
+	ast_json_object_set(node, "active", ast_json_true());
+	ast_str_append(&pathstr, 0, "/value");
+	ast_json_object_set(doc, "filler", filler);
+	for (i = 0; ; i++) {
+		struct ast_json *item = ast_json_object_create();
+
+		ast_json_object_set(item, "id", ast_json_integer_create(i));
+		ast_json_object_set(item, "name", ast_json_string_create("some filler text"));
+		ast_json_object_set(item, "price", ast_json_real_create(i * 0.25));
+		ast_json_array_append(filler, item);
+		if (i % 16 == 0) {
+			ast_json_free(text);
+			text = ast_json_dump_string_format(doc, AST_JSON_COMPACT);
+			if (strlen(text) >= size) {
+				break;
+			}
+		}
+	}
+	ast_json_unref(doc);
+	*path = ast_strdup(ast_str_buffer(pathstr));
+	ast_free(pathstr);
+	return text;
+}
+
+/*! a flat document of about size bytes, for JsonVariables */
+static char *make_flat_document(size_t size)
+{
+	struct ast_json *doc = ast_json_object_create();
+	char *text = NULL;
+	int i;
+
+	for (i = 0; ; i++) {
+		char name[32];
+
+		snprintf(name, sizeof(name), "var%d", i);
+		ast_json_object_set(doc, name, (i % 2) ? ast_json_string_create("value") : ast_json_integer_create(i));
+		if (i % 16 == 0) {
+			ast_json_free(text);
+			text = ast_json_dump_string_format(doc, AST_JSON_COMPACT);
+			if (strlen(text) >= size) {
+				break;
+			}
+		}
+	}
+	ast_json_unref(doc);
+	return text;
+}
+
+int main(int argc, char **argv)
+{
+	static const size_t sizes[] = { 1024, 16 * 1024, 256 * 1024 };
+	static const int depths[] = { 1, 4, 16 };
+	size_t s, d;
+
+	if (argc > 1) {
+		seconds_per_case = atof(argv[1]);
+	}
+	if (argc > 2) {
+		filter = argv[2];
+	}
+	bench_module->load();
+	printf("%-22s %9s %6s %14s %12s\n", "case", "bytes", "depth", "ns/op", "allocs/op");
+
+	for (s = 0; s < ARRAY_LEN(sizes); s++) {
+		for (d = 0; d < ARRAY_LEN(depths); d++) {
+			char *path, *parent, *doc = make_document(sizes[s], depths[d], &path);
+			char *changed = ast_malloc(strlen(doc) + 2);
+			char get[256], multi[768], set[256];
+
+			/* the same document with one more blank, so its cached form does not match */
+			sprintf(changed, "%s ", doc);
+			parent = ast_strdupa(path);
+			*strrchr(parent, '/') = '\0';
+			snprintf(get, sizeof(get), "JSONGET(doc,%s)", path);
+			snprintf(multi, sizeof(multi), "JSONGET(doc,%s,%s/count,%s/active)", path, parent, parent);
+			snprintf(set, sizeof(set), "JsonSet(doc,%s,other value)", path);
+			{
+				const struct bench_case cases[] = {
+					{ "JSONGET", doc, NULL, op_function, get },
+					{ "JSONGET/changed", doc, changed, op_function, get },
+					{ "JSONGET/3paths", doc, NULL, op_function, multi },
+					{ "JSONGET/3paths/changed", doc, changed, op_function, multi },
+					{ "JSONPRETTY", doc, NULL, op_function, "JSONPRETTY(doc)" },
+					{ "JSONCOMPRESS", doc, NULL, op_function, "JSONCOMPRESS(doc)" },
+					{ "JSONCOMPRESS/changed", doc, changed, op_function, "JSONCOMPRESS(doc)" },
+					{ "JsonSet", doc, NULL, op_app, set },
+					{ "JsonAdd+JsonDelete", doc, NULL, op_add_delete, parent },
+				};
+				size_t i;
+
+				for (i = 0; i < ARRAY_LEN(cases); i++) {
+					run(&cases[i], strlen(doc), depths[d]);
+				}
+			}
+			ast_free(changed);
+			ast_free(path);
+			ast_json_free(doc);
+		}
+		{
+			char *flat = make_flat_document(sizes[s]);
+			const struct bench_case flatcase = { "JsonVariables", flat, NULL, op_app, "JsonVariables(doc)" };
+
+			run(&flatcase, strlen(flat), 1);
+			ast_json_free(flat);
+		}
+	}
+	bench_module->unload();
+	return 0;
+}
@@ -0,0 +1,147 @@
+/*
+ * Text scanner throughput: how many bytes per second JSONGET gets through when
+ * it reads one element straight from the document text (for each scanner
+ * variant the cpu supports), against parsing the document with jansson.
+ *
+ * The module is compiled into this program so the scanner can be driven
+ * directly; see build.sh.
+ */
+
+#include "../res_json.c"
+
+#include <time.h>
+
+#include "stubs.h"
+
+#define BENCH_MIN_SECONDS 0.5
+
+static double now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/*! a catalogue-like document of about the given size, compact or pretty printed */
+static char *make_document(size_t size, int pretty)
+{
+	struct ast_json *doc = ast_json_object_create();
+	struct ast_json *items = ast_json_array_create();
+	struct ast_json *meta = ast_json_object_create();
+	char *text = NULL;
+	int i;
+
+	ast_json_object_set(meta, "source", ast_json_string_create("crm"));
+	ast_json_object_set(meta, "count", ast_json_integer_create(0));
+	ast_json_object_set(doc, "meta", meta);
+	ast_json_object_set(doc, "items", items);
+	for (i = 0; ; i++) {
+		struct ast_json *item = ast_json_object_create();
+		struct ast_json *tags = ast_json_array_create();
+		char buf[64];
+
+		ast_json_object_set(item, "id", ast_json_integer_create(100000 + i));
+		snprintf(buf, sizeof(buf), "SKU-%06d", i);
+		ast_json_object_set(item, "sku", ast_json_string_create(buf));
+		snprintf(buf, sizeof(buf), "Product number %d, caf\xc3\xa9 edition", i);
+		ast_json_object_set(item, "name", ast_json_string_create(buf));
+		ast_json_object_set(item, "price", ast_json_real_create(9.99 + i % 100));
+		ast_json_object_set(item, "active", (i % 3) ? ast_json_true() : ast_json_false());
+		ast_json_array_append(tags, ast_json_string_create("catalogue"));
+		ast_json_array_append(tags, ast_json_string_create((i % 2) ? "even" : "odd"));
+		ast_json_object_set(item, "tags", tags);
+		ast_json_object_set(item, "description", ast_json_string_create(
+			"A fairly long description of the product, the way product feeds carry them; "
+			"it has \"quotes\", a tab\tand a line break\nso that the escapes get some exercise too."));
+		ast_json_array_append(items, item);
+		if (i % 64 == 0) {
+			ast_json_free(text);
+			text = ast_json_dump_string_format(doc, pretty ? AST_JSON_PRETTY : AST_JSON_COMPACT);
+			if (strlen(text) >= size) {
+				break;
+			}
+		}
+	}
+	ast_json_unref(doc);
+	return text;
+}
+
+static void report(const char *what, const char *variant, size_t len, int iterations, double elapsed)
+{
+	printf("  %-22s %-8s %10.1f MB/s  %10.1f us/doc\n", what, variant,
+		len * (double)iterations / elapsed / 1e6, elapsed / iterations * 1e6);
+}
+
+static void bench_jansson(const char *text, size_t len)
+{
+	int iterations = 0;
+	double start = now(), elapsed;
+
+	do {
+		struct ast_json *doc = ast_json_load_string(text, NULL);
+
+		ast_json_unref(doc);
+		iterations++;
+	} while ((elapsed = now() - start) < BENCH_MIN_SECONDS);
+	report("jansson parse", "", len, iterations, elapsed);
+}
+
+static void bench_scan(const char *text, size_t len, const char *pathstring, const char *variant)
+{
+	struct json_path *path = json_path_get(pathstring);
+	struct json_scan_value value;
+	int iterations = 0, ret = 0;
+	double start = now(), elapsed;
+	char what[64];
+
+	do {
+		ret |= json_scan_doc(text, len, path, NULL, &value);
+		iterations++;
+	} while ((elapsed = now() - start) < BENCH_MIN_SECONDS);
+	ao2_ref(path, -1);
+	if (ret < 0) {
+		printf("  scanner gave up on %s\n", pathstring);
+		return;
+	}
+	snprintf(what, sizeof(what), "scan %s", pathstring);
+	report(what, variant, len, iterations, elapsed);
+}
+
+int main(int argc, char **argv)
+{
+	size_t size = (argc > 1) ? strtoul(argv[1], NULL, 10) : 512 * 1024;
+	int pretty;
+
+	bench_module->load();
+	printf("best scanner on this cpu: %s\n", json_scan_isa);
+	for (pretty = 0; pretty < 2; pretty++) {
+		char *text = make_document(size, pretty);
+		size_t len = strlen(text);
+
+		printf("%s document, %zu bytes\n", pretty ? "pretty printed" : "compact", len);
+		bench_jansson(text, len);
+
+		json_scan_plain = json_scan_plain_scalar;
+		json_scan_blank = json_scan_blank_scalar;
+		bench_scan(text, len, "/meta/count", "scalar");
+		bench_scan(text, len, "/items/1000/sku", "scalar");
+#ifdef JSON_SCAN_X86
+		if (__builtin_cpu_supports("sse4.2")) {
+			json_scan_plain = json_scan_plain_sse42;
+			json_scan_blank = json_scan_blank_sse42;
+			bench_scan(text, len, "/meta/count", "sse4.2");
+			bench_scan(text, len, "/items/1000/sku", "sse4.2");
+		}
+		if (__builtin_cpu_supports("avx2")) {
+			json_scan_plain = json_scan_plain_avx2;
+			json_scan_blank = json_scan_blank_avx2;
+			bench_scan(text, len, "/meta/count", "avx2");
+			bench_scan(text, len, "/items/1000/sku", "avx2");
+		}
+#endif
+		ast_json_free(text);
+	}
+	bench_module->unload();
+	return 0;
+}
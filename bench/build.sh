@@ -0,0 +1,10 @@
+#!/bin/sh
+# builds the benchmarks against the stand-in Asterisk core in this directory;
+# needs a C compiler and the jansson headers and library (libjansson-dev)
+cd "$(dirname "$0")" || exit 1
+CC=${CC:-cc}
+CFLAGS=${CFLAGS:--O2 -g}
+$CC $CFLAGS -Iinclude -I. -o bench_exec bench_exec.c ../res_json.c stubs.c json.c -ljansson -lm -lpthread || exit 1
+$CC $CFLAGS -Iinclude -I. -o bench_scan bench_scan.c stubs.c json.c -ljansson -lm -lpthread || exit 1
+$CC $CFLAGS -Iinclude -I. -o check_writeback check_writeback.c ../res_json.c stubs.c json.c -ljansson -lm -lpthread || exit 1
+echo "built bench/bench_exec, bench/bench_scan and bench/check_writeback"
@@ -0,0 +1,89 @@
+/*
+ * Regression check for lazy write-back: a doc variable set by the dialplan
+ * after an app changed it (but before the change was written back) keeps the
+ * new value, whether the pending change is flushed with JSON_FLUSH or evicted
+ * from the channel's document cache.
+ *
+ * usage: check_writeback (exits 1 if a check fails)
+ */
+
+#include "asterisk.h"
+
+#include <unistd.h>
+
+#include "asterisk/utils.h"
+#include "asterisk/strings.h"
+#include "asterisk/channel.h"
+#include "asterisk/pbx.h"
+#include "asterisk/module.h"
+#include "stubs.h"
+
+static int failures;
+
+static void expect(struct ast_channel *chan, const char *what, const char *varname, const char *value)
+{
+	const char *got = S_OR(pbx_builtin_getvar_helper(chan, varname), "");
+
+	if (strcmp(got, value)) {
+		printf("FAIL %s: %s is '%s', expected '%s'\n", what, varname, got, value);
+		failures++;
+	} else {
+		printf("ok   %s\n", what);
+	}
+}
+
+static void configure(const char *dir, const char *settings)
+{
+	char path[PATH_MAX];
+	FILE *f;
+
+	snprintf(path, sizeof(path), "%s/res_json.conf", dir);
+	if (!(f = fopen(path, "w"))) {
+		perror(path);
+		exit(1);
+	}
+	fprintf(f, "[general]\n%s", settings);
+	fclose(f);
+	bench_module->reload();
+}
+
+int main(void)
+{
+	char dir[] = "/tmp/res_json_check.XXXXXX", path[PATH_MAX], buf[256];
+	struct ast_channel *chan;
+
+	if (!mkdtemp(dir)) {
+		perror("mkdtemp");
+		return 1;
+	}
+	setenv("BENCH_CONFIG_DIR", dir, 1);
+	bench_module->load();
+	chan = bench_channel_alloc("Check/1");
+
+	configure(dir, "writeback = lazy\n");
+	pbx_builtin_setvar_helper(chan, "doc", "{\"a\":1}");
+	bench_app_exec(chan, "JsonSet", "doc,a,2");
+	expect(chan, "lazy change not written yet", "doc", "{\"a\":1}");
+	bench_function_read(chan, "JSON_FLUSH(doc)", buf, sizeof(buf));
+	expect(chan, "lazy change flushed", "doc", "{\"a\":2}");
+	bench_app_exec(chan, "JsonSet", "doc,a,3");
+	pbx_builtin_setvar_helper(chan, "doc", "{\"fresh\":true}");
+	bench_function_read(chan, "JSON_FLUSH()", buf, sizeof(buf));
+	expect(chan, "outside Set survives JSON_FLUSH", "doc", "{\"fresh\":true}");
+
+	configure(dir, "writeback = lazy\ncachedocs = 1\n");
+	pbx_builtin_setvar_helper(chan, "doc", "{\"a\":1}");
+	bench_app_exec(chan, "JsonSet", "doc,a,2");
+	pbx_builtin_setvar_helper(chan, "doc", "{\"fresh\":true}");
+	pbx_builtin_setvar_helper(chan, "other", "{\"b\":1}");
+	bench_function_read(chan, "JSONGET(other,b)", buf, sizeof(buf));
+	expect(chan, "outside Set survives eviction", "doc", "{\"fresh\":true}");
+
+	bench_channel_destroy(chan);
+	bench_module->unload();
+	snprintf(path, sizeof(path), "%s/res_json.conf", dir);
+	unlink(path);
+	rmdir(dir);
+	printf("%s\n", failures ? "FAILED" : "passed");
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,34 @@
+/*
+ * Minimal stand-ins for the Asterisk core headers, just enough to compile
+ * res_json.c outside of an Asterisk source tree.  See bench/README.
+ */
+
+#ifndef _BENCH_ASTERISK_H
+#define _BENCH_ASTERISK_H
+
+#define _GNU_SOURCE 1
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <limits.h>
+#include <math.h>
+#include <alloca.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/time.h>
+
+/* what configure would find on linux */
+#ifdef __linux__
+#define HAVE_INOTIFY 1
+#endif
+
+#define ASTERISK_GPL_KEY "bench"
+#define AST_MODULE_SELF NULL
+
+#endif
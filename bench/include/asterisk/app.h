@@ -0,0 +1,28 @@
+#ifndef _BENCH_ASTERISK_APP_H
+#define _BENCH_ASTERISK_APP_H
+
+#include <stddef.h>
+
+#define AST_APP_ARG(name) char *name
+
+#define AST_DECLARE_APP_ARGS(name, arglist) AST_DEFINE_APP_ARGS_TYPE(argtype_##name, arglist) name = { 0, }
+
+#define AST_DEFINE_APP_ARGS_TYPE(type, arglist) \
+	struct type { \
+		unsigned int argc; \
+		char *argv[0]; \
+		arglist \
+	}
+
+#define AST_STANDARD_APP_ARGS(args, parse) \
+	args.argc = __ast_app_separate_args(parse, ',', 1, args.argv, ((sizeof(args) - offsetof(typeof(args), argv)) / sizeof(args.argv[0])))
+#define AST_STANDARD_RAW_ARGS(args, parse) \
+	args.argc = __ast_app_separate_args(parse, ',', 0, args.argv, ((sizeof(args) - offsetof(typeof(args), argv)) / sizeof(args.argv[0])))
+#define AST_NONSTANDARD_APP_ARGS(args, parse, sep) \
+	args.argc = __ast_app_separate_args(parse, sep, 1, args.argv, ((sizeof(args) - offsetof(typeof(args), argv)) / sizeof(args.argv[0])))
+#define AST_NONSTANDARD_RAW_ARGS(args, parse, sep) \
+	args.argc = __ast_app_separate_args(parse, sep, 0, args.argv, ((sizeof(args) - offsetof(typeof(args), argv)) / sizeof(args.argv[0])))
+
+unsigned int __ast_app_separate_args(char *buf, char delim, int remove_chars, char **array, int arraylen);
+
+#endif
@@ -0,0 +1,170 @@
+#ifndef _BENCH_ASTERISK_ASTOBJ2_H
+#define _BENCH_ASTERISK_ASTOBJ2_H
+
+/* reference counted objects and a (linear, but API compatible) container */
+
+typedef void (*ao2_destructor_fn)(void *vdoomed);
+
+enum ao2_alloc_opts {
+	AO2_ALLOC_OPT_LOCK_MUTEX = (0 << 0),
+	AO2_ALLOC_OPT_LOCK_RWLOCK = (1 << 0),
+	AO2_ALLOC_OPT_LOCK_NOLOCK = (2 << 0),
+	AO2_ALLOC_OPT_LOCK_OBJ = AO2_ALLOC_OPT_LOCK_MUTEX | AO2_ALLOC_OPT_LOCK_RWLOCK,
+	AO2_ALLOC_OPT_LOCK_MASK = (3 << 0),
+	AO2_ALLOC_OPT_NO_REF_DEBUG = (1 << 2),
+};
+
+void *__bench_ao2_alloc(size_t data_size, ao2_destructor_fn destructor_fn, unsigned int options);
+int __bench_ao2_ref(void *o, int delta);
+void __bench_ao2_lock(void *o, int write);
+void __bench_ao2_unlock(void *o);
+
+#define ao2_alloc_options(data_size, destructor_fn, options) __bench_ao2_alloc((data_size), (destructor_fn), (options))
+#define ao2_t_alloc_options(data_size, destructor_fn, options, debug_msg) __bench_ao2_alloc((data_size), (destructor_fn), (options))
+#define ao2_alloc(data_size, destructor_fn) __bench_ao2_alloc((data_size), (destructor_fn), AO2_ALLOC_OPT_LOCK_MUTEX)
+#define ao2_ref(o, delta) __bench_ao2_ref((o), (delta))
+#define ao2_t_ref(o, delta, tag) __bench_ao2_ref((o), (delta))
+#define ao2_bump(obj) ({ typeof(obj) __obj_ ## __LINE__ = (obj); if (__obj_ ## __LINE__) ao2_ref(__obj_ ## __LINE__, +1); __obj_ ## __LINE__; })
+#define ao2_cleanup(obj) do { void *__o = (obj); if (__o) ao2_ref(__o, -1); } while (0)
+#define ao2_replace(dst, src) do { typeof(dst) *__dst_ptr = &(dst); typeof(src) __src = (src); if (__src != *__dst_ptr) { ao2_bump(__src); ao2_cleanup(*__dst_ptr); *__dst_ptr = __src; } } while (0)
+#define ao2_lock(a) __bench_ao2_lock((a), 1)
+#define ao2_rdlock(a) __bench_ao2_lock((a), 0)
+#define ao2_wrlock(a) __bench_ao2_lock((a), 1)
+#define ao2_unlock(a) __bench_ao2_unlock(a)
+
+#define RAII_VAR(vartype, varname, initval, dtor) \
+	auto void _dtor_ ## varname (vartype * v); \
+	void _dtor_ ## varname (vartype * v) { dtor(*v); } \
+	vartype varname __attribute__((cleanup(_dtor_ ## varname))) = (initval)
+
+/* global objects */
+struct ao2_global_obj {
+	pthread_rwlock_t lock;
+	void *obj;
+};
+
+#define AO2_GLOBAL_OBJ_STATIC(name) \
+	struct ao2_global_obj name = { .lock = PTHREAD_RWLOCK_INITIALIZER, .obj = NULL }
+
+void *__bench_ao2_global_obj_replace(struct ao2_global_obj *holder, void *obj);
+void *__bench_ao2_global_obj_ref(struct ao2_global_obj *holder);
+
+#define ao2_global_obj_replace(holder, obj) __bench_ao2_global_obj_replace(&(holder), (obj))
+#define ao2_global_obj_replace_unref(holder, obj) do { void *__old = __bench_ao2_global_obj_replace(&(holder), (obj)); ao2_cleanup(__old); } while (0)
+#define ao2_global_obj_release(holder) ao2_global_obj_replace_unref(holder, NULL)
+#define ao2_global_obj_ref(holder) __bench_ao2_global_obj_ref(&(holder))
+
+/* containers */
+enum search_flags {
+	OBJ_UNLINK = (1 << 0),
+	OBJ_NODATA = (1 << 1),
+	OBJ_MULTIPLE = (1 << 2),
+	OBJ_POINTER = (1 << 3),
+	OBJ_CONTINUE = (1 << 4),
+	OBJ_NOLOCK = (1 << 5),
+	OBJ_SEARCH_MASK = (0x07 << 6),
+	OBJ_SEARCH_NONE = (0 << 6),
+	OBJ_SEARCH_OBJECT = (1 << 6),
+	OBJ_SEARCH_KEY = (2 << 6),
+	OBJ_SEARCH_PARTIAL_KEY = (4 << 6),
+	OBJ_ORDER_MASK = (0x03 << 9),
+	OBJ_ORDER_ASCENDING = (0 << 9),
+	OBJ_ORDER_DESCENDING = (1 << 9),
+	OBJ_ORDER_PRE = (2 << 9),
+	OBJ_ORDER_POST = (3 << 9),
+};
+#define OBJ_KEY OBJ_SEARCH_KEY
+
+enum _cb_results {
+	CMP_MATCH = 0x1,
+	CMP_STOP = 0x2,
+};
+
+enum ao2_container_opts {
+	AO2_CONTAINER_ALLOC_OPT_DUPS_ALLOW = (0 << 1),
+	AO2_CONTAINER_ALLOC_OPT_DUPS_REJECT = (1 << 1),
+	AO2_CONTAINER_ALLOC_OPT_DUPS_OBJ_REJECT = (2 << 1),
+	AO2_CONTAINER_ALLOC_OPT_DUPS_REPLACE = (3 << 1),
+};
+
+typedef int (ao2_callback_fn)(void *obj, void *arg, int flags);
+typedef int (ao2_hash_fn)(const void *obj, int flags);
+typedef int (ao2_sort_fn)(const void *obj_left, const void *obj_right, int flags);
+
+struct ao2_container;
+
+struct ao2_container *__bench_ao2_container_alloc(unsigned int container_options, ao2_hash_fn *hash_fn, ao2_sort_fn *sort_fn, ao2_callback_fn *cmp_fn);
+#define ao2_container_alloc_hash(ao2_options, container_options, n_buckets, hash_fn, sort_fn, cmp_fn) \
+	__bench_ao2_container_alloc((container_options), (hash_fn), (sort_fn), (cmp_fn))
+#define ao2_container_alloc_list(ao2_options, container_options, sort_fn, cmp_fn) \
+	__bench_ao2_container_alloc((container_options), NULL, (sort_fn), (cmp_fn))
+
+int ao2_container_count(struct ao2_container *c);
+int __bench_ao2_link(struct ao2_container *c, void *obj, int flags);
+#define ao2_link(container, obj) __bench_ao2_link((container), (obj), 0)
+#define ao2_link_flags(container, obj, flags) __bench_ao2_link((container), (obj), (flags))
+void *__bench_ao2_unlink(struct ao2_container *c, void *obj, int flags);
+#define ao2_unlink(container, obj) __bench_ao2_unlink((container), (obj), 0)
+#define ao2_unlink_flags(container, obj, flags) __bench_ao2_unlink((container), (obj), (flags))
+void *ao2_callback(struct ao2_container *c, int flags, ao2_callback_fn *cb_fn, void *arg);
+void *ao2_find(struct ao2_container *c, const void *arg, int flags);
+
+struct ao2_iterator {
+	struct ao2_container *c;
+	int pos;
+	int flags;
+};
+enum ao2_iterator_flags {
+	AO2_ITERATOR_DONTLOCK = (1 << 0),
+	AO2_ITERATOR_MALLOCD = (1 << 1),
+	AO2_ITERATOR_UNLINK = (1 << 2),
+	AO2_ITERATOR_DESCENDING = (1 << 3),
+};
+struct ao2_iterator ao2_iterator_init(struct ao2_container *c, int flags);
+void *ao2_iterator_next(struct ao2_iterator *iter);
+void ao2_iterator_destroy(struct ao2_iterator *iter);
+
+#define AO2_STRING_FIELD_HASH_FN(stype, field) \
+static int stype ## _hash_fn(const void *obj, const int flags) \
+{ \
+	const struct stype *object = obj; \
+	const char *key; \
+	switch (flags & OBJ_SEARCH_MASK) { \
+	case OBJ_SEARCH_KEY: \
+		key = obj; \
+		break; \
+	case OBJ_SEARCH_OBJECT: \
+		key = object->field; \
+		break; \
+	default: \
+		return 0; \
+	} \
+	return ast_str_hash(key); \
+}
+
+#define AO2_STRING_FIELD_CMP_FN(stype, field) \
+static int stype ## _cmp_fn(void *obj, void *arg, int flags) \
+{ \
+	const struct stype *object_left = obj, *object_right = arg; \
+	const char *right_key = arg; \
+	int cmp; \
+	switch (flags & OBJ_SEARCH_MASK) { \
+	case OBJ_SEARCH_OBJECT: \
+		right_key = object_right->field; \
+	case OBJ_SEARCH_KEY: \
+		cmp = strcmp(object_left->field, right_key); \
+		break; \
+	case OBJ_SEARCH_PARTIAL_KEY: \
+		cmp = strncmp(object_left->field, right_key, strlen(right_key)); \
+		break; \
+	default: \
+		cmp = 0; \
+		break; \
+	} \
+	if (cmp) { \
+		return 0; \
+	} \
+	return CMP_MATCH; \
+}
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef _BENCH_ASTERISK_CHANNEL_H
+#define _BENCH_ASTERISK_CHANNEL_H
+
+#include "asterisk/utils.h"
+#include "asterisk/datastore.h"
+#include "asterisk/linkedlists.h"
+
+struct bench_var {
+	AST_LIST_ENTRY(bench_var) entry;
+	char *value;
+	char name[0];
+};
+
+/*! the harness channel: a variable list, a datastore list and the dialplan location */
+struct ast_channel {
+	ast_mutex_t lock;
+	char name[64];
+	char context[80];
+	char exten[80];
+	int priority;
+	int hungup;
+	AST_LIST_HEAD_NOLOCK(, bench_var) varshead;
+	AST_LIST_HEAD_NOLOCK(, ast_datastore) datastores;
+};
+
+struct ast_channel *bench_channel_alloc(const char *name);
+void bench_channel_destroy(struct ast_channel *chan);
+
+#define ast_channel_lock(chan) ast_mutex_lock(&(chan)->lock)
+#define ast_channel_unlock(chan) ast_mutex_unlock(&(chan)->lock)
+
+static inline const char *ast_channel_name(const struct ast_channel *chan) { return chan->name; }
+static inline const char *ast_channel_context(const struct ast_channel *chan) { return chan->context; }
+static inline const char *ast_channel_exten(const struct ast_channel *chan) { return chan->exten; }
+static inline int ast_channel_priority(const struct ast_channel *chan) { return chan->priority; }
+static inline int ast_check_hangup(struct ast_channel *chan) { return chan->hungup; }
+
+int ast_channel_datastore_add(struct ast_channel *chan, struct ast_datastore *datastore);
+int ast_channel_datastore_remove(struct ast_channel *chan, struct ast_datastore *datastore);
+struct ast_datastore *ast_channel_datastore_find(struct ast_channel *chan, const struct ast_datastore_info *info, const char *uid);
+
+#endif
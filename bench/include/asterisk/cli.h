@@ -0,0 +1,47 @@
+#ifndef _BENCH_ASTERISK_CLI_H
+#define _BENCH_ASTERISK_CLI_H
+
+#define CLI_SUCCESS (char *)RESULT_SUCCESS
+#define CLI_SHOWUSAGE (char *)RESULT_SHOWUSAGE
+#define CLI_FAILURE (char *)RESULT_FAILURE
+
+#define RESULT_SUCCESS 0
+#define RESULT_SHOWUSAGE 1
+#define RESULT_FAILURE 2
+
+enum { CLI_INIT = -2, CLI_GENERATE = -3 };
+
+struct ast_cli_args {
+	const int fd;
+	const int argc;
+	const char * const *argv;
+	const char *line;
+	const char *word;
+	const int pos;
+	int n;
+};
+
+struct ast_cli_entry;
+typedef char *(*cli_fn)(struct ast_cli_entry *e, int cmd, struct ast_cli_args *a);
+
+struct ast_cli_entry {
+	const char *cmda[16];
+	const char * const summary;
+	const char * usage;
+	int inuse;
+	struct ast_module *module;
+	char *_full_cmd;
+	int cmdlen;
+	int args;
+	char *command;
+	cli_fn handler;
+};
+
+#define AST_CLI_DEFINE(fn, txt , ... ) { .handler = fn, .summary = txt, ## __VA_ARGS__ }
+
+void ast_cli(int fd, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+int ast_cli_register_multiple(struct ast_cli_entry *e, int len);
+int ast_cli_unregister_multiple(struct ast_cli_entry *e, int len);
+char *ast_cli_complete(const char *word, const char * const choices[], int pos);
+
+#endif
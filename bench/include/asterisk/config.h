@@ -0,0 +1,30 @@
+#ifndef _BENCH_ASTERISK_CONFIG_H
+#define _BENCH_ASTERISK_CONFIG_H
+
+#include "asterisk/utils.h"
+
+struct ast_config;
+
+struct ast_variable {
+	const char *name;
+	const char *value;
+	struct ast_variable *next;
+};
+
+#define CONFIG_FLAG_FILEUNCHANGED  (1 << 1)
+
+#define CONFIG_STATUS_FILEMISSING  (void *)0
+#define CONFIG_STATUS_FILEUNCHANGED (void *)-1
+#define CONFIG_STATUS_FILEINVALID  (void *)-2
+
+/*!
+ * \brief reads an .ini style file from the directory named by the
+ * BENCH_CONFIG_DIR environment variable (the current one by default)
+ */
+struct ast_config *ast_config_load2(const char *filename, const char *who_asked, struct ast_flags flags);
+#define ast_config_load(filename, flags) ast_config_load2(filename, "bench", flags)
+void ast_config_destroy(struct ast_config *cfg);
+struct ast_variable *ast_variable_browse(const struct ast_config *config, const char *category);
+const char *ast_variable_retrieve(struct ast_config *config, const char *category, const char *variable);
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef _BENCH_ASTERISK_DATASTORE_H
+#define _BENCH_ASTERISK_DATASTORE_H
+
+#include "asterisk/linkedlists.h"
+
+struct ast_channel;
+
+#define DATASTORE_INHERIT_FOREVER INT_MAX
+
+struct ast_datastore_info {
+	const char *type;
+	void *(*duplicate)(void *data);
+	void (*destroy)(void *data);
+	void (*chan_fixup)(void *data, struct ast_channel *old_chan, struct ast_channel *new_chan);
+	void (*chan_breakdown)(void *data, struct ast_channel *old_chan, struct ast_channel *new_chan);
+};
+
+struct ast_datastore {
+	const char *uid;
+	void *data;
+	const struct ast_datastore_info *info;
+	unsigned int inheritance;
+	AST_LIST_ENTRY(ast_datastore) entry;
+};
+
+struct ast_datastore *ast_datastore_alloc(const struct ast_datastore_info *info, const char *uid);
+int ast_datastore_free(struct ast_datastore *datastore);
+
+#endif
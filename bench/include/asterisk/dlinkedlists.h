@@ -0,0 +1,63 @@
+#ifndef _BENCH_ASTERISK_DLINKEDLISTS_H
+#define _BENCH_ASTERISK_DLINKEDLISTS_H
+
+#define AST_DLLIST_HEAD_NOLOCK(name, type) \
+struct name { \
+	struct type *first; \
+	struct type *last; \
+}
+#define AST_DLLIST_HEAD_NOLOCK_INIT_VALUE { NULL, NULL }
+#define AST_DLLIST_HEAD_NOLOCK_STATIC(name, type) \
+struct name { \
+	struct type *first; \
+	struct type *last; \
+} name = AST_DLLIST_HEAD_NOLOCK_INIT_VALUE
+#define AST_DLLIST_HEAD_INIT_NOLOCK(head) do { (head)->first = NULL; (head)->last = NULL; } while (0)
+#define AST_DLLIST_ENTRY(type) struct { struct type *prev; struct type *next; }
+#define AST_DLLIST_FIRST(head) ((head)->first)
+#define AST_DLLIST_LAST(head) ((head)->last)
+#define AST_DLLIST_NEXT(elm, field) ((elm)->field.next)
+#define AST_DLLIST_PREV(elm, field) ((elm)->field.prev)
+#define AST_DLLIST_EMPTY(head) (AST_DLLIST_FIRST(head) == NULL)
+#define AST_DLLIST_TRAVERSE(head, var, field) for ((var) = (head)->first; (var); (var) = (var)->field.next)
+#define AST_DLLIST_INSERT_HEAD(head, elm, field) do { \
+		(elm)->field.prev = NULL; \
+		(elm)->field.next = (head)->first; \
+		if ((head)->first) \
+			(head)->first->field.prev = (elm); \
+		(head)->first = (elm); \
+		if (!(head)->last) \
+			(head)->last = (elm); \
+	} while (0)
+#define AST_DLLIST_INSERT_TAIL(head, elm, field) do { \
+		(elm)->field.next = NULL; \
+		(elm)->field.prev = (head)->last; \
+		if ((head)->last) \
+			(head)->last->field.next = (elm); \
+		(head)->last = (elm); \
+		if (!(head)->first) \
+			(head)->first = (elm); \
+	} while (0)
+#define AST_DLLIST_REMOVE(head, elm, field) do { \
+		__typeof(elm) __elm = (elm); \
+		if (__elm) { \
+			if (__elm->field.next) \
+				__elm->field.next->field.prev = __elm->field.prev; \
+			else \
+				(head)->last = __elm->field.prev; \
+			if (__elm->field.prev) \
+				__elm->field.prev->field.next = __elm->field.next; \
+			else \
+				(head)->first = __elm->field.next; \
+			__elm->field.next = NULL; \
+			__elm->field.prev = NULL; \
+		} \
+	} while (0)
+#define AST_DLLIST_REMOVE_HEAD(head, field) ({ \
+		typeof((head)->first) cur = (head)->first; \
+		if (cur) \
+			AST_DLLIST_REMOVE(head, cur, field); \
+		cur; \
+	})
+
+#endif
@@ -0,0 +1,4 @@
+#ifndef _BENCH_ASTERISK_FILE_H
+#define _BENCH_ASTERISK_FILE_H
+/* nothing from file.h is used by res_json */
+#endif
@@ -0,0 +1,107 @@
+#ifndef _BENCH_ASTERISK_JSON_H
+#define _BENCH_ASTERISK_JSON_H
+
+/* the subset of the Asterisk JSON API that res_json uses; implemented over jansson in bench/json.c */
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct ast_json;
+
+enum ast_json_type {
+	AST_JSON_OBJECT,
+	AST_JSON_ARRAY,
+	AST_JSON_STRING,
+	AST_JSON_INTEGER,
+	AST_JSON_REAL,
+	AST_JSON_TRUE,
+	AST_JSON_FALSE,
+	AST_JSON_NULL,
+};
+
+enum ast_json_encoding_format {
+	AST_JSON_COMPACT,
+	AST_JSON_PRETTY,
+};
+
+#define AST_JSON_ERROR_TEXT_LENGTH    160
+#define AST_JSON_ERROR_SOURCE_LENGTH   80
+
+struct ast_json_error {
+	int line;
+	int column;
+	int position;
+	char text[AST_JSON_ERROR_TEXT_LENGTH];
+	char source[AST_JSON_ERROR_TEXT_LENGTH];
+};
+
+struct ast_json_iter;
+
+void *ast_json_malloc(size_t size);
+void ast_json_free(void *p);
+void ast_json_set_alloc_funcs(void *(*malloc_fn)(size_t), void (*free_fn)(void*));
+void ast_json_reset_alloc_funcs(void);
+
+struct ast_json *ast_json_ref(struct ast_json *value);
+void ast_json_unref(struct ast_json *value);
+enum ast_json_type ast_json_typeof(const struct ast_json *value);
+const char *ast_json_typename(enum ast_json_type type);
+
+struct ast_json *ast_json_true(void);
+struct ast_json *ast_json_false(void);
+struct ast_json *ast_json_boolean(int value);
+struct ast_json *ast_json_null(void);
+int ast_json_is_true(const struct ast_json *value);
+int ast_json_is_false(const struct ast_json *value);
+int ast_json_is_null(const struct ast_json *value);
+
+struct ast_json *ast_json_string_create(const char *value);
+const char *ast_json_string_get(const struct ast_json *string);
+int ast_json_string_set(struct ast_json *string, const char *value);
+
+struct ast_json *ast_json_integer_create(intmax_t value);
+intmax_t ast_json_integer_get(const struct ast_json *integer);
+int ast_json_integer_set(struct ast_json *integer, intmax_t value);
+struct ast_json *ast_json_real_create(double value);
+double ast_json_real_get(const struct ast_json *real);
+int ast_json_real_set(struct ast_json *real, double value);
+
+struct ast_json *ast_json_array_create(void);
+size_t ast_json_array_size(const struct ast_json *array);
+struct ast_json *ast_json_array_get(const struct ast_json *array, size_t index);
+int ast_json_array_set(struct ast_json *array, size_t index, struct ast_json *value);
+int ast_json_array_append(struct ast_json *array, struct ast_json *value);
+int ast_json_array_insert(struct ast_json *array, size_t index, struct ast_json *value);
+int ast_json_array_remove(struct ast_json *array, size_t index);
+int ast_json_array_clear(struct ast_json *array);
+int ast_json_array_extend(struct ast_json *array, struct ast_json *tail);
+
+struct ast_json *ast_json_object_create(void);
+size_t ast_json_object_size(struct ast_json *object);
+struct ast_json *ast_json_object_get(struct ast_json *object, const char *key);
+int ast_json_object_set(struct ast_json *object, const char *key, struct ast_json *value);
+int ast_json_object_del(struct ast_json *object, const char *key);
+int ast_json_object_clear(struct ast_json *object);
+int ast_json_object_update(struct ast_json *object, struct ast_json *other);
+struct ast_json_iter *ast_json_object_iter(struct ast_json *object);
+struct ast_json_iter *ast_json_object_iter_at(struct ast_json *object, const char *key);
+struct ast_json_iter *ast_json_object_iter_next(struct ast_json *object, struct ast_json_iter *iter);
+const char *ast_json_object_iter_key(struct ast_json_iter *iter);
+struct ast_json *ast_json_object_iter_value(struct ast_json_iter *iter);
+int ast_json_object_iter_set(struct ast_json *object, struct ast_json_iter *iter, struct ast_json *value);
+
+int ast_json_equal(const struct ast_json *lhs, const struct ast_json *rhs);
+struct ast_json *ast_json_copy(const struct ast_json *value);
+struct ast_json *ast_json_deep_copy(const struct ast_json *value);
+
+char *ast_json_dump_string_format(struct ast_json *root, enum ast_json_encoding_format format);
+#define ast_json_dump_string(root) ast_json_dump_string_format(root, AST_JSON_COMPACT)
+
+struct ast_str;
+int ast_json_dump_str_format(struct ast_json *root, struct ast_str **dst, enum ast_json_encoding_format format);
+#define ast_json_dump_str(root, dst) ast_json_dump_str_format(root, dst, AST_JSON_COMPACT)
+
+struct ast_json *ast_json_load_string(const char *input, struct ast_json_error *error);
+struct ast_json *ast_json_load_buf(const char *buffer, size_t buflen, struct ast_json_error *error);
+
+#endif
@@ -0,0 +1,103 @@
+#ifndef _BENCH_ASTERISK_LINKEDLISTS_H
+#define _BENCH_ASTERISK_LINKEDLISTS_H
+
+#define AST_LIST_HEAD_NOLOCK(name, type) \
+struct name { \
+	struct type *first; \
+	struct type *last; \
+}
+#define AST_LIST_HEAD_NOLOCK_INIT_VALUE { NULL, NULL }
+#define AST_LIST_HEAD_NOLOCK_STATIC(name, type) \
+struct name { \
+	struct type *first; \
+	struct type *last; \
+} name = AST_LIST_HEAD_NOLOCK_INIT_VALUE
+#define AST_LIST_HEAD_INIT_NOLOCK(head) do { (head)->first = NULL; (head)->last = NULL; } while (0)
+#define AST_LIST_ENTRY(type) struct { struct type *next; }
+#define AST_LIST_FIRST(head) ((head)->first)
+#define AST_LIST_LAST(head) ((head)->last)
+#define AST_LIST_NEXT(elm, field) ((elm)->field.next)
+#define AST_LIST_EMPTY(head) (AST_LIST_FIRST(head) == NULL)
+#define AST_LIST_TRAVERSE(head, var, field) for ((var) = (head)->first; (var); (var) = (var)->field.next)
+#define AST_LIST_TRAVERSE_SAFE_BEGIN(head, var, field) { \
+	typeof((head)) __list_head = head; \
+	typeof(__list_head->first) __list_next; \
+	typeof(__list_head->first) __list_prev = NULL; \
+	typeof(__list_head->first) __list_current; \
+	for ((var) = __list_head->first, \
+		__list_current = (var), \
+		__list_next = (var) ? (var)->field.next : NULL; \
+		(var); \
+		__list_prev = __list_current, \
+		(var) = __list_next, \
+		__list_current = (var), \
+		__list_next = (var) ? (var)->field.next : NULL, \
+		(void) __list_prev \
+		)
+#define AST_LIST_REMOVE_CURRENT(field) do { \
+		__list_current->field.next = NULL; \
+		__list_current = __list_prev; \
+		if (__list_prev) { \
+			__list_prev->field.next = __list_next; \
+		} else { \
+			__list_head->first = __list_next; \
+		} \
+		if (!__list_next) { \
+			__list_head->last = __list_prev; \
+		} \
+	} while (0)
+#define AST_LIST_TRAVERSE_SAFE_END }
+#define AST_LIST_INSERT_HEAD(head, elm, field) do { \
+		(elm)->field.next = (head)->first; \
+		(head)->first = (elm); \
+		if (!(head)->last) \
+			(head)->last = (elm); \
+	} while (0)
+#define AST_LIST_INSERT_TAIL(head, elm, field) do { \
+		if (!(head)->first) { \
+			(head)->first = (elm); \
+			(head)->last = (elm); \
+		} else { \
+			(head)->last->field.next = (elm); \
+			(head)->last = (elm); \
+		} \
+	} while (0)
+#define AST_LIST_REMOVE_HEAD(head, field) ({ \
+		typeof((head)->first) __cur = (head)->first; \
+		if (__cur) { \
+			(head)->first = __cur->field.next; \
+			__cur->field.next = NULL; \
+			if ((head)->last == __cur) \
+				(head)->last = NULL; \
+		} \
+		__cur; \
+	})
+#define AST_LIST_REMOVE(head, elm, field) ({ \
+	__typeof(elm) __elm = (elm); \
+	if (__elm) { \
+		if ((head)->first == __elm) { \
+			(head)->first = __elm->field.next; \
+			__elm->field.next = NULL; \
+			if ((head)->last == __elm) { \
+				(head)->last = NULL; \
+			} \
+		} else { \
+			typeof(elm) __prev = (head)->first; \
+			while (__prev && __prev->field.next != __elm) { \
+				__prev = __prev->field.next; \
+			} \
+			if (__prev) { \
+				__prev->field.next = __elm->field.next; \
+				__elm->field.next = NULL; \
+				if ((head)->last == __elm) { \
+					(head)->last = __prev; \
+				} \
+			} else { \
+				__elm = NULL; \
+			} \
+		} \
+	} \
+	__elm; \
+})
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef _BENCH_ASTERISK_LOCK_H
+#define _BENCH_ASTERISK_LOCK_H
+
+#include <pthread.h>
+
+typedef pthread_mutex_t ast_mutex_t;
+typedef pthread_rwlock_t ast_rwlock_t;
+typedef pthread_cond_t ast_cond_t;
+
+#define AST_MUTEX_DEFINE_STATIC(mutex) static ast_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER
+#define AST_RWLOCK_DEFINE_STATIC(rwlock) static ast_rwlock_t rwlock = PTHREAD_RWLOCK_INITIALIZER
+#define ast_mutex_init(m) pthread_mutex_init((m), NULL)
+#define ast_mutex_destroy(m) pthread_mutex_destroy(m)
+#define ast_mutex_lock(m) pthread_mutex_lock(m)
+#define ast_mutex_unlock(m) pthread_mutex_unlock(m)
+#define ast_rwlock_init(l) pthread_rwlock_init((l), NULL)
+#define ast_rwlock_destroy(l) pthread_rwlock_destroy(l)
+#define ast_rwlock_rdlock(l) pthread_rwlock_rdlock(l)
+#define ast_rwlock_wrlock(l) pthread_rwlock_wrlock(l)
+#define ast_rwlock_unlock(l) pthread_rwlock_unlock(l)
+
+#define SCOPED_MUTEX(varname, lock) \
+	__attribute__((cleanup(__bench_scoped_unlock))) ast_mutex_t *varname = (ast_mutex_lock(lock), (lock))
+static inline void __bench_scoped_unlock(ast_mutex_t **m) { ast_mutex_unlock(*m); }
+
+#define ast_atomic_fetch_add(ptr, val, memorder) __atomic_fetch_add((ptr), (val), (memorder))
+#define ast_atomic_add_fetch(ptr, val, memorder) __atomic_add_fetch((ptr), (val), (memorder))
+#define ast_atomic_fetch_sub(ptr, val, memorder) __atomic_fetch_sub((ptr), (val), (memorder))
+#define ast_atomic_sub_fetch(ptr, val, memorder) __atomic_sub_fetch((ptr), (val), (memorder))
+
+static inline int ast_atomic_fetchadd_int(volatile int *p, int v)
+{
+	return __atomic_fetch_add(p, v, __ATOMIC_SEQ_CST);
+}
+
+static inline int ast_atomic_dec_and_test(volatile int *p)
+{
+	return __atomic_sub_fetch(p, 1, __ATOMIC_SEQ_CST) == 0;
+}
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef _BENCH_ASTERISK_LOGGER_H
+#define _BENCH_ASTERISK_LOGGER_H
+
+#define _A_ __FILE__, __LINE__, __func__
+#define __LOG_DEBUG    0
+#define __LOG_NOTICE   2
+#define __LOG_WARNING  3
+#define __LOG_ERROR    4
+#define __LOG_VERBOSE  5
+#define LOG_DEBUG      __LOG_DEBUG, _A_
+#define LOG_NOTICE     __LOG_NOTICE, _A_
+#define LOG_WARNING    __LOG_WARNING, _A_
+#define LOG_ERROR      __LOG_ERROR, _A_
+
+/* set by the harness; messages below this level are dropped */
+extern int bench_log_level;
+
+void ast_log(int level, const char *file, int line, const char *function, const char *fmt, ...)
+	__attribute__((format(printf, 5, 6)));
+
+#define ast_verb(level, ...) do { } while (0)
+#define ast_debug(level, ...) do { } while (0)
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef _BENCH_ASTERISK_MODULE_H
+#define _BENCH_ASTERISK_MODULE_H
+
+enum ast_module_load_result {
+	AST_MODULE_LOAD_SUCCESS = 0,
+	AST_MODULE_LOAD_DECLINE = 1,
+	AST_MODULE_LOAD_SKIP = 2,
+	AST_MODULE_LOAD_PRIORITY = 3,
+	AST_MODULE_LOAD_FAILURE = -1,
+};
+
+enum ast_module_support_level {
+	AST_MODULE_SUPPORT_UNKNOWN,
+	AST_MODULE_SUPPORT_CORE,
+	AST_MODULE_SUPPORT_EXTENDED,
+	AST_MODULE_SUPPORT_DEPRECATED,
+};
+
+enum ast_module_flags {
+	AST_MODFLAG_DEFAULT = 0,
+	AST_MODFLAG_GLOBAL_SYMBOLS = (1 << 0),
+	AST_MODFLAG_LOAD_ORDER = (1 << 1),
+};
+
+enum module_load_priority {
+	AST_MODPRI_REALTIME_DEPEND = 10,
+	AST_MODPRI_APP_DEPEND = 50,
+	AST_MODPRI_DEFAULT = 128,
+};
+
+/*! what the harness calls instead of the module loader */
+struct bench_module_info {
+	const char *description;
+	unsigned int flags;
+	int (*load)(void);
+	int (*reload)(void);
+	int (*unload)(void);
+	enum ast_module_support_level support_level;
+	unsigned char load_pri;
+	const char *requires;
+	const char *optional_modules;
+};
+
+extern const struct bench_module_info *bench_module;
+
+/*! module references: only counted, so the harness can see they are all given back */
+struct ast_module;
+
+struct ast_module_info {
+	struct ast_module *self;
+};
+
+static const __attribute__((unused)) struct ast_module_info *ast_module_info;
+
+extern int bench_module_refs;
+struct ast_module *bench_module_ref(struct ast_module *mod, int delta);
+#define ast_module_ref(mod) bench_module_ref(mod, 1)
+#define ast_module_unref(mod) bench_module_ref(mod, -1)
+
+#define AST_MODULE_INFO(keystr, flags_to_set, desc, fields...) \
+	static const struct bench_module_info __mod_info = { \
+		.description = desc, \
+		.flags = flags_to_set, \
+		fields \
+	}; \
+	static const struct ast_module_info __mod_self; \
+	static const __attribute__((unused)) struct ast_module_info *ast_module_info = &__mod_self; \
+	const struct bench_module_info *bench_module = &__mod_info
+
+#define AST_MODULE_INFO_STANDARD(keystr, desc) \
+	AST_MODULE_INFO(keystr, AST_MODFLAG_LOAD_ORDER, desc, \
+		.load = load_module, \
+		.unload = unload_module, \
+		.load_pri = AST_MODPRI_DEFAULT, \
+		.support_level = AST_MODULE_SUPPORT_CORE, \
+	)
+
+#endif
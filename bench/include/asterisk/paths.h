@@ -0,0 +1,7 @@
+#ifndef _BENCH_ASTERISK_PATHS_H
+#define _BENCH_ASTERISK_PATHS_H
+
+/*! the configuration directory: $BENCH_CONFIG_DIR, or the current directory */
+extern const char *ast_config_AST_CONFIG_DIR;
+
+#endif
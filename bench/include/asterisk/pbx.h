@@ -0,0 +1,45 @@
+#ifndef _BENCH_ASTERISK_PBX_H
+#define _BENCH_ASTERISK_PBX_H
+
+#include <sys/types.h>
+
+struct ast_channel;
+struct ast_str;
+struct ast_module;
+
+typedef int (*ast_acf_read_fn_t)(struct ast_channel *chan, const char *function, char *data, char *buf, size_t len);
+typedef int (*ast_acf_read2_fn_t)(struct ast_channel *chan, const char *cmd, char *data, struct ast_str **str, ssize_t len);
+typedef int (*ast_acf_write_fn_t)(struct ast_channel *chan, const char *function, char *data, const char *value);
+
+struct ast_custom_function {
+	const char *name;
+	ast_acf_read_fn_t read;
+	ast_acf_read2_fn_t read2;
+	size_t read_max;
+	ast_acf_write_fn_t write;
+	struct ast_module *mod;
+};
+
+int __ast_custom_function_register(struct ast_custom_function *acf, struct ast_module *mod);
+#define ast_custom_function_register(acf) __ast_custom_function_register(acf, AST_MODULE_SELF)
+int ast_custom_function_unregister(struct ast_custom_function *acf);
+
+enum ast_custom_function_escalation {
+	AST_CFE_NONE,
+	AST_CFE_READ,
+	AST_CFE_WRITE,
+	AST_CFE_BOTH,
+};
+
+int __ast_custom_function_register_escalating(struct ast_custom_function *acf, enum ast_custom_function_escalation escalation, struct ast_module *mod);
+#define ast_custom_function_register_escalating(acf, escalation) __ast_custom_function_register_escalating(acf, escalation, AST_MODULE_SELF)
+
+int ast_register_application2(const char *app, int (*execute)(struct ast_channel *, const char *), const char *synopsis, const char *description, void *mod);
+#define ast_register_application_xml(app, execute) ast_register_application2(app, execute, NULL, NULL, AST_MODULE_SELF)
+int ast_unregister_application(const char *app);
+
+const char *pbx_builtin_getvar_helper(struct ast_channel *chan, const char *name);
+int pbx_builtin_setvar_helper(struct ast_channel *chan, const char *name, const char *value);
+void ast_str_substitute_variables(struct ast_str **buf, ssize_t maxlen, struct ast_channel *chan, const char *templ);
+
+#endif
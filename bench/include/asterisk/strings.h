@@ -0,0 +1,149 @@
+#ifndef _BENCH_ASTERISK_STRINGS_H
+#define _BENCH_ASTERISK_STRINGS_H
+
+#include <string.h>
+#include <stdarg.h>
+#include <ctype.h>
+#include <sys/types.h>
+#include <limits.h>
+
+#include "asterisk/threadstorage.h"
+
+static inline int ast_strlen_zero(const char *s)
+{
+	return (!s || (*s == '\0'));
+}
+
+#define S_OR(a, b) ({typeof(&((a)[0])) __x = (a); ast_strlen_zero(__x) ? (b) : __x;})
+
+static inline void ast_copy_string(char *dst, const char *src, size_t size)
+{
+	if (!size)
+		return;
+	while (*src && size > 1) {
+		*dst++ = *src++;
+		size--;
+	}
+	*dst = '\0';
+}
+
+int ast_build_string(char **buffer, size_t *space, const char *fmt, ...) __attribute__((format(printf, 3, 4)));
+
+static inline char *ast_skip_blanks(const char *str)
+{
+	while (*str && ((unsigned char) *str) < 33)
+		str++;
+	return (char *) str;
+}
+
+static inline char *ast_trim_blanks(char *str)
+{
+	char *work = str;
+	if (work) {
+		work += strlen(work) - 1;
+		while ((work >= str) && ((unsigned char) *work) < 33)
+			*(work--) = '\0';
+	}
+	return str;
+}
+
+static inline char *ast_strip(char *s)
+{
+	if ((s = ast_skip_blanks(s)))
+		ast_trim_blanks(s);
+	return s;
+}
+
+int ast_true(const char *val);
+int ast_false(const char *val);
+
+static inline int ast_str_hash(const char *str)
+{
+	unsigned int hash = 5381;
+	while (*str)
+		hash = hash * 33 ^ (unsigned char) *str++;
+	return (int) (hash & (unsigned int) INT_MAX);
+}
+
+/* dynamic strings */
+struct ast_str {
+	size_t __AST_STR_LEN;
+	size_t __AST_STR_USED;
+	struct ast_threadstorage *__AST_STR_TS;   /* set for the buffers of ast_str_thread_get */
+	char __AST_STR_STR[0];
+};
+
+struct ast_str *ast_str_create(size_t init_len);
+int ast_str_make_space(struct ast_str **buf, size_t new_len);
+int ast_str_set(struct ast_str **buf, ssize_t max_len, const char *fmt, ...) __attribute__((format(printf, 3, 4)));
+int ast_str_append(struct ast_str **buf, ssize_t max_len, const char *fmt, ...) __attribute__((format(printf, 3, 4)));
+char *ast_str_set_substr(struct ast_str **buf, ssize_t maxlen, const char *src, size_t maxsrc);
+char *ast_str_append_substr(struct ast_str **buf, ssize_t maxlen, const char *src, size_t maxsrc);
+
+/*! a dynamic string kept per thread, as the core's own; it survives between calls */
+static inline struct ast_str *ast_str_thread_get(struct ast_threadstorage *ts, size_t init_len)
+{
+	struct ast_str *buf = ast_threadstorage_get(ts, sizeof(*buf) + init_len);
+
+	if (buf && !buf->__AST_STR_LEN) {
+		buf->__AST_STR_LEN = init_len;
+		buf->__AST_STR_USED = 0;
+		buf->__AST_STR_TS = ts;
+	}
+	return buf;
+}
+
+static inline char *ast_str_buffer(const struct ast_str *buf)
+{
+	return (char *) buf->__AST_STR_STR;
+}
+
+static inline size_t ast_str_strlen(const struct ast_str *buf)
+{
+	return buf->__AST_STR_USED;
+}
+
+static inline size_t ast_str_size(const struct ast_str *buf)
+{
+	return buf->__AST_STR_LEN;
+}
+
+static inline void ast_str_reset(struct ast_str *buf)
+{
+	if (buf) {
+		buf->__AST_STR_USED = 0;
+		if (buf->__AST_STR_LEN)
+			buf->__AST_STR_STR[0] = '\0';
+	}
+}
+
+static inline void ast_str_update(struct ast_str *buf)
+{
+	buf->__AST_STR_USED = strlen(buf->__AST_STR_STR);
+}
+
+static inline char *ast_str_truncate(struct ast_str *buf, ssize_t len)
+{
+	if (len < 0) {
+		if ((typeof(buf->__AST_STR_USED)) -len >= buf->__AST_STR_USED)
+			buf->__AST_STR_USED = 0;
+		else
+			buf->__AST_STR_USED += len;
+	} else
+		buf->__AST_STR_USED = len;
+	buf->__AST_STR_STR[buf->__AST_STR_USED] = '\0';
+	return buf->__AST_STR_STR;
+}
+
+#define ast_str_alloca(init_len) \
+	({ \
+		struct ast_str *__ast_str_buf; \
+		__ast_str_buf = alloca(sizeof(*__ast_str_buf) + init_len); \
+		__ast_str_buf->__AST_STR_LEN = init_len; \
+		__ast_str_buf->__AST_STR_USED = 0; \
+		__ast_str_buf->__AST_STR_TS = NULL; \
+		__ast_str_buf->__AST_STR_STR[0] = '\0'; \
+		(__ast_str_buf); \
+	})
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef _BENCH_ASTERISK_TIME_H
+#define _BENCH_ASTERISK_TIME_H
+
+#include <sys/time.h>
+#include <time.h>
+#include <stdint.h>
+
+static inline struct timeval ast_tvnow(void)
+{
+	struct timeval t;
+	gettimeofday(&t, NULL);
+	return t;
+}
+
+static inline int64_t ast_tvdiff_us(struct timeval end, struct timeval start)
+{
+	return (end.tv_sec - start.tv_sec) * (int64_t) 1000000 + end.tv_usec - start.tv_usec;
+}
+
+static inline int64_t ast_tvdiff_ms(struct timeval end, struct timeval start)
+{
+	return ast_tvdiff_us(end, start) / 1000;
+}
+
+static inline int64_t ast_tvdiff_sec(struct timeval end, struct timeval start)
+{
+	int64_t result = end.tv_sec - start.tv_sec;
+	if (result > 0 && end.tv_usec < start.tv_usec)
+		result--;
+	else if (result < 0 && end.tv_usec > start.tv_usec)
+		result++;
+	return result;
+}
+
+static inline int ast_tvzero(const struct timeval t)
+{
+	return (t.tv_sec == 0 && t.tv_usec == 0);
+}
+
+#endif
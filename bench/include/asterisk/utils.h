@@ -0,0 +1,60 @@
+#ifndef _BENCH_ASTERISK_UTILS_H
+#define _BENCH_ASTERISK_UTILS_H
+
+#include <stdarg.h>
+#include <sys/time.h>
+
+#include "asterisk/logger.h"
+#include "asterisk/lock.h"
+#include "asterisk/strings.h"
+
+#define ARRAY_LEN(a) (size_t) (sizeof(a) / sizeof(0[a]))
+#define SWAP(a,b) do { typeof(a) __tmp = (a); (a) = (b); (b) = __tmp; } while (0)
+#ifndef MIN
+#define MIN(a, b) ({ typeof(a) __a = (a); typeof(b) __b = (b); ((__a > __b) ? __b : __a);})
+#endif
+#ifndef MAX
+#define MAX(a, b) ({ typeof(a) __a = (a); typeof(b) __b = (b); ((__a < __b) ? __b : __a);})
+#endif
+
+struct ast_flags {
+	unsigned int flags;
+};
+
+/* allocation wrappers; counted by the harness */
+void *__bench_malloc(size_t size);
+void *__bench_calloc(size_t nmemb, size_t size);
+void *__bench_realloc(void *p, size_t size);
+void __bench_free(void *p);
+char *__bench_strdup(const char *s);
+char *__bench_strndup(const char *s, size_t n);
+
+#define ast_malloc(len) __bench_malloc(len)
+#define ast_calloc(num, len) __bench_calloc(num, len)
+#define ast_realloc(p, len) __bench_realloc(p, len)
+#define ast_free(p) __bench_free(p)
+#define ast_std_free(p) free(p)
+#define ast_strdup(str) __bench_strdup(str)
+#define ast_strndup(str, len) __bench_strndup(str, len)
+
+int ast_asprintf(char **ret, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+int ast_vasprintf(char **ret, const char *fmt, va_list ap);
+
+#define ast_strdupa(s) \
+	(__extension__ ({ \
+		const char *__old = (s); \
+		size_t __len = strlen(__old) + 1; \
+		char *__new = __builtin_alloca(__len); \
+		memcpy(__new, __old, __len); \
+		__new; \
+	}))
+
+#define ast_assert(a) do { } while (0)
+
+#define ast_pthread_create_background(a, b, c, d) pthread_create((a), (b), (c), (d))
+#define ast_pthread_create_detached_background(a, b, c, d) pthread_create((a), (b), (c), (d))
+
+#define AST_PTHREADT_NULL (pthread_t) -1
+#define AST_PTHREADT_STOP (pthread_t) -2
+
+#endif
@@ -0,0 +1,193 @@
+/*
+ * The ast_json wrappers from Asterisk's main/json.c, reduced to the calls
+ * res_json makes.  They sit directly on top of jansson, like the real ones.
+ */
+
+#include "asterisk.h"
+
+#include <jansson.h>
+
+#include "asterisk/utils.h"
+#include "asterisk/json.h"
+
+void *ast_json_malloc(size_t size)
+{
+	return ast_malloc(size);
+}
+
+void ast_json_free(void *p)
+{
+	ast_free(p);
+}
+
+void ast_json_set_alloc_funcs(void *(*malloc_fn)(size_t), void (*free_fn)(void*))
+{
+	json_set_alloc_funcs(malloc_fn, free_fn);
+}
+
+void ast_json_reset_alloc_funcs(void)
+{
+	json_set_alloc_funcs(ast_json_malloc, ast_json_free);
+}
+
+/*! jansson allocates through ast_json_malloc, as set up by ast_json_init() at startup */
+static void __attribute__((constructor)) bench_json_init(void)
+{
+	ast_json_reset_alloc_funcs();
+}
+
+struct ast_json *ast_json_ref(struct ast_json *json)
+{
+	json_incref((json_t *) json);
+	return json;
+}
+
+void ast_json_unref(struct ast_json *json)
+{
+	json_decref((json_t *) json);
+}
+
+enum ast_json_type ast_json_typeof(const struct ast_json *json)
+{
+	int r = json_typeof((json_t *) json);
+	switch (r) {
+	case JSON_OBJECT: return AST_JSON_OBJECT;
+	case JSON_ARRAY: return AST_JSON_ARRAY;
+	case JSON_STRING: return AST_JSON_STRING;
+	case JSON_INTEGER: return AST_JSON_INTEGER;
+	case JSON_REAL: return AST_JSON_REAL;
+	case JSON_TRUE: return AST_JSON_TRUE;
+	case JSON_FALSE: return AST_JSON_FALSE;
+	case JSON_NULL: return AST_JSON_NULL;
+	}
+	abort();
+}
+
+const char *ast_json_typename(enum ast_json_type type)
+{
+	switch (type) {
+	case AST_JSON_OBJECT: return "object";
+	case AST_JSON_ARRAY: return "array";
+	case AST_JSON_STRING: return "string";
+	case AST_JSON_INTEGER: return "integer";
+	case AST_JSON_REAL: return "real";
+	case AST_JSON_TRUE: return "true";
+	case AST_JSON_FALSE: return "false";
+	case AST_JSON_NULL: return "null";
+	}
+	return "?";
+}
+
+struct ast_json *ast_json_true(void) { return (struct ast_json *) json_true(); }
+struct ast_json *ast_json_false(void) { return (struct ast_json *) json_false(); }
+struct ast_json *ast_json_boolean(int value) { return (struct ast_json *) (value ? json_true() : json_false()); }
+struct ast_json *ast_json_null(void) { return (struct ast_json *) json_null(); }
+int ast_json_is_true(const struct ast_json *json) { return json_typeof((const json_t *) json) == JSON_TRUE; }
+int ast_json_is_false(const struct ast_json *json) { return json_typeof((const json_t *) json) == JSON_FALSE; }
+int ast_json_is_null(const struct ast_json *json) { return json_typeof((const json_t *) json) == JSON_NULL; }
+
+struct ast_json *ast_json_string_create(const char *value) { return (struct ast_json *) json_string(value); }
+const char *ast_json_string_get(const struct ast_json *string) { return json_string_value((json_t *) string); }
+int ast_json_string_set(struct ast_json *string, const char *value) { return json_string_set((json_t *) string, value); }
+
+struct ast_json *ast_json_integer_create(intmax_t value) { return (struct ast_json *) json_integer(value); }
+intmax_t ast_json_integer_get(const struct ast_json *integer) { return json_integer_value((json_t *) integer); }
+int ast_json_integer_set(struct ast_json *integer, intmax_t value) { return json_integer_set((json_t *) integer, value); }
+struct ast_json *ast_json_real_create(double value) { return (struct ast_json *) json_real(value); }
+double ast_json_real_get(const struct ast_json *real) { return json_real_value((json_t *) real); }
+int ast_json_real_set(struct ast_json *real, double value) { return json_real_set((json_t *) real, value); }
+
+struct ast_json *ast_json_array_create(void) { return (struct ast_json *) json_array(); }
+size_t ast_json_array_size(const struct ast_json *array) { return json_array_size((json_t *) array); }
+struct ast_json *ast_json_array_get(const struct ast_json *array, size_t index) { return (struct ast_json *) json_array_get((json_t *) array, index); }
+int ast_json_array_set(struct ast_json *array, size_t index, struct ast_json *value) { return json_array_set_new((json_t *) array, index, (json_t *) value); }
+int ast_json_array_append(struct ast_json *array, struct ast_json *value) { return json_array_append_new((json_t *) array, (json_t *) value); }
+int ast_json_array_insert(struct ast_json *array, size_t index, struct ast_json *value) { return json_array_insert_new((json_t *) array, index, (json_t *) value); }
+int ast_json_array_remove(struct ast_json *array, size_t index) { return json_array_remove((json_t *) array, index); }
+int ast_json_array_clear(struct ast_json *array) { return json_array_clear((json_t *) array); }
+int ast_json_array_extend(struct ast_json *array, struct ast_json *tail) { return json_array_extend((json_t *) array, (json_t *) tail); }
+
+struct ast_json *ast_json_object_create(void) { return (struct ast_json *) json_object(); }
+size_t ast_json_object_size(struct ast_json *object) { return json_object_size((json_t *) object); }
+struct ast_json *ast_json_object_get(struct ast_json *object, const char *key)
+{
+	if (!key) {
+		return NULL;
+	}
+	return (struct ast_json *) json_object_get((json_t *) object, key);
+}
+int ast_json_object_set(struct ast_json *object, const char *key, struct ast_json *value) { return json_object_set_new((json_t *) object, key, (json_t *) value); }
+int ast_json_object_del(struct ast_json *object, const char *key) { return json_object_del((json_t *) object, key); }
+int ast_json_object_clear(struct ast_json *object) { return json_object_clear((json_t *) object); }
+int ast_json_object_update(struct ast_json *object, struct ast_json *other) { return json_object_update((json_t *) object, (json_t *) other); }
+struct ast_json_iter *ast_json_object_iter(struct ast_json *object) { return json_object_iter((json_t *) object); }
+struct ast_json_iter *ast_json_object_iter_at(struct ast_json *object, const char *key) { return json_object_iter_at((json_t *) object, key); }
+struct ast_json_iter *ast_json_object_iter_next(struct ast_json *object, struct ast_json_iter *iter) { return json_object_iter_next((json_t *) object, iter); }
+const char *ast_json_object_iter_key(struct ast_json_iter *iter) { return json_object_iter_key(iter); }
+struct ast_json *ast_json_object_iter_value(struct ast_json_iter *iter) { return (struct ast_json *) json_object_iter_value(iter); }
+int ast_json_object_iter_set(struct ast_json *object, struct ast_json_iter *iter, struct ast_json *value) { return json_object_iter_set_new((json_t *) object, iter, (json_t *) value); }
+
+int ast_json_equal(const struct ast_json *lhs, const struct ast_json *rhs) { return json_equal((json_t *) lhs, (json_t *) rhs); }
+struct ast_json *ast_json_copy(const struct ast_json *value) { return (struct ast_json *) json_copy((json_t *) value); }
+struct ast_json *ast_json_deep_copy(const struct ast_json *value) { return (struct ast_json *) json_deep_copy((json_t *) value); }
+
+static size_t dump_flags(enum ast_json_encoding_format format)
+{
+	return format == AST_JSON_PRETTY ?
+		JSON_INDENT(2) | JSON_PRESERVE_ORDER : JSON_COMPACT;
+}
+
+char *ast_json_dump_string_format(struct ast_json *root, enum ast_json_encoding_format format)
+{
+	return json_dumps((json_t *) root, dump_flags(format));
+}
+
+/*! appends to an ast_str, growing it by doubling, as main/json.c does */
+static int write_to_ast_str(const char *buffer, size_t size, void *data)
+{
+	struct ast_str **dst = data;
+	size_t str_size = ast_str_size(*dst);
+	size_t remaining = str_size - ast_str_strlen(*dst);
+
+	while (remaining < size + 1) {
+		str_size *= 2;
+		remaining = str_size - ast_str_strlen(*dst);
+	}
+	if (ast_str_make_space(dst, str_size)) {
+		return -1;
+	}
+	ast_str_append_substr(dst, -1, buffer, size);
+	return 0;
+}
+
+int ast_json_dump_str_format(struct ast_json *root, struct ast_str **dst, enum ast_json_encoding_format format)
+{
+	return json_dump_callback((json_t *) root, write_to_ast_str, dst, dump_flags(format));
+}
+
+static void copy_error(struct ast_json_error *error, const json_error_t *jansson_error)
+{
+	if (error && jansson_error) {
+		error->line = jansson_error->line;
+		error->column = jansson_error->column;
+		error->position = jansson_error->position;
+		ast_copy_string(error->text, jansson_error->text, sizeof(error->text));
+		ast_copy_string(error->source, jansson_error->source, sizeof(error->source));
+	}
+}
+
+struct ast_json *ast_json_load_string(const char *input, struct ast_json_error *error)
+{
+	json_error_t jansson_error = {};
+	struct ast_json *r = (struct ast_json *) json_loads(input, 0, &jansson_error);
+	copy_error(error, &jansson_error);
+	return r;
+}
+
+struct ast_json *ast_json_load_buf(const char *buffer, size_t buflen, struct ast_json_error *error)
+{
+	json_error_t jansson_error = {};
+	struct ast_json *r = (struct ast_json *) json_loadb(buffer, buflen, 0, &jansson_error);
+	copy_error(error, &jansson_error);
+	return r;
+}
@@ -0,0 +1,1157 @@
+/*
+ * Small stand-ins for the parts of the Asterisk core that res_json calls:
+ * logging, allocation, ast_str, argument parsing, channel variables,
+ * datastores and the function/application registries.  Allocations made
+ * through the ast_* wrappers (and therefore by jansson, see json.c) are
+ * counted so the harness can report allocations per operation.
+ */
+
+#include "asterisk.h"
+
+#include "asterisk/utils.h"
+#include "asterisk/app.h"
+#include "asterisk/pbx.h"
+#include "asterisk/channel.h"
+#include "asterisk/datastore.h"
+#include "asterisk/astobj2.h"
+#include "asterisk/cli.h"
+#include "asterisk/config.h"
+#include "asterisk/paths.h"
+#include "asterisk/module.h"
+#include "stubs.h"
+
+int bench_log_level = __LOG_WARNING;
+uint64_t bench_alloc_count;
+uint64_t bench_free_count;
+int bench_module_refs;
+
+struct ast_module *bench_module_ref(struct ast_module *mod, int delta)
+{
+	__atomic_add_fetch(&bench_module_refs, delta, __ATOMIC_RELAXED);
+	return mod;
+}
+
+void ast_log(int level, const char *file, int line, const char *function, const char *fmt, ...)
+{
+	va_list ap;
+
+	if (level < bench_log_level) {
+		return;
+	}
+	fprintf(stderr, "[%s:%d %s] ", file, line, function);
+	va_start(ap, fmt);
+	vfprintf(stderr, fmt, ap);
+	va_end(ap);
+}
+
+void *__bench_malloc(size_t size)
+{
+	__atomic_add_fetch(&bench_alloc_count, 1, __ATOMIC_RELAXED);
+	return malloc(size);
+}
+
+void *__bench_calloc(size_t nmemb, size_t size)
+{
+	__atomic_add_fetch(&bench_alloc_count, 1, __ATOMIC_RELAXED);
+	return calloc(nmemb, size);
+}
+
+void *__bench_realloc(void *p, size_t size)
+{
+	if (!p) {
+		__atomic_add_fetch(&bench_alloc_count, 1, __ATOMIC_RELAXED);
+	}
+	return realloc(p, size);
+}
+
+void __bench_free(void *p)
+{
+	if (p) {
+		__atomic_add_fetch(&bench_free_count, 1, __ATOMIC_RELAXED);
+	}
+	free(p);
+}
+
+char *__bench_strdup(const char *s)
+{
+	char *r;
+
+	if (!s) {
+		return NULL;
+	}
+	r = __bench_malloc(strlen(s) + 1);
+	if (r) {
+		strcpy(r, s);
+	}
+	return r;
+}
+
+char *__bench_strndup(const char *s, size_t n)
+{
+	size_t len = strnlen(s, n);
+	char *r = __bench_malloc(len + 1);
+
+	if (r) {
+		memcpy(r, s, len);
+		r[len] = '\0';
+	}
+	return r;
+}
+
+int ast_vasprintf(char **ret, const char *fmt, va_list ap)
+{
+	va_list ap2;
+	int len;
+
+	va_copy(ap2, ap);
+	len = vsnprintf(NULL, 0, fmt, ap2);
+	va_end(ap2);
+	*ret = __bench_malloc(len + 1);
+	if (!*ret) {
+		return -1;
+	}
+	return vsnprintf(*ret, len + 1, fmt, ap);
+}
+
+int ast_asprintf(char **ret, const char *fmt, ...)
+{
+	va_list ap;
+	int res;
+
+	va_start(ap, fmt);
+	res = ast_vasprintf(ret, fmt, ap);
+	va_end(ap);
+	return res;
+}
+
+int ast_build_string(char **buffer, size_t *space, const char *fmt, ...)
+{
+	va_list ap;
+	int result;
+
+	if (!buffer || !*buffer || !space || !*space) {
+		return -1;
+	}
+	va_start(ap, fmt);
+	result = vsnprintf(*buffer, *space, fmt, ap);
+	va_end(ap);
+	if (result < 0) {
+		return -1;
+	} else if (result > *space) {
+		result = *space;
+	}
+	*buffer += result;
+	*space -= result;
+	return 0;
+}
+
+int ast_true(const char *s)
+{
+	if (ast_strlen_zero(s)) {
+		return 0;
+	}
+	return !strcasecmp(s, "yes") || !strcasecmp(s, "true") || !strcasecmp(s, "y")
+		|| !strcasecmp(s, "t") || !strcasecmp(s, "1") || !strcasecmp(s, "on");
+}
+
+int ast_false(const char *s)
+{
+	if (ast_strlen_zero(s)) {
+		return 0;
+	}
+	return !strcasecmp(s, "no") || !strcasecmp(s, "false") || !strcasecmp(s, "n")
+		|| !strcasecmp(s, "f") || !strcasecmp(s, "0") || !strcasecmp(s, "off");
+}
+
+/* ast_str */
+
+struct ast_str *ast_str_create(size_t init_len)
+{
+	struct ast_str *buf = __bench_calloc(1, sizeof(*buf) + init_len);
+
+	if (buf) {
+		buf->__AST_STR_LEN = init_len;
+	}
+	return buf;
+}
+
+int ast_str_make_space(struct ast_str **buf, size_t new_len)
+{
+	struct ast_str *old = *buf;
+
+	if (new_len <= (*buf)->__AST_STR_LEN) {
+		return 0;
+	}
+	*buf = realloc(*buf, new_len + sizeof(struct ast_str));
+	if (!*buf) {
+		*buf = old;
+		return -1;
+	}
+	(*buf)->__AST_STR_LEN = new_len;
+	if ((*buf)->__AST_STR_TS) {
+		pthread_setspecific((*buf)->__AST_STR_TS->key, *buf);
+	}
+	return 0;
+}
+
+static int str_helper(struct ast_str **buf, ssize_t max_len, int append, const char *fmt, va_list ap)
+{
+	int res;
+	int added;
+	size_t offset = (append && (*buf)->__AST_STR_LEN) ? (*buf)->__AST_STR_USED : 0;
+
+	if (max_len < 0) {
+		max_len = (*buf)->__AST_STR_LEN;
+	}
+	do {
+		va_list aq;
+
+		va_copy(aq, ap);
+		res = vsnprintf((*buf)->__AST_STR_STR + offset, (*buf)->__AST_STR_LEN - offset, fmt, aq);
+		va_end(aq);
+		if (res < 0) {
+			return -1;
+		}
+		added = res;
+		if (offset + res < (*buf)->__AST_STR_LEN) {
+			break;
+		}
+		if (max_len && (*buf)->__AST_STR_LEN >= (size_t) max_len) {
+			/* truncated at the limit */
+			added = (*buf)->__AST_STR_LEN - offset - 1;
+			break;
+		}
+		{
+			size_t need = offset + res + 1;
+			if (max_len && need > (size_t) max_len) {
+				need = max_len;
+			}
+			if (ast_str_make_space(buf, need)) {
+				return -1;
+			}
+		}
+	} while (1);
+	(*buf)->__AST_STR_USED = offset + added;
+	return res;
+}
+
+int ast_str_set(struct ast_str **buf, ssize_t max_len, const char *fmt, ...)
+{
+	va_list ap;
+	int res;
+
+	va_start(ap, fmt);
+	res = str_helper(buf, max_len, 0, fmt, ap);
+	va_end(ap);
+	return res;
+}
+
+int ast_str_append(struct ast_str **buf, ssize_t max_len, const char *fmt, ...)
+{
+	va_list ap;
+	int res;
+
+	va_start(ap, fmt);
+	res = str_helper(buf, max_len, 1, fmt, ap);
+	va_end(ap);
+	return res;
+}
+
+static char *str_substr(struct ast_str **buf, ssize_t maxlen, const char *src, size_t maxsrc, int append)
+{
+	size_t used = append ? (*buf)->__AST_STR_USED : 0;
+	size_t len = strnlen(src, maxsrc);
+
+	if (maxlen < 0) {
+		maxlen = (*buf)->__AST_STR_LEN;
+	}
+	if (used + len + 1 > (*buf)->__AST_STR_LEN) {
+		size_t need = used + len + 1;
+		if (maxlen && need > (size_t) maxlen) {
+			need = maxlen;
+		}
+		if (need > (*buf)->__AST_STR_LEN) {
+			ast_str_make_space(buf, need);
+		}
+	}
+	if (used + len + 1 > (*buf)->__AST_STR_LEN) {
+		len = (*buf)->__AST_STR_LEN - used - 1;
+	}
+	memcpy((*buf)->__AST_STR_STR + used, src, len);
+	(*buf)->__AST_STR_USED = used + len;
+	(*buf)->__AST_STR_STR[used + len] = '\0';
+	return (*buf)->__AST_STR_STR;
+}
+
+char *ast_str_set_substr(struct ast_str **buf, ssize_t maxlen, const char *src, size_t maxsrc)
+{
+	return str_substr(buf, maxlen, src, maxsrc, 0);
+}
+
+char *ast_str_append_substr(struct ast_str **buf, ssize_t maxlen, const char *src, size_t maxsrc)
+{
+	return str_substr(buf, maxlen, src, maxsrc, 1);
+}
+
+/* argument parsing, as in main/app.c */
+
+unsigned int __ast_app_separate_args(char *buf, char delim, int remove_chars, char **array, int arraylen)
+{
+	int argc;
+	char *scan, *wasdelim = NULL;
+	int paren = 0, quote = 0, bracket = 0;
+
+	if (!array || !arraylen) {
+		return 0;
+	}
+	memset(array, 0, arraylen * sizeof(*array));
+	if (!buf) {
+		return 0;
+	}
+	scan = buf;
+	for (argc = 0; *scan && (argc < arraylen - 1); argc++) {
+		array[argc] = scan;
+		for (; *scan; scan++) {
+			if (*scan == '(') {
+				paren++;
+			} else if (*scan == ')') {
+				if (paren) {
+					paren--;
+				}
+			} else if (*scan == '[') {
+				bracket++;
+			} else if (*scan == ']') {
+				if (bracket) {
+					bracket--;
+				}
+			} else if (*scan == '"' && delim != '"') {
+				quote = quote ? 0 : 1;
+				if (remove_chars) {
+					memmove(scan, scan + 1, strlen(scan));
+					scan--;
+				}
+			} else if (*scan == '\\') {
+				if (remove_chars) {
+					memmove(scan, scan + 1, strlen(scan));
+				} else {
+					scan++;
+				}
+			} else if ((*scan == delim) && !paren && !quote && !bracket) {
+				wasdelim = scan;
+				*scan++ = '\0';
+				break;
+			}
+		}
+	}
+	if (*scan || (scan > buf && (scan - 1) == wasdelim)) {
+		array[argc++] = scan;
+	}
+	return argc;
+}
+
+/* channels, variables and datastores */
+
+struct ast_channel *bench_channel_alloc(const char *name)
+{
+	struct ast_channel *chan = calloc(1, sizeof(*chan));
+
+	ast_mutex_init(&chan->lock);
+	ast_copy_string(chan->name, name, sizeof(chan->name));
+	ast_copy_string(chan->context, "default", sizeof(chan->context));
+	ast_copy_string(chan->exten, "s", sizeof(chan->exten));
+	chan->priority = 1;
+	return chan;
+}
+
+void bench_channel_destroy(struct ast_channel *chan)
+{
+	struct bench_var *var;
+	struct ast_datastore *ds;
+
+	while ((ds = AST_LIST_REMOVE_HEAD(&chan->datastores, entry))) {
+		ast_datastore_free(ds);
+	}
+	while ((var = AST_LIST_REMOVE_HEAD(&chan->varshead, entry))) {
+		free(var->value);
+		free(var);
+	}
+	ast_mutex_destroy(&chan->lock);
+	free(chan);
+}
+
+static AST_LIST_HEAD_NOLOCK(, bench_var) globals;
+AST_MUTEX_DEFINE_STATIC(globals_lock);
+
+const char *pbx_builtin_getvar_helper(struct ast_channel *chan, const char *name)
+{
+	struct bench_var *var;
+	const char *ret = NULL;
+
+	if (chan) {
+		ast_channel_lock(chan);
+		AST_LIST_TRAVERSE(&chan->varshead, var, entry) {
+			if (!strcmp(var->name, name)) {
+				ret = var->value;
+				break;
+			}
+		}
+		ast_channel_unlock(chan);
+		if (ret) {
+			return ret;
+		}
+	}
+	ast_mutex_lock(&globals_lock);
+	AST_LIST_TRAVERSE(&globals, var, entry) {
+		if (!strcmp(var->name, name)) {
+			ret = var->value;
+			break;
+		}
+	}
+	ast_mutex_unlock(&globals_lock);
+	return ret;
+}
+
+int pbx_builtin_setvar_helper(struct ast_channel *chan, const char *name, const char *value)
+{
+	struct bench_var *var;
+	typeof(globals) *head = chan ? (typeof(globals) *) &chan->varshead : &globals;
+
+	/* like the core, the new value is a fresh copy and the old one is released */
+	if (chan) {
+		ast_channel_lock(chan);
+	} else {
+		ast_mutex_lock(&globals_lock);
+	}
+	AST_LIST_TRAVERSE_SAFE_BEGIN(head, var, entry) {
+		if (!strcmp(var->name, name)) {
+			AST_LIST_REMOVE_CURRENT(entry);
+			free(var->value);
+			free(var);
+			break;
+		}
+	}
+	AST_LIST_TRAVERSE_SAFE_END;
+	if (value) {
+		var = malloc(sizeof(*var) + strlen(name) + 1);
+		strcpy(var->name, name);
+		var->value = strdup(value);
+		AST_LIST_INSERT_HEAD(head, var, entry);
+	}
+	if (chan) {
+		ast_channel_unlock(chan);
+	} else {
+		ast_mutex_unlock(&globals_lock);
+	}
+	return 0;
+}
+
+struct ast_datastore *ast_datastore_alloc(const struct ast_datastore_info *info, const char *uid)
+{
+	struct ast_datastore *datastore = calloc(1, sizeof(*datastore));
+
+	datastore->info = info;
+	datastore->uid = uid ? strdup(uid) : NULL;
+	return datastore;
+}
+
+int ast_datastore_free(struct ast_datastore *datastore)
+{
+	if (datastore->info->destroy && datastore->data) {
+		datastore->info->destroy(datastore->data);
+		datastore->data = NULL;
+	}
+	free((char *) datastore->uid);
+	free(datastore);
+	return 0;
+}
+
+int ast_channel_datastore_add(struct ast_channel *chan, struct ast_datastore *datastore)
+{
+	AST_LIST_INSERT_HEAD(&chan->datastores, datastore, entry);
+	return 0;
+}
+
+int ast_channel_datastore_remove(struct ast_channel *chan, struct ast_datastore *datastore)
+{
+	return AST_LIST_REMOVE(&chan->datastores, datastore, entry) ? 0 : -1;
+}
+
+struct ast_datastore *ast_channel_datastore_find(struct ast_channel *chan, const struct ast_datastore_info *info, const char *uid)
+{
+	struct ast_datastore *datastore;
+
+	AST_LIST_TRAVERSE(&chan->datastores, datastore, entry) {
+		if (datastore->info != info) {
+			continue;
+		}
+		if (!uid || (datastore->uid && !strcmp(uid, datastore->uid))) {
+			break;
+		}
+	}
+	return datastore;
+}
+
+/* function and application registries */
+
+#define BENCH_MAX_REGISTERED 64
+
+static struct ast_custom_function *functions[BENCH_MAX_REGISTERED];
+static struct {
+	const char *name;
+	int (*execute)(struct ast_channel *, const char *);
+} applications[BENCH_MAX_REGISTERED];
+
+int __ast_custom_function_register(struct ast_custom_function *acf, struct ast_module *mod)
+{
+	size_t i;
+
+	for (i = 0; i < ARRAY_LEN(functions); i++) {
+		if (!functions[i]) {
+			functions[i] = acf;
+			return 0;
+		}
+	}
+	return -1;
+}
+
+/*! there is no live_dangerously here: the escalation is not checked */
+int __ast_custom_function_register_escalating(struct ast_custom_function *acf, enum ast_custom_function_escalation escalation, struct ast_module *mod)
+{
+	return __ast_custom_function_register(acf, mod);
+}
+
+int ast_custom_function_unregister(struct ast_custom_function *acf)
+{
+	size_t i;
+
+	for (i = 0; i < ARRAY_LEN(functions); i++) {
+		if (functions[i] == acf) {
+			functions[i] = NULL;
+			return 0;
+		}
+	}
+	return -1;
+}
+
+int ast_register_application2(const char *app, int (*execute)(struct ast_channel *, const char *), const char *synopsis, const char *description, void *mod)
+{
+	size_t i;
+
+	for (i = 0; i < ARRAY_LEN(applications); i++) {
+		if (!applications[i].name) {
+			applications[i].name = app;
+			applications[i].execute = execute;
+			return 0;
+		}
+	}
+	return -1;
+}
+
+int ast_unregister_application(const char *app)
+{
+	size_t i;
+
+	for (i = 0; i < ARRAY_LEN(applications); i++) {
+		if (applications[i].name && !strcasecmp(applications[i].name, app)) {
+			applications[i].name = NULL;
+			return 0;
+		}
+	}
+	return -1;
+}
+
+struct ast_custom_function *bench_function_find(const char *name)
+{
+	size_t i;
+
+	for (i = 0; i < ARRAY_LEN(functions); i++) {
+		if (functions[i] && !strcasecmp(functions[i]->name, name)) {
+			return functions[i];
+		}
+	}
+	return NULL;
+}
+
+int bench_function_read(struct ast_channel *chan, const char *expr, char *buf, size_t len)
+{
+	char *copy = ast_strdupa(expr);
+	char *args = strchr(copy, '(');
+	char *end;
+	struct ast_custom_function *acf;
+	int res;
+
+	if (!args || !(end = strrchr(args, ')'))) {
+		return -1;
+	}
+	*args++ = '\0';
+	*end = '\0';
+	if (!(acf = bench_function_find(copy))) {
+		return -1;
+	}
+	if (acf->read) {
+		return acf->read(chan, copy, args, buf, len);
+	}
+	if (acf->read2) {
+		struct ast_str *str = ast_str_create(16);
+		res = acf->read2(chan, copy, args, &str, len);
+		ast_copy_string(buf, ast_str_buffer(str), len);
+		ast_free(str);
+		return res;
+	}
+	return -1;
+}
+
+/*! ${name} and ${FUNCTION(args)}, nested; none of the other dialplan expressions */
+void ast_str_substitute_variables(struct ast_str **buf, ssize_t maxlen, struct ast_channel *chan, const char *templ)
+{
+	const char *p = templ;
+
+	while (*p) {
+		const char *start = strstr(p, "${");
+		const char *q;
+		int depth = 1;
+
+		if (!start) {
+			ast_str_append(buf, maxlen, "%s", p);
+			return;
+		}
+		ast_str_append_substr(buf, maxlen, p, start - p);
+		for (q = start + 2; *q && depth; q++) {
+			depth += (*q == '{') - (*q == '}');
+		}
+		if (depth) {
+			ast_str_append(buf, maxlen, "%s", start);
+			return;
+		}
+		char *inner = ast_strndup(start + 2, q - start - 3);
+		struct ast_str *name = ast_str_create(16);
+		ast_str_substitute_variables(&name, 0, chan, inner);
+		if (strchr(ast_str_buffer(name), '(')) {
+			char value[4096] = "";
+			bench_function_read(chan, ast_str_buffer(name), value, sizeof(value));
+			ast_str_append(buf, maxlen, "%s", value);
+		} else {
+			const char *value = pbx_builtin_getvar_helper(chan, ast_str_buffer(name));
+			ast_str_append(buf, maxlen, "%s", value ? value : "");
+		}
+		ast_free(name);
+		ast_free(inner);
+		p = q;
+	}
+}
+
+int bench_function_write(struct ast_channel *chan, const char *expr, const char *value)
+{
+	char *copy = ast_strdupa(expr);
+	char *args = strchr(copy, '(');
+	char *end;
+	struct ast_custom_function *acf;
+
+	if (!args || !(end = strrchr(args, ')'))) {
+		return -1;
+	}
+	*args++ = '\0';
+	*end = '\0';
+	if (!(acf = bench_function_find(copy)) || !acf->write) {
+		return -1;
+	}
+	return acf->write(chan, copy, args, value);
+}
+
+int bench_app_exec(struct ast_channel *chan, const char *app, const char *data)
+{
+	size_t i;
+
+	for (i = 0; i < ARRAY_LEN(applications); i++) {
+		if (applications[i].name && !strcasecmp(applications[i].name, app)) {
+			return applications[i].execute(chan, data);
+		}
+	}
+	return -1;
+}
+
+/* reference counted objects */
+
+struct bench_ao2 {
+	int refcount;
+	unsigned int options;
+	ao2_destructor_fn destructor;
+	pthread_rwlock_t lock;
+	char data[0] __attribute__((aligned(16)));
+};
+
+#define BENCH_AO2(o) ((struct bench_ao2 *) ((char *) (o) - offsetof(struct bench_ao2, data)))
+
+void *__bench_ao2_alloc(size_t data_size, ao2_destructor_fn destructor_fn, unsigned int options)
+{
+	struct bench_ao2 *obj = __bench_calloc(1, sizeof(*obj) + data_size);
+
+	if (!obj) {
+		return NULL;
+	}
+	obj->refcount = 1;
+	obj->options = options;
+	obj->destructor = destructor_fn;
+	pthread_rwlock_init(&obj->lock, NULL);
+	return obj->data;
+}
+
+int __bench_ao2_ref(void *o, int delta)
+{
+	struct bench_ao2 *obj = BENCH_AO2(o);
+	int old = __atomic_fetch_add(&obj->refcount, delta, __ATOMIC_SEQ_CST);
+
+	if (old + delta == 0) {
+		if (obj->destructor) {
+			obj->destructor(o);
+		}
+		pthread_rwlock_destroy(&obj->lock);
+		__bench_free(obj);
+	} else if (old + delta < 0) {
+		fprintf(stderr, "ao2 refcount below zero\n");
+		abort();
+	}
+	return old;
+}
+
+void __bench_ao2_lock(void *o, int write)
+{
+	if (write) {
+		pthread_rwlock_wrlock(&BENCH_AO2(o)->lock);
+	} else {
+		pthread_rwlock_rdlock(&BENCH_AO2(o)->lock);
+	}
+}
+
+void __bench_ao2_unlock(void *o)
+{
+	pthread_rwlock_unlock(&BENCH_AO2(o)->lock);
+}
+
+void *__bench_ao2_global_obj_replace(struct ao2_global_obj *holder, void *obj)
+{
+	void *old;
+
+	pthread_rwlock_wrlock(&holder->lock);
+	if (obj) {
+		ao2_ref(obj, +1);
+	}
+	old = holder->obj;
+	holder->obj = obj;
+	pthread_rwlock_unlock(&holder->lock);
+	return old;
+}
+
+void *__bench_ao2_global_obj_ref(struct ao2_global_obj *holder)
+{
+	void *obj;
+
+	pthread_rwlock_rdlock(&holder->lock);
+	obj = holder->obj;
+	if (obj) {
+		ao2_ref(obj, +1);
+	}
+	pthread_rwlock_unlock(&holder->lock);
+	return obj;
+}
+
+/* containers: an array searched linearly, good enough for the handful of objects res_json keeps */
+
+struct ao2_container {
+	unsigned int options;
+	ao2_callback_fn *cmp_fn;
+	int count;
+	int size;
+	void **objs;
+};
+
+static void container_destroy(void *obj)
+{
+	struct ao2_container *c = obj;
+	int i;
+
+	for (i = 0; i < c->count; i++) {
+		ao2_ref(c->objs[i], -1);
+	}
+	__bench_free(c->objs);
+}
+
+struct ao2_container *__bench_ao2_container_alloc(unsigned int container_options, ao2_hash_fn *hash_fn, ao2_sort_fn *sort_fn, ao2_callback_fn *cmp_fn)
+{
+	struct ao2_container *c = __bench_ao2_alloc(sizeof(*c), container_destroy, AO2_ALLOC_OPT_LOCK_RWLOCK);
+
+	if (c) {
+		c->options = container_options;
+		c->cmp_fn = cmp_fn;
+	}
+	return c;
+}
+
+int ao2_container_count(struct ao2_container *c)
+{
+	return c->count;
+}
+
+static int container_matches(struct ao2_container *c, void *obj, const void *arg, int flags, ao2_callback_fn *cb_fn)
+{
+	if (cb_fn) {
+		return cb_fn(obj, (void *) arg, flags);
+	}
+	if ((flags & OBJ_SEARCH_MASK) == OBJ_SEARCH_NONE) {
+		return CMP_MATCH;
+	}
+	if (!c->cmp_fn) {
+		return (flags & OBJ_SEARCH_MASK) == OBJ_SEARCH_OBJECT && obj == arg ? CMP_MATCH : 0;
+	}
+	return c->cmp_fn(obj, (void *) arg, flags);
+}
+
+int __bench_ao2_link(struct ao2_container *c, void *obj, int flags)
+{
+	if (!(flags & OBJ_NOLOCK)) {
+		ao2_wrlock(c);
+	}
+	if ((c->options & AO2_CONTAINER_ALLOC_OPT_DUPS_REPLACE) == AO2_CONTAINER_ALLOC_OPT_DUPS_REPLACE) {
+		int i;
+		for (i = 0; i < c->count; i++) {
+			if (container_matches(c, c->objs[i], obj, OBJ_SEARCH_OBJECT, NULL) & CMP_MATCH) {
+				ao2_ref(c->objs[i], -1);
+				c->objs[i] = obj;
+				ao2_ref(obj, +1);
+				if (!(flags & OBJ_NOLOCK)) {
+					ao2_unlock(c);
+				}
+				return 1;
+			}
+		}
+	}
+	if (c->count == c->size) {
+		c->size = c->size ? c->size * 2 : 8;
+		c->objs = __bench_realloc(c->objs, c->size * sizeof(void *));
+	}
+	c->objs[c->count++] = obj;
+	ao2_ref(obj, +1);
+	if (!(flags & OBJ_NOLOCK)) {
+		ao2_unlock(c);
+	}
+	return 1;
+}
+
+void *__bench_ao2_unlink(struct ao2_container *c, void *obj, int flags)
+{
+	int i;
+
+	if (!(flags & OBJ_NOLOCK)) {
+		ao2_wrlock(c);
+	}
+	for (i = 0; i < c->count; i++) {
+		if (c->objs[i] == obj) {
+			memmove(&c->objs[i], &c->objs[i + 1], (c->count - i - 1) * sizeof(void *));
+			c->count--;
+			ao2_ref(obj, -1);
+			break;
+		}
+	}
+	if (!(flags & OBJ_NOLOCK)) {
+		ao2_unlock(c);
+	}
+	return NULL;
+}
+
+void *ao2_callback(struct ao2_container *c, int flags, ao2_callback_fn *cb_fn, void *arg)
+{
+	void *found = NULL;
+	int i;
+
+	if (!(flags & OBJ_NOLOCK)) {
+		if (flags & OBJ_UNLINK) {
+			ao2_wrlock(c);
+		} else {
+			ao2_rdlock(c);
+		}
+	}
+	for (i = 0; i < c->count; i++) {
+		void *obj = c->objs[i];
+		int res = container_matches(c, obj, arg, flags, cb_fn);
+
+		if (res & CMP_MATCH) {
+			if (flags & OBJ_UNLINK) {
+				memmove(&c->objs[i], &c->objs[i + 1], (c->count - i - 1) * sizeof(void *));
+				c->count--;
+				i--;
+				if (flags & OBJ_NODATA) {
+					ao2_ref(obj, -1);
+				} else if (!found) {
+					found = obj;
+				} else {
+					ao2_ref(obj, -1);
+				}
+			} else if (!(flags & OBJ_NODATA) && !found) {
+				found = obj;
+				ao2_ref(obj, +1);
+			}
+			if (!(flags & OBJ_MULTIPLE)) {
+				break;
+			}
+		}
+		if (res & CMP_STOP) {
+			break;
+		}
+	}
+	if (!(flags & OBJ_NOLOCK)) {
+		ao2_unlock(c);
+	}
+	return found;
+}
+
+void *ao2_find(struct ao2_container *c, const void *arg, int flags)
+{
+	return ao2_callback(c, flags & ~OBJ_MULTIPLE, NULL, (void *) arg);
+}
+
+struct ao2_iterator ao2_iterator_init(struct ao2_container *c, int flags)
+{
+	struct ao2_iterator iter = { .c = c, .pos = 0, .flags = flags };
+
+	ao2_ref(c, +1);
+	return iter;
+}
+
+void *ao2_iterator_next(struct ao2_iterator *iter)
+{
+	void *obj = NULL;
+
+	ao2_rdlock(iter->c);
+	if (iter->pos < iter->c->count) {
+		obj = iter->c->objs[iter->pos++];
+		ao2_ref(obj, +1);
+	}
+	ao2_unlock(iter->c);
+	return obj;
+}
+
+void ao2_iterator_destroy(struct ao2_iterator *iter)
+{
+	ao2_cleanup(iter->c);
+	iter->c = NULL;
+}
+
+/* CLI: commands print to the file descriptor they are given */
+
+#define BENCH_MAX_CLI 32
+static struct ast_cli_entry *cli_entries[BENCH_MAX_CLI];
+
+void ast_cli(int fd, const char *fmt, ...)
+{
+	va_list ap;
+
+	va_start(ap, fmt);
+	vdprintf(fd, fmt, ap);
+	va_end(ap);
+}
+
+int ast_cli_register_multiple(struct ast_cli_entry *e, int len)
+{
+	int i, j;
+
+	for (i = 0; i < len; i++) {
+		e[i].handler(&e[i], CLI_INIT, NULL);
+		for (j = 0; j < BENCH_MAX_CLI; j++) {
+			if (!cli_entries[j]) {
+				cli_entries[j] = &e[i];
+				break;
+			}
+		}
+	}
+	return 0;
+}
+
+int ast_cli_unregister_multiple(struct ast_cli_entry *e, int len)
+{
+	int i, j;
+
+	for (i = 0; i < len; i++) {
+		for (j = 0; j < BENCH_MAX_CLI; j++) {
+			if (cli_entries[j] == &e[i]) {
+				cli_entries[j] = NULL;
+			}
+		}
+	}
+	return 0;
+}
+
+char *ast_cli_complete(const char *word, const char * const choices[], int pos)
+{
+	return NULL;
+}
+
+int bench_cli_exec(int fd, const char *line)
+{
+	char *copy = ast_strdupa(line);
+	const char *argv[32];
+	int argc = 0, j;
+	char *tok;
+
+	while ((tok = strsep(&copy, " ")) && argc < 31) {
+		if (*tok) {
+			argv[argc++] = tok;
+		}
+	}
+	argv[argc] = NULL;
+	for (j = 0; j < BENCH_MAX_CLI; j++) {
+		struct ast_cli_entry *e = cli_entries[j];
+		size_t cmdlen;
+
+		if (!e) {
+			continue;
+		}
+		cmdlen = strlen(e->command);
+		if (!strncmp(line, e->command, cmdlen) && (line[cmdlen] == '\0' || line[cmdlen] == ' ')) {
+			struct ast_cli_args a = { .fd = fd, .argc = argc, .argv = argv, .line = line };
+			char *res = e->handler(e, 0, &a);
+			if (res == CLI_SHOWUSAGE) {
+				dprintf(fd, "%s", e->usage);
+			}
+			return res == CLI_SUCCESS ? 0 : -1;
+		}
+	}
+	return -1;
+}
+
+/* configuration files: categories of name = value lines, ';' starts a comment */
+
+struct ast_config {
+	struct bench_category {
+		char *name;
+		struct ast_variable *vars;
+		struct bench_category *next;
+	} *categories;
+};
+
+static char *config_trim(char *s)
+{
+	char *end;
+
+	while (*s == ' ' || *s == '\t') {
+		s++;
+	}
+	end = s + strlen(s);
+	while (end > s && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r' || end[-1] == '\n')) {
+		*--end = '\0';
+	}
+	return s;
+}
+
+const char *ast_config_AST_CONFIG_DIR = ".";
+
+static void __attribute__((constructor)) bench_paths_init(void)
+{
+	const char *dir = getenv("BENCH_CONFIG_DIR");
+
+	if (dir) {
+		ast_config_AST_CONFIG_DIR = dir;
+	}
+}
+
+struct ast_config *ast_config_load2(const char *filename, const char *who_asked, struct ast_flags flags)
+{
+	const char *dir = getenv("BENCH_CONFIG_DIR");
+	char path[PATH_MAX], line[1024];
+	struct ast_config *cfg;
+	struct bench_category *category = NULL, **last_category;
+	struct ast_variable **last_var = NULL;
+	FILE *f;
+
+	snprintf(path, sizeof(path), "%s/%s", dir ? dir : ".", filename);
+	if (!(f = fopen(path, "r"))) {
+		return CONFIG_STATUS_FILEMISSING;
+	}
+	cfg = ast_calloc(1, sizeof(*cfg));
+	last_category = &cfg->categories;
+	while (fgets(line, sizeof(line), f)) {
+		char *s = strchr(line, ';'), *eq;
+
+		if (s) {
+			*s = '\0';
+		}
+		s = config_trim(line);
+		if (!*s) {
+			continue;
+		}
+		if (*s == '[') {
+			char *end = strchr(s, ']');
+			if (!end) {
+				break;
+			}
+			*end = '\0';
+			category = ast_calloc(1, sizeof(*category));
+			category->name = ast_strdup(s + 1);
+			*last_category = category;
+			last_category = &category->next;
+			last_var = &category->vars;
+			continue;
+		}
+		if (!category || !(eq = strchr(s, '='))) {
+			fclose(f);
+			ast_config_destroy(cfg);
+			return CONFIG_STATUS_FILEINVALID;
+		}
+		*eq++ = '\0';
+		if (*eq == '>') {
+			eq++;
+		}
+		struct ast_variable *var = ast_calloc(1, sizeof(*var));
+		var->name = ast_strdup(config_trim(s));
+		var->value = ast_strdup(config_trim(eq));
+		*last_var = var;
+		last_var = &var->next;
+	}
+	fclose(f);
+	return cfg;
+}
+
+void ast_config_destroy(struct ast_config *cfg)
+{
+	struct bench_category *category;
+
+	if (!cfg) {
+		return;
+	}
+	while ((category = cfg->categories)) {
+		struct ast_variable *var;
+		cfg->categories = category->next;
+		while ((var = category->vars)) {
+			category->vars = var->next;
+			ast_free((char *) var->name);
+			ast_free((char *) var->value);
+			ast_free(var);
+		}
+		ast_free(category->name);
+		ast_free(category);
+	}
+	ast_free(cfg);
+}
+
+struct ast_variable *ast_variable_browse(const struct ast_config *config, const char *category)
+{
+	struct bench_category *c;
+
+	for (c = config->categories; c; c = c->next) {
+		if (!strcasecmp(c->name, category)) {
+			return c->vars;
+		}
+	}
+	return NULL;
+}
+
+const char *ast_variable_retrieve(struct ast_config *config, const char *category, const char *variable)
+{
+	struct ast_variable *var;
+
+	for (var = ast_variable_browse(config, category); var; var = var->next) {
+		if (!strcasecmp(var->name, variable)) {
+			return var->value;
+		}
+	}
+	return NULL;
+}
@@ -0,0 +1,28 @@
+/*
+ * Harness-side entry points into the stand-in core (bench/stubs.c).
+ */
+
+#ifndef _BENCH_STUBS_H
+#define _BENCH_STUBS_H
+
+#include <stdint.h>
+
+struct ast_channel;
+struct ast_custom_function;
+
+extern uint64_t bench_alloc_count;
+extern uint64_t bench_free_count;
+/*! module references held (ast_module_ref less ast_module_unref) */
+extern int bench_module_refs;
+
+struct ast_custom_function *bench_function_find(const char *name);
+/*! evaluate "NAME(args)" like ${NAME(args)} would */
+int bench_function_read(struct ast_channel *chan, const char *expr, char *buf, size_t len);
+/*! evaluate Set(NAME(args)=value) */
+int bench_function_write(struct ast_channel *chan, const char *expr, const char *value);
+/*! run an application like the pbx core would */
+int bench_app_exec(struct ast_channel *chan, const char *app, const char *data);
+/*! run a CLI command line, output goes to fd */
+int bench_cli_exec(int fd, const char *line);
+
+#endif
@@ -3,4 +3,5 @@ if [ ! -s include/asterisk.h ] ; then
 	exit
 fi
 cp asterisk-res_json/res_json.c addons/
+cp asterisk-res_json/res_json.conf.sample configs/samples/
 echo "edit addons/Makefile: add res_json to the list of modules built"
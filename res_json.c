@@ -28,6 +28,22 @@
  * \brief jsonadd add an element at path in a json document
  * \brief jsonset set value of an element at path in a json document
  * \brief jsondelete delete element at path from a json document
+ * \brief jsonedit run several add, set and delete operations on a json document at once
+ * \brief jsonpatch apply a json patch (rfc 6902) to a json document
+ * \brief jsonmergepatch apply a json merge patch (rfc 7386) to a json document
+ * \brief JSON_OPEN() parse a json document once and keep it under a handle
+ * \brief JSON_CLOSE() write the document of a handle back to a variable and close the handle
+ * \brief JSON_ITER() open a cursor over an array or an object in a json document
+ * \brief JSON_NEXT() move a cursor on to the next element
+ * \brief JSON_FLUSH() write documents changed with lazy write-back into their variables
+ * \brief JSON_SHARED() publish a json document for all channels and get elements from it
+ * \brief JSONFILE() get element at path from a json file, reloaded when the file changes
+ * \brief JSON_INDEX_CREATE() index an array of objects in a shared json document by a field
+ * \brief JSON_LOOKUP() get element at path from the array element with a given key
+ * \brief JSON_LPM() get the entry of the longest prefix of a number in a table of prefixes
+ * \brief JSON_MEMBER() check whether a value is in an array of a shared json document
+ * \brief JSON_TEMPLATE() render a json template from res_json.conf with the channel variables
+ * \brief JSONVALID() check a json document without parsing it, optionally against limits
  *
  * \author\verbatim Radu Maierean <radu dot maierean at gmail> \endverbatim
  * 
@@ -41,6 +57,21 @@
 
 #include "asterisk.h"
 
+#include <errno.h>
+#include <fcntl.h>
+#include <float.h>
+#include <math.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef HAVE_INOTIFY
+#include <sys/inotify.h>
+#endif
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define JSON_SCAN_X86
+#endif
+
 #include "asterisk/file.h"
 #include "asterisk/channel.h"
 #include "asterisk/pbx.h"
@@ -48,6 +79,13 @@
 #include "asterisk/app.h"
 #include "asterisk/utils.h"
 #include "asterisk/json.h"
+#include "asterisk/astobj2.h"
+#include "asterisk/cli.h"
+#include "asterisk/dlinkedlists.h"
+#include "asterisk/threadstorage.h"
+#include "asterisk/time.h"
+#include "asterisk/config.h"
+#include "asterisk/paths.h"
 
 /*** DOCUMENTATION
 	<function name="JSONPRETTY" language="en_US">
@@ -158,6 +196,7 @@
 		<see-also>
 			<ref type="application">JsonSet</ref>
 			<ref type="application">JsonDelete</ref>
+			<ref type="application">JsonEdit</ref>
 		</see-also>
 	</application>
 	<application name="JsonSet" language="en_US">
@@ -195,6 +234,7 @@
 		<see-also>
 			<ref type="application">JsonAdd</ref>
 			<ref type="application">JsonDelete</ref>
+			<ref type="application">JsonEdit</ref>
 		</see-also>
 	</application>
 	<application name="JsonDelete" language="en_US">
@@ -221,16 +261,433 @@
 		<see-also>
 			<ref type="application">JsonAdd</ref>
 			<ref type="application">JsonSet</ref>
+			<ref type="application">JsonEdit</ref>
+		</see-also>
+	</application>
+	<application name="JsonEdit" language="en_US">
+		<synopsis>
+			runs several add, set and delete operations on a json document at once
+		</synopsis>
+		<syntax>
+			<parameter name="jsonvarname" required="true">
+				<para>the name (not the contents!) of a variable that contains the json struct</para>
+			</parameter>
+			<parameter name="operation" required="true" multiple="true">
+				<para>an operation to run on the document: add(path,type,name,value), set(path,value) 
+				or delete(path); the arguments have the same meaning as the ones of JsonAdd, JsonSet 
+				and JsonDelete</para>
+			</parameter>
+		</syntax>
+		<description>
+			<para>the first parameter is interpreted as a variable name, and its contents is 
+			considered to be a json document. the json document is parsed once, the operations are 
+			run against it in the given order, and the contents of the json document variable is 
+			updated once, after the last operation. the operations stop at the first one that 
+			fails: the variable is left unchanged, JSONRESULT is set to the error code of the failed 
+			operation and JSONFAILEDOP to its number (starting at 1). JSONFAILEDOP is 0 if all the 
+			operations were successful.</para>
+		</description>
+		<see-also>
+			<ref type="application">JsonAdd</ref>
+			<ref type="application">JsonSet</ref>
+			<ref type="application">JsonDelete</ref>
+		</see-also>
+	</application>
+	<application name="JsonPatch" language="en_US">
+		<synopsis>
+			applies a json patch (rfc 6902) to a json document
+		</synopsis>
+		<syntax>
+			<parameter name="jsonvarname" required="true">
+				<para>the name (not the contents!) of a variable that contains the json struct</para>
+			</parameter>
+			<parameter name="patchvarname" required="true">
+				<para>the name of a variable that contains the json patch: an array of operations 
+				like {"op":"replace","path":"/path/to/element","value":1}</para>
+			</parameter>
+		</syntax>
+		<description>
+			<para>both variables are parsed once, the add, remove, replace, move, copy and test 
+			operations of the patch are run against the document in the given order, and the 
+			contents of the json document variable is updated once, after the last operation. the 
+			paths are json pointers (rfc 6901): a token is an array index only when it is applied to 
+			an array, "-" stands for the end of an array, and ~1 and ~0 stand for / and ~ in keys. 
+			like for JsonEdit, the operations stop at the first one that fails: the variable is left 
+			unchanged, JSONRESULT is set to the error code of the failed operation and JSONFAILEDOP 
+			to its number (starting at 1). a failed add or copy sets ASTJSON_ADD_FAILED, a failed 
+			replace ASTJSON_SET_FAILED, a failed remove ASTJSON_DELETE_FAILED (as does a move from 
+			a missing element), a failed test ASTJSON_NOTFOUND, and an operation that is not 
+			understood ASTJSON_INVALID_TYPE.</para>
+		</description>
+		<see-also>
+			<ref type="application">JsonMergePatch</ref>
+			<ref type="application">JsonEdit</ref>
+		</see-also>
+	</application>
+	<application name="JsonMergePatch" language="en_US">
+		<synopsis>
+			applies a json merge patch (rfc 7386) to a json document
+		</synopsis>
+		<syntax>
+			<parameter name="jsonvarname" required="true">
+				<para>the name (not the contents!) of a variable that contains the json struct</para>
+			</parameter>
+			<parameter name="patchvarname" required="true">
+				<para>the name of a variable that contains the json merge patch</para>
+			</parameter>
+		</syntax>
+		<description>
+			<para>both variables are parsed once, the patch is merged into the document, and the 
+			contents of the json document variable is updated once. the members of a patch object 
+			are merged into the members of the same name of the document, recursively; a member 
+			set to null removes the member from the document, and a value that is not an object 
+			replaces the one in the document. a patch that is an array replaces the whole 
+			document.</para>
+		</description>
+		<see-also>
+			<ref type="application">JsonPatch</ref>
+			<ref type="application">JsonEdit</ref>
 		</see-also>
 	</application>
+	<function name="JSON_OPEN" language="en_US">
+		<synopsis>
+			parses a json document once and keeps it open under a handle
+		</synopsis>	
+		<syntax>
+			<parameter name="jsonvarname" required="true">
+				<para>the name (not the contents!) of a variable that contains the json struct</para>
+			</parameter>
+		</syntax>
+		<description>
+			<para>parses the json document and returns a handle to it, like handle:1. the handle can 
+			be given to JSONGET, JSONPRETTY, JSONCOMPRESS, JsonVariables, JsonAdd, JsonSet, JsonDelete 
+			and JsonEdit instead of a variable name: they then read and change the open document 
+			directly, without parsing it or writing it back. the variable itself does not change 
+			until the handle is closed with JSON_CLOSE. handles belong to the channel and are 
+			dropped when it hangs up.</para>
+		</description>
+		<see-also>
+			<ref type="function">JSON_CLOSE</ref>
+		</see-also>
+	</function>
+	<function name="JSON_CLOSE" language="en_US">
+		<synopsis>
+			writes a json document open under a handle into a variable and closes the handle
+		</synopsis>	
+		<syntax>
+			<parameter name="handle" required="true">
+				<para>the handle returned by JSON_OPEN</para>
+			</parameter>
+			<parameter name="jsonvarname" required="false">
+				<para>the name of the variable the json document is written into; if missing, the 
+				document is dropped along with the changes made to it</para>
+			</parameter>
+		</syntax>
+		<description>
+			<para>closes a handle opened by JSON_OPEN, after writing its json document into the 
+			given variable. returns an empty string.</para>
+		</description>
+		<see-also>
+			<ref type="function">JSON_OPEN</ref>
+		</see-also>
+	</function>
+	<function name="JSON_ITER" language="en_US">
+		<synopsis>
+			opens a cursor over the elements of an array or an object in a json document
+		</synopsis>	
+		<syntax>
+			<parameter name="jsonvarname" required="true">
+				<para>the name (not the contents!) of a variable that contains the json struct</para>
+			</parameter>
+			<parameter name="path" required="false">
+				<para>path to the array or object to walk through; if empty, the document root</para>
+			</parameter>
+			<parameter name="fields" required="false">
+				<para>the fields of each element to set as dialplan variables, separated by 
+				ampersands. a field is a path inside the element (like "id" or "caller/name"), set 
+				into the variable named like its last segment, or name=path to choose the variable 
+				name</para>
+			</parameter>
+		</syntax>
+		<description>
+			<para>finds the array or object at the given path and returns a cursor over its 
+			elements, like iter:1, for JSON_NEXT. the document is read once, however many elements 
+			it has.</para>
+		</description>
+		<see-also>
+			<ref type="function">JSON_NEXT</ref>
+		</see-also>
+	</function>
+	<function name="JSON_NEXT" language="en_US">
+		<synopsis>
+			moves a cursor opened by JSON_ITER on to the next element
+		</synopsis>	
+		<syntax>
+			<parameter name="cursor" required="true">
+				<para>the cursor returned by JSON_ITER</para>
+			</parameter>
+		</syntax>
+		<description>
+			<para>returns 1 and hands the next element to the dialplan: its value goes into 
+			JSONVALUE (like JSONGET would return it), its type into JSONTYPE, and its index (or 
+			member name, for objects) into JSONKEY; the fields given to JSON_ITER are set too. 
+			returns 0 when there are no elements left, and closes the cursor.</para>
+		</description>
+		<see-also>
+			<ref type="function">JSON_ITER</ref>
+		</see-also>
+	</function>
+	<function name="JSON_FLUSH" language="en_US">
+		<synopsis>
+			writes the json documents changed with lazy write-back into their variables
+		</synopsis>	
+		<syntax>
+			<parameter name="jsonvarname" required="false" multiple="true">
+				<para>the name of a variable whose document is written back; if none is given, all 
+				the changed documents of the channel are</para>
+			</parameter>
+		</syntax>
+		<description>
+			<para>with writeback = lazy in res_json.conf, JsonAdd, JsonSet, JsonDelete and JsonEdit 
+			keep the changed document as a tree instead of serializing it into its variable after 
+			every change; the functions and apps of this module keep on seeing the changes. call 
+			JSON_FLUSH before anything else (like CURL) reads the variable. returns an empty 
+			string. a document that cannot be written back stays changed, and JSONRESULT is set 
+			to an error (LIMIT when its text is over maxoutput).</para>
+		</description>
+	</function>
+	<function name="JSON_SHARED" language="en_US">
+		<synopsis>
+			gets the value of an element at a given path in a json document shared by all channels
+		</synopsis>
+		<syntax>
+			<parameter name="name" required="true">
+				<para>the name the document was published under</para>
+			</parameter>
+			<parameter name="path" required="false">
+				<para>path to the element, like for JSONGET; if empty, the whole document</para>
+			</parameter>
+		</syntax>
+		<description>
+			<para>reading returns the value of an element in a shared document, the way JSONGET
+			does for a doc variable; the element type is returned in JSONTYPE. the document was
+			parsed when it was published, so reading it costs no parsing.</para>
+			<para>writing (Set(JSON_SHARED(name)=${doc})) parses the json text and publishes it
+			under the name, for every channel, replacing the version published before; channels
+			reading the old version at that moment finish with it. setting an empty value
+			removes the document.</para>
+		</description>
+		<see-also>
+			<ref type="function">JSONGET</ref>
+		</see-also>
+	</function>
+	<function name="JSONFILE" language="en_US">
+		<synopsis>
+			gets the value of an element at a given path in a json file
+		</synopsis>
+		<syntax>
+			<parameter name="file" required="true">
+				<para>the json file; a relative name is looked for in the asterisk configuration
+				directory</para>
+			</parameter>
+			<parameter name="path" required="false">
+				<para>path to the element, like for JSONGET; if empty, the whole document</para>
+			</parameter>
+		</syntax>
+		<description>
+			<para>returns the value of an element in a json file, the way JSONGET does for a doc
+			variable; the element type is returned in JSONTYPE. the file is parsed the first time
+			it is read and kept as a shared document named after the file (which JSON_SHARED
+			can read too). it is parsed again as soon as it is written or replaced, while the
+			calls reading the old version finish with it; if the new contents do not parse, the
+			old version is kept.</para>
+			<para>like FILE, this function is not allowed from external sources (AMI, ARI) unless
+			live_dangerously is set in asterisk.conf. at most 256 files are kept loaded, and a file
+			that cannot be loaded is not tried again for 10 seconds.</para>
+		</description>
+		<see-also>
+			<ref type="function">JSON_SHARED</ref>
+		</see-also>
+	</function>
+	<function name="JSON_INDEX_CREATE" language="en_US">
+		<synopsis>
+			indexes the elements of an array in a shared json document by the value of a field
+		</synopsis>
+		<syntax>
+			<parameter name="name" required="true">
+				<para>the name of the shared document (for JSONFILE, the name of the file, as given
+				to JSONFILE)</para>
+			</parameter>
+			<parameter name="arraypath" required="false">
+				<para>path to the array of objects; if empty, the document root</para>
+			</parameter>
+			<parameter name="keyfield" required="true">
+				<para>path, inside each element, to the field the elements are found by</para>
+			</parameter>
+			<parameter name="index" required="false">
+				<para>the name of the index; if left out, the name of the document</para>
+			</parameter>
+		</syntax>
+		<description>
+			<para>builds a hash index over the elements of the array, keyed by the (string or
+			integer) value of keyfield, for JSON_LOOKUP; returns the number of elements indexed.
+			when two elements have the same key, the first one is indexed. the index is rebuilt
+			over each new version of the document when it is published (or its file reloaded).
+			a document can have several indexes with different names; calling JSON_INDEX_CREATE
+			again with the name of an existing index replaces it.</para>
+		</description>
+		<see-also>
+			<ref type="function">JSON_LOOKUP</ref>
+			<ref type="function">JSON_SHARED</ref>
+		</see-also>
+	</function>
+	<function name="JSON_LOOKUP" language="en_US">
+		<synopsis>
+			gets the value of an element at a given path in the array element with a given key
+		</synopsis>
+		<syntax>
+			<parameter name="name" required="true">
+				<para>the name of the index built with JSON_INDEX_CREATE (the name of the shared
+				document, unless it was given one)</para>
+			</parameter>
+			<parameter name="key" required="true">
+				<para>the value of the key field of the element</para>
+			</parameter>
+			<parameter name="path" required="false">
+				<para>path inside the element, like for JSONGET; if empty, the whole element</para>
+			</parameter>
+		</syntax>
+		<description>
+			<para>finds the element with the given key through the index, however long the
+			array, and returns the value at the path inside it the way JSONGET does; the type is
+			returned in JSONTYPE.</para>
+		</description>
+		<see-also>
+			<ref type="function">JSON_INDEX_CREATE</ref>
+		</see-also>
+	</function>
+	<function name="JSON_LPM" language="en_US">
+		<synopsis>
+			finds the longest prefix of a number in a table of prefixes in a shared json document
+		</synopsis>
+		<syntax>
+			<parameter name="table" required="true">
+				<para>the name of the shared document, followed by the path to the table inside it
+				if the table is not the whole document (like "routes/prefixes")</para>
+			</parameter>
+			<parameter name="number" required="true">
+				<para>the number to match, like ${EXTEN}; a heading + is ignored</para>
+			</parameter>
+			<parameter name="field" required="false">
+				<para>path inside the entry of the prefix found, like for JSONGET; if empty, the
+				whole entry</para>
+			</parameter>
+		</syntax>
+		<description>
+			<para>the table is either an object whose member names are the prefixes (like
+			{"1555":"trunkA","1":"trunkB"}), or an array of objects with the prefix in their
+			"prefix" member. prefixes are made of digits, * and #; an empty prefix matches any
+			number. the table is compiled into a digit trie the first time it is used, and again
+			whenever a new version of the document is published.</para>
+			<para>returns the entry of the longest prefix of the number (or the value at field
+			in it) the way JSONGET returns values, with its type in JSONTYPE and the prefix
+			itself in JSONPREFIX. sets JSONRESULT to NOTFOUND when no prefix matches.</para>
+		</description>
+		<see-also>
+			<ref type="function">JSON_SHARED</ref>
+			<ref type="function">JSONFILE</ref>
+		</see-also>
+	</function>
+	<function name="JSON_MEMBER" language="en_US">
+		<synopsis>
+			checks whether a value is in an array of a shared json document
+		</synopsis>
+		<syntax>
+			<parameter name="setname" required="true">
+				<para>the name of the shared document, followed by the path to the array inside it
+				if the array is not the whole document (like "blocklists/spam")</para>
+			</parameter>
+			<parameter name="value" required="true">
+				<para>the value to look for, like ${CALLERID(num)}</para>
+			</parameter>
+		</syntax>
+		<description>
+			<para>returns 1 if the value is one of the strings or integers of the array, 0 if it
+			is not. the array is compiled into a hash set the first time it is used, and again
+			whenever a new version of the document is published; numbers are stored packed into
+			64-bit integers, and arrays of 65536 elements or more get a bloom filter in front of
+			the set.</para>
+		</description>
+		<see-also>
+			<ref type="function">JSON_SHARED</ref>
+			<ref type="function">JSONFILE</ref>
+		</see-also>
+	</function>
+	<function name="JSON_TEMPLATE" language="en_US">
+		<synopsis>
+			renders a json template with the variables of the channel
+		</synopsis>
+		<syntax>
+			<parameter name="name" required="true">
+				<para>the name of a template in the [templates] section of res_json.conf</para>
+			</parameter>
+		</syntax>
+		<description>
+			<para>returns the json text of the template, with each ${...} placeholder replaced by
+			the value of the variable (or the dialplan expression) it holds. a placeholder inside a
+			json string gets the value escaped into the string; a placeholder on its own, as in
+			{"count":${COUNT}}, gets a json number, true, false or null as they are, null for an
+			empty value, and a json string for anything else. the templates are compiled when the
+			module loads into runs of static (minified) text and slots, so rendering one is a
+			single pass that parses nothing.</para>
+		</description>
+		<see-also>
+			<ref type="application">JsonEdit</ref>
+		</see-also>
+	</function>
+	<function name="JSONVALID" language="en_US">
+		<synopsis>
+			checks whether a variable holds a valid json document
+		</synopsis>
+		<syntax>
+			<parameter name="jsonvarname" required="true">
+				<para>the name (not the contents!) of a variable that contains the json struct</para>
+			</parameter>
+			<parameter name="depth">
+				<para>the deepest nesting of objects and arrays allowed</para>
+			</parameter>
+			<parameter name="size">
+				<para>the longest document allowed, in bytes</para>
+			</parameter>
+			<parameter name="elements">
+				<para>the most values (objects, arrays and scalars, at any depth) allowed</para>
+			</parameter>
+		</syntax>
+		<description>
+			<para>returns 1 if the variable holds a json document the other functions would
+			accept, within the limits given, 0 if it does not. the byte offset where the text goes
+			wrong (or goes over a limit) is returned in the dialplan variable JSONERROROFFSET. the
+			text is checked in a single pass that allocates nothing; it is only parsed when the
+			check cannot settle it (a number too long to be sure of, or nesting as deep as the
+			parser allows). an open document (a handle) is checked as a tree, and the offset is
+			then 0. the limits are whole numbers, 0 for no limit.</para>
+		</description>
+		<see-also>
+			<ref type="function">JSONCOMPRESS</ref>
+		</see-also>
+	</function>
  ***/
 
 static const char *app_jsonvariables = "JsonVariables";
 static const char *app_jsonadd = "JsonAdd";
 static const char *app_jsonset = "JsonSet";
 static const char *app_jsondelete = "JsonDelete";
+static const char *app_jsonedit = "JsonEdit";
+static const char *app_jsonpatch = "JsonPatch";
+static const char *app_jsonmergepatch = "JsonMergePatch";
 
 #define MAX_ASTERISK_VARLEN    4096
+#define JSON_EDIT_MAX_OPS      100
 
 #define ASTJSON_OK             0
 #define ASTJSON_UNDECIDED      1
@@ -241,94 +698,4957 @@ static const char *app_jsondelete = "JsonDelete";
 #define ASTJSON_ADD_FAILED     6
 #define ASTJSON_SET_FAILED     7
 #define ASTJSON_DELETE_FAILED  8
+#define ASTJSON_LIMIT          9
 
-static void json_set_operation_result(struct ast_channel *chan, int result) {
-	char *numresult;
-	ast_asprintf(&numresult, "%d", result);
-	pbx_builtin_setvar_helper(chan, "JSONRESULT", numresult);
-}
+#define ASTJSON_RESULTS        10   // number of result codes above
 
-static int jsonpretty_exec(struct ast_channel *chan, 
-	const char *cmd, char *parse, char *buffer, size_t buflen
-) {
-// nicely format the contents of a varable that contains json
+// settings from res_json.conf
+#define JSON_CONFIG_FILE       "res_json.conf"
+#define JSON_CACHE_DOCS        8          // documents cached per channel, by default
+#define JSON_CACHE_MAX_DOCS    64         // documents cached per channel, at most
+#define JSON_PATH_CACHE_SIZE   1024       // compiled paths cached, by default
 
-	buffer[0] = 0;
+// the limits a call works within, so that a hostile document cannot pin the channel thread; 0 is
+//   no limit. documents are checked before they are parsed, generated text as it is produced
+struct json_limits {
+	size_t size;                          // bytes of a document
+	int depth;                            // nesting of objects and arrays in a document
+	size_t elements;                      // values (at any depth) in a document
+	size_t output;                        // bytes of json text generated at once
+};
 
-	// parse the function arguments
-	AST_DECLARE_APP_ARGS(args,
-		AST_APP_ARG(json);
-	);
-	if (ast_strlen_zero(parse)) {
-		ast_log(LOG_WARNING, "jsonpretty requires arguments (json)\n");
-		json_set_operation_result(chan, ASTJSON_ARG_NEEDED);
-		return 0;
-	}
-	AST_STANDARD_APP_ARGS(args, parse);
-	if (ast_strlen_zero(args.json)) {
-		ast_log(LOG_WARNING, "a valid asterisk variable name is required\n");
-		json_set_operation_result(chan, ASTJSON_ARG_NEEDED);
-		return 0;
-	}
-	// parse json
-	struct ast_json *doc = ast_json_load_string(pbx_builtin_getvar_helper(chan, args.json), NULL);
-	if (!doc) {
-		ast_log(LOG_WARNING, "source json parsing error\n");
-		json_set_operation_result(chan, ASTJSON_PARSE_ERROR);
-		return 0;
-	}
-	char *pretty = ast_json_dump_string_format(doc, AST_JSON_PRETTY);
-	ast_copy_string(buffer, pretty, buflen);
-	ast_json_unref(doc);
-	ast_json_free(pretty);
-	json_set_operation_result(chan, ASTJSON_OK);
-	return 0;
+// the settings live in one ao2 object that is never changed once published: loading res_json.conf
+//   builds a new one and swaps it into the global holder in one step (the way the config framework
+//   does it), so a call never sees half of a reload. every call pins the settings it starts with
+struct json_config {
+	int writeback_lazy;                   // keep changed documents as trees, write them back later
+	struct json_limits limits;
+	unsigned int cache_docs;              // documents cached per channel
+	unsigned int path_cache;              // compiled paths cached
+	struct ao2_container *templates;      // the compiled templates of JSON_TEMPLATE, by name
+};
+
+static AO2_GLOBAL_OBJ_STATIC(json_config_holder);
+
+static const struct json_config json_config_defaults = {
+	.cache_docs = JSON_CACHE_DOCS,
+	.path_cache = JSON_PATH_CACHE_SIZE,
+};
 
+static void json_config_destroy(void *obj) {
+	struct json_config *config = obj;
+	ao2_cleanup(config->templates);
 }
 
-static int jsoncompress_exec(struct ast_channel *chan, 
-	const char *cmd, char *parse, char *buffer, size_t buflen
-) {
-// return a json string by stripping the unneeded characters (smallest footprint)
+static void json_config_publish(struct json_config *config) {
+// makes config (the caller's reference to it) the current settings; NULL drops them
+	ao2_global_obj_replace_unref(json_config_holder, config);
+	ao2_cleanup(config);
+}
 
-	buffer[0] = 0;
+static const char *json_result_names[ASTJSON_RESULTS] = {
+	"OK", "UNDECIDED", "ARG_NEEDED", "PARSE_ERROR", "NOTFOUND", "INVALID_TYPE",
+	"ADD_FAILED", "SET_FAILED", "DELETE_FAILED", "LIMIT",
+};
 
-	// parse the function arguments
-	AST_DECLARE_APP_ARGS(args,
-		AST_APP_ARG(json);
-	);
-	if (ast_strlen_zero(parse)) {
-		ast_log(LOG_WARNING, "jsoncompress requires arguments (json)\n");
-		json_set_operation_result(chan, ASTJSON_ARG_NEEDED);
-		return 0;
-	}
-	AST_STANDARD_APP_ARGS(args, parse);
-	if (ast_strlen_zero(args.json)) {
-		ast_log(LOG_WARNING, "a valid asterisk variable name is required\n");
-		json_set_operation_result(chan, ASTJSON_ARG_NEEDED);
+// every function and app call is counted, along with its result code, the json text it parsed and
+//   generated and how long it took. the counters are only ever changed with atomic operations; the
+//   call in progress is tracked in thread storage, so the only lock on the way is the read lock
+//   taken to pin the settings
+#define JSON_STATS_BUCKETS     9
+
+enum json_stats_id {
+	JSON_STATS_JSONPRETTY,
+	JSON_STATS_JSONCOMPRESS,
+	JSON_STATS_JSONGET,
+	JSON_STATS_JSONVARIABLES,
+	JSON_STATS_JSONADD,
+	JSON_STATS_JSONSET,
+	JSON_STATS_JSONDELETE,
+	JSON_STATS_JSONEDIT,
+	JSON_STATS_JSONPATCH,
+	JSON_STATS_JSONMERGEPATCH,
+	JSON_STATS_JSON_OPEN,
+	JSON_STATS_JSON_CLOSE,
+	JSON_STATS_JSON_ITER,
+	JSON_STATS_JSON_NEXT,
+	JSON_STATS_JSON_FLUSH,
+	JSON_STATS_JSON_SHARED,
+	JSON_STATS_JSONFILE,
+	JSON_STATS_JSON_INDEX_CREATE,
+	JSON_STATS_JSON_LOOKUP,
+	JSON_STATS_JSON_LPM,
+	JSON_STATS_JSON_MEMBER,
+	JSON_STATS_JSON_TEMPLATE,
+	JSON_STATS_JSONVALID,
+	JSON_STATS_COUNT
+};
+
+struct json_stats {
+	const char *name;
+	unsigned int calls;
+	unsigned int results[ASTJSON_RESULTS];
+	uint64_t parsed;                      // bytes of json text read
+	uint64_t serialized;                  // bytes of json text generated
+	uint64_t usecs;
+	unsigned int latency[JSON_STATS_BUCKETS];
+};
+
+static struct json_stats json_stats[JSON_STATS_COUNT] = {
+	[JSON_STATS_JSONPRETTY] = { .name = "JSONPRETTY" },
+	[JSON_STATS_JSONCOMPRESS] = { .name = "JSONCOMPRESS" },
+	[JSON_STATS_JSONGET] = { .name = "JSONGET" },
+	[JSON_STATS_JSONVARIABLES] = { .name = "JsonVariables" },
+	[JSON_STATS_JSONADD] = { .name = "JsonAdd" },
+	[JSON_STATS_JSONSET] = { .name = "JsonSet" },
+	[JSON_STATS_JSONDELETE] = { .name = "JsonDelete" },
+	[JSON_STATS_JSONEDIT] = { .name = "JsonEdit" },
+	[JSON_STATS_JSONPATCH] = { .name = "JsonPatch" },
+	[JSON_STATS_JSONMERGEPATCH] = { .name = "JsonMergePatch" },
+	[JSON_STATS_JSON_OPEN] = { .name = "JSON_OPEN" },
+	[JSON_STATS_JSON_CLOSE] = { .name = "JSON_CLOSE" },
+	[JSON_STATS_JSON_ITER] = { .name = "JSON_ITER" },
+	[JSON_STATS_JSON_NEXT] = { .name = "JSON_NEXT" },
+	[JSON_STATS_JSON_FLUSH] = { .name = "JSON_FLUSH" },
+	[JSON_STATS_JSON_SHARED] = { .name = "JSON_SHARED" },
+	[JSON_STATS_JSONFILE] = { .name = "JSONFILE" },
+	[JSON_STATS_JSON_INDEX_CREATE] = { .name = "JSON_INDEX_CREATE" },
+	[JSON_STATS_JSON_LOOKUP] = { .name = "JSON_LOOKUP" },
+	[JSON_STATS_JSON_LPM] = { .name = "JSON_LPM" },
+	[JSON_STATS_JSON_MEMBER] = { .name = "JSON_MEMBER" },
+	[JSON_STATS_JSON_TEMPLATE] = { .name = "JSON_TEMPLATE" },
+	[JSON_STATS_JSONVALID] = { .name = "JSONVALID" },
+};
+
+// upper bounds (in microseconds) of the latency histogram buckets; the last one is open
+static const unsigned int json_stats_bounds[JSON_STATS_BUCKETS - 1] = {
+	10, 30, 100, 300, 1000, 3000, 10000, 30000
+};
+
+struct json_stats_call {
+	struct json_stats *stats;             // NULL when no call is in progress
+	struct json_config *config;           // the settings the call started with
+	int result;
+	int limited;                          // a document went over the limits: the call failed
+	size_t parsed;
+	size_t serialized;
+	struct timeval start;
+};
+
+AST_THREADSTORAGE(json_stats_call_buf);
+
+static struct json_stats_call *json_stats_begin(enum json_stats_id id) {
+	struct json_stats_call *call = ast_threadstorage_get(&json_stats_call_buf, sizeof(*call));
+	if (!call)
+		return NULL;
+	call->stats = &json_stats[id];
+	call->config = ao2_global_obj_ref(json_config_holder);
+	call->result = ASTJSON_UNDECIDED;
+	call->limited = 0;
+	call->parsed = call->serialized = 0;
+	call->start = ast_tvnow();
+	return call;
+}
+
+static void json_stats_end(struct json_stats_call *call) {
+	if (!call)
+		return;
+	struct json_stats *stats = call->stats;
+	int64_t usecs = MAX(ast_tvdiff_us(ast_tvnow(), call->start), 0);
+	int bucket = 0;
+	while ((bucket < JSON_STATS_BUCKETS - 1) && (usecs >= json_stats_bounds[bucket]))
+		bucket++;
+	ast_atomic_fetch_add(&stats->calls, 1, __ATOMIC_RELAXED);
+	if ((call->result >= 0) && (call->result < ASTJSON_RESULTS))
+		ast_atomic_fetch_add(&stats->results[call->result], 1, __ATOMIC_RELAXED);
+	if (call->parsed)
+		ast_atomic_fetch_add(&stats->parsed, call->parsed, __ATOMIC_RELAXED);
+	if (call->serialized)
+		ast_atomic_fetch_add(&stats->serialized, call->serialized, __ATOMIC_RELAXED);
+	ast_atomic_fetch_add(&stats->usecs, usecs, __ATOMIC_RELAXED);
+	ast_atomic_fetch_add(&stats->latency[bucket], 1, __ATOMIC_RELAXED);
+	ao2_cleanup(call->config);
+	call->config = NULL;
+	call->stats = NULL;
+}
+
+static struct json_stats_call *json_stats_current(void) {
+	struct json_stats_call *call = ast_threadstorage_get(&json_stats_call_buf, sizeof(*call));
+	return (call && call->stats) ? call : NULL;
+}
+
+static const struct json_config *json_config_current(void) {
+// the settings of the current call, read without any lock; the defaults outside of a call
+	struct json_stats_call *call = json_stats_current();
+	return (call && call->config) ? call->config : &json_config_defaults;
+}
+
+static void json_stats_reset(void) {
+	int i, j;
+	for (i = 0; i < JSON_STATS_COUNT; i++) {
+		struct json_stats *stats = &json_stats[i];
+		__atomic_store_n(&stats->calls, 0, __ATOMIC_RELAXED);
+		for (j = 0; j < ASTJSON_RESULTS; j++)
+			__atomic_store_n(&stats->results[j], 0, __ATOMIC_RELAXED);
+		__atomic_store_n(&stats->parsed, 0, __ATOMIC_RELAXED);
+		__atomic_store_n(&stats->serialized, 0, __ATOMIC_RELAXED);
+		__atomic_store_n(&stats->usecs, 0, __ATOMIC_RELAXED);
+		for (j = 0; j < JSON_STATS_BUCKETS; j++)
+			__atomic_store_n(&stats->latency[j], 0, __ATOMIC_RELAXED);
+	}
+}
+
+// numbers are formatted for the dialplan straight into a buffer of the caller, with no allocation:
+//   integers over the whole json_int_t range two digits at a time, reals in the shortest form that
+//   reads back as the same double ("1.5", not "1.500000"). integers and reals with up to 9
+//   decimals never go through printf; other reals still do, and strtod checks what it gives
+#define JSON_NUMBER_MAX        32        // room for any number in text form
+#define JSON_NUMBER_DECIMALS   9         // decimals of the reals formatted with integer arithmetic
+#define JSON_NUMBER_EXACT      9007199254740992.0    // 2^53, past which doubles skip integers
+
+static const char json_digit_pairs[] =
+	"0001020304050607080910111213141516171819202122232425262728293031323334353637383940414243444546474849"
+	"5051525354555657585960616263646566676869707172737475767778798081828384858687888990919293949596979899";
+
+static const double json_pow10[JSON_NUMBER_DECIMALS + 1] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9
+};
+
+static size_t json_format_int(intmax_t value, char *out) {
+// writes value into out (JSON_NUMBER_MAX bytes) and returns its length
+	char digits[JSON_NUMBER_MAX], *p = digits + sizeof(digits);
+	uintmax_t n = (value < 0) ? -(uintmax_t)value : (uintmax_t)value;
+	while (n >= 100) {
+		const char *pair = &json_digit_pairs[(n % 100) * 2];
+		n /= 100;
+		*--p = pair[1];
+		*--p = pair[0];
+	}
+	if (n >= 10) {
+		*--p = json_digit_pairs[n * 2 + 1];
+		*--p = json_digit_pairs[n * 2];
+	} else
+		*--p = '0' + n;
+	if (value < 0)
+		*--p = '-';
+	size_t len = digits + sizeof(digits) - p;
+	memcpy(out, p, len);
+	out[len] = 0;
+	return len;
+}
+
+static size_t json_format_real(double value, char *out) {
+// writes the shortest decimal form of value that reads back as the same double into out
+//   (JSON_NUMBER_MAX bytes) and returns its length. a value with up to 9 decimals is scaled to an
+//   integer and checked by dividing it back: both operands are exact, so the division rounds just
+//   like reading the text would, and the first scale that works has the fewest digits. other
+//   values fall back to snprintf "%.*g" with 15, 16 and then 17 significant digits, read back with
+//   strtod; the first that reads back is the shortest (subnormal values, with fewer bits of
+//   precision, may need less than 15)
+	int i, len = 0;
+	if (fabs(value) < JSON_NUMBER_EXACT) {
+		for (i = 0; i <= JSON_NUMBER_DECIMALS; i++) {
+			double scaled = round(fabs(value) * json_pow10[i]);
+			if (scaled >= JSON_NUMBER_EXACT)
+				break;
+			if (scaled / json_pow10[i] != fabs(value))
+				continue;
+			char digits[JSON_NUMBER_MAX], *p = out;
+			int n = json_format_int((intmax_t)scaled, digits);
+			if (value < 0)
+				*p++ = '-';
+			if (n <= i) {
+				*p++ = '0';
+				*p++ = '.';
+				memset(p, '0', i - n);
+				p += i - n;
+				memcpy(p, digits, n);
+				p += n;
+			} else {
+				memcpy(p, digits, n - i);
+				p += n - i;
+				if (i) {
+					*p++ = '.';
+					memcpy(p, digits + n - i, i);
+					p += i;
+				}
+			}
+			*p = 0;
+			return p - out;
+		}
+	}
+	for (i = (fabs(value) < DBL_MIN) ? 1 : 15; i <= 17; i++) {
+		len = snprintf(out, JSON_NUMBER_MAX, "%.*g", i, value);
+		if (strtod(out, NULL) == value)
+			break;
+	}
+	return len;
+}
+
+static void json_set_operation_result(struct ast_channel *chan, int result) {
+	// whatever a call made of a document that went over the limits, it is the limit it reports
+	char numresult[JSON_NUMBER_MAX];
+	struct json_stats_call *call = json_stats_current();
+	if (call && call->limited && (result != ASTJSON_UNDECIDED))
+		result = ASTJSON_LIMIT;
+	if (call)
+		call->result = result;
+	json_format_int(result, numresult);
+	pbx_builtin_setvar_helper(chan, "JSONRESULT", numresult);
+}
+
+static int json_parse_count(const char *text, size_t *value) {
+// reads a limit given as a number of bytes (or of levels, values); returns -1 if it is not one
+	unsigned long long number;
+	char extra;
+	text = ast_skip_blanks(text);
+	if (!isdigit((unsigned char)*text) || (sscanf(text, "%llu%c", &number, &extra) != 1))
+		return -1;
+	*value = number;
+	return 0;
+}
+
+static void json_limits_hit(const char *limit) {
+// makes the current call fail with ASTJSON_LIMIT
+	struct json_stats_call *call = json_stats_current();
+	if (call)
+		call->limited = 1;
+	ast_log(LOG_WARNING, "json %s limit reached\n", limit);
+}
+
+static int json_limits_output(struct ast_str **buf, size_t start) {
+// drops the text appended to buf after start if it is over the output limit; returns -1 then
+	size_t output = json_config_current()->limits.output;
+	if (!output || (ast_str_strlen(*buf) - start <= output))
+		return 0;
+	ast_str_truncate(*buf, start);
+	json_limits_hit("output");
+	return -1;
+}
+
+static int json_limits_check(const char *source, size_t len);
+static int json_limits_tree(struct ast_json *doc);
+
+static struct ast_json *json_load(const char *source, int vetted) {
+// parse json text, counting it in the statistics of the current call. text over the limits is
+//   not parsed at all; vetted text was already held to them by the scanner, as a whole
+	size_t len = strlen(source);
+	struct json_stats_call *call = json_stats_current();
+	if (call)
+		call->parsed += len;
+	if (vetted)
+		return ast_json_load_string(source, NULL);
+	int unsettled = json_limits_check(source, len);
+	if (unsettled < 0)
+		return NULL;
+	struct ast_json *doc = ast_json_load_string(source, NULL);
+	if (doc && unsettled && json_limits_tree(doc)) {
+		ast_json_unref(doc);
+		return NULL;
+	}
+	return doc;
+}
+
+static int json_dump_str(struct ast_json *doc, enum ast_json_encoding_format format,
+	struct ast_str **buf, ssize_t len
+) {
+// appends the json text of doc to buf, serializing straight into it, and counts it in the
+//   statistics of the current call. like the ast_str functions, a len above 0 caps the length of
+//   buf, a negative one caps it to the size buf had before
+	size_t start = ast_str_strlen(*buf), limit = (len < 0) ? ast_str_size(*buf) : (size_t)len;
+	int res = ast_json_dump_str_format(doc, buf, format);
+	if (limit && (ast_str_strlen(*buf) >= limit))
+		ast_str_truncate(*buf, limit - 1);
+	struct json_stats_call *call = json_stats_current();
+	if (call && (ast_str_strlen(*buf) > start))
+		call->serialized += ast_str_strlen(*buf) - start;
+	return json_limits_output(buf, start) ? -1 : res;
+}
+
+// json_dump serializes into a buffer of the thread, which keeps the size of the largest document
+//   it has seen: generating json text does not go through malloc once the buffer is big enough
+#define JSON_DUMP_BUF          1024
+
+AST_THREADSTORAGE(json_dump_buf);
+
+static const char *json_dump(struct ast_json *doc, enum ast_json_encoding_format format) {
+// generate json text, counting it in the statistics of the current call. the text is only good
+//   until the next json_dump on the same thread
+	struct ast_str *buf = ast_str_thread_get(&json_dump_buf, JSON_DUMP_BUF);
+	if (!buf)
+		return NULL;
+	ast_str_reset(buf);
+	if (json_dump_str(doc, format, &buf, 0))
+		return NULL;
+	return ast_str_buffer(buf);
+}
+
+// parsed documents are cached on the channel, one entry per doc variable, so that reading several
+//   elements out of the same document only parses it once. an entry is identified by the variable
+//   name plus a fingerprint (length and hash) of the string it was parsed from; when the variable
+//   changes the fingerprint no longer matches and the entry is dropped on the next lookup
+// with lazy write-back, the apps leave a changed document in the cache as a dirty entry instead of
+//   serializing it into the variable after every change. the fingerprint is then the one of the
+//   (old) text still in the variable: as long as nobody else sets the variable, the tree is the
+//   document. JSON_FLUSH writes dirty entries back, and so does evicting them - unless the variable
+//   was set in the meantime, in which case the outside write wins and the tree is dropped
+struct json_cache_entry {
+	AST_LIST_ENTRY(json_cache_entry) entry;
+	struct ast_json *doc;                 // never modified once it is in the cache, unless dirty
+	size_t len;
+	uint64_t hash;
+	int dirty;                            // the variable is not up to date with doc
+	char name[0];
+};
+
+struct json_cache {
+	int count;
+	AST_LIST_HEAD_NOLOCK(, json_cache_entry) entries;  // most recently used first
+};
+
+static void json_cache_entry_free(struct json_cache_entry *entry) {
+	ast_json_unref(entry->doc);
+	ast_free(entry);
+}
+
+static void json_cache_destroy(void *data) {
+	struct json_cache *cache = data;
+	struct json_cache_entry *entry;
+	while ((entry = AST_LIST_REMOVE_HEAD(&cache->entries, entry))) {
+		if (entry->dirty)
+			ast_log(LOG_WARNING, "json document %s had changes never flushed into the variable, "
+				"they are lost\n", entry->name);
+		json_cache_entry_free(entry);
+	}
+	ast_free(cache);
+	ast_module_unref(ast_module_info->self);
+}
+
+static const struct ast_datastore_info json_cache_info = {
+	.type = "JSONCACHE",
+	.destroy = json_cache_destroy,
+};
+
+static uint64_t json_fingerprint(const char *source, size_t len) {
+// 64-bit FNV-1a over the document text
+	uint64_t hash = 14695981039346656037ULL;
+	size_t i;
+	for (i = 0; i < len; i++) {
+		hash ^= (unsigned char)source[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+static struct json_cache *json_cache_find(struct ast_channel *chan, int create) {
+// returns the channel's document cache, creating it if asked to; call with the channel locked
+	struct ast_datastore *datastore = ast_channel_datastore_find(chan, &json_cache_info, NULL);
+	if (datastore)
+		return datastore->data;
+	if (!create)
+		return NULL;
+	struct json_cache *cache = ast_calloc(1, sizeof(*cache));
+	if (!cache)
+		return NULL;
+	if (!(datastore = ast_datastore_alloc(&json_cache_info, NULL))) {
+		ast_free(cache);
+		return NULL;
+	}
+	// the destroy callback is in this module, which must stay loaded until the channel drops it
+	ast_module_ref(ast_module_info->self);
+	datastore->data = cache;
+	ast_channel_datastore_add(chan, datastore);
+	return cache;
+}
+
+static void json_cache_keep(struct ast_channel *chan, struct json_cache_entry *entry) {
+// puts back a dirty entry that could not be written into its variable, as the least recently
+//   used one: its changes are only in the tree. it is lost if the variable has a newer entry
+	ast_channel_lock(chan);
+	struct json_cache *cache = json_cache_find(chan, 0);
+	struct json_cache_entry *other = NULL;
+	if (cache) {
+		AST_LIST_TRAVERSE(&cache->entries, other, entry)
+			if (!strcmp(other->name, entry->name))
+				break;
+		if (!other) {
+			AST_LIST_INSERT_TAIL(&cache->entries, entry, entry);
+			cache->count++;
+		}
+	}
+	ast_channel_unlock(chan);
+	if (cache && !other)
+		return;
+	ast_log(LOG_ERROR, "changes to json document %s are lost\n", entry->name);
+	json_cache_entry_free(entry);
+}
+
+static void json_cache_writeback(struct ast_channel *chan, struct json_cache_entry *entry);
+
+static void json_cache_store(struct ast_channel *chan, const char *varname, struct ast_json *doc,
+	size_t len, uint64_t hash, int dirty
+) {
+// remember doc as the parsed form of varname; the cache takes its own reference, so the caller
+//   must not modify doc afterwards (unless it is dirty). a NULL doc only records that the string
+//   was scanned once
+	if (!chan)
+		return;
+	struct json_cache_entry *entry = ast_calloc(1, sizeof(*entry) + strlen(varname) + 1);
+	if (!entry)
+		return;
+	strcpy(entry->name, varname);
+	entry->doc = doc ? ast_json_ref(doc) : NULL;
+	entry->len = len;
+	entry->hash = hash;
+	entry->dirty = dirty && doc;
+
+	ast_channel_lock(chan);
+	struct json_cache *cache = json_cache_find(chan, 1);
+	if (!cache) {
+		ast_channel_unlock(chan);
+		json_cache_writeback(chan, entry);
+		return;
+	}
+	struct json_cache_entry *old, *evicted[JSON_CACHE_MAX_DOCS];
+	int count = 0, i;
+	AST_LIST_TRAVERSE_SAFE_BEGIN(&cache->entries, old, entry) {
+		if (!strcmp(old->name, varname)) {
+			AST_LIST_REMOVE_CURRENT(entry);
+			json_cache_entry_free(old);
+			cache->count--;
+			break;
+		}
+	}
+	AST_LIST_TRAVERSE_SAFE_END;
+	// evict the least recently used documents; a reload may have made the cache smaller
+	while (cache->count && (cache->count >= json_config_current()->cache_docs)
+		&& (count < JSON_CACHE_MAX_DOCS)
+	) {
+		evicted[count] = AST_LIST_LAST(&cache->entries);
+		AST_LIST_REMOVE(&cache->entries, evicted[count], entry);
+		cache->count--;
+		count++;
+	}
+	AST_LIST_INSERT_HEAD(&cache->entries, entry, entry);
+	cache->count++;
+	ast_channel_unlock(chan);
+	for (i = 0; i < count; i++)
+		json_cache_writeback(chan, evicted[i]);
+}
+
+static struct ast_json *json_cache_lookup(struct ast_channel *chan, const char *varname,
+	size_t len, uint64_t hash, int *seen, int *dirty
+) {
+// returns a new reference to the cached tree for varname if it was parsed from the same string;
+//   a stale entry (the variable changed since) is dropped. if seen is given, it tells whether the
+//   same string was met before, even if it was only scanned and not parsed; dirty tells whether
+//   the tree has changes not written back to the variable yet
+	struct ast_json *doc = NULL;
+	if (seen)
+		*seen = 0;
+	if (dirty)
+		*dirty = 0;
+	if (!chan)
+		return NULL;
+	ast_channel_lock(chan);
+	struct json_cache *cache = json_cache_find(chan, 0);
+	if (cache) {
+		struct json_cache_entry *entry;
+		AST_LIST_TRAVERSE_SAFE_BEGIN(&cache->entries, entry, entry) {
+			if (strcmp(entry->name, varname))
+				continue;
+			AST_LIST_REMOVE_CURRENT(entry);
+			if ((entry->len == len) && (entry->hash == hash)) {
+				doc = entry->doc ? ast_json_ref(entry->doc) : NULL;
+				if (seen)
+					*seen = 1;
+				if (dirty)
+					*dirty = entry->dirty;
+				AST_LIST_INSERT_HEAD(&cache->entries, entry, entry);
+			} else {
+				if (entry->dirty)
+					ast_log(LOG_WARNING, "json document %s was set since it was changed, the changes "
+						"are dropped\n", entry->name);
+				json_cache_entry_free(entry);
+				cache->count--;
+			}
+			break;
+		}
+		AST_LIST_TRAVERSE_SAFE_END;
+	}
+	ast_channel_unlock(chan);
+	return doc;
+}
+
+// a document can also be opened with JSON_OPEN, which parses it once and keeps the tree in a
+//   channel datastore under a numbered handle. anywhere the functions and apps take the name of a
+//   doc variable they also take a "handle:<n>" reference, and then work straight on the live tree:
+//   nothing is parsed or serialized until JSON_CLOSE writes the document back. the tree is only
+//   ever touched from the channel's own dialplan thread, so it is not locked once looked up
+#define JSON_HANDLE_PREFIX     "handle:"
+#define JSON_HANDLE_MAX        32
+
+struct json_handle {
+	AST_LIST_ENTRY(json_handle) entry;
+	unsigned int id;
+	struct ast_json *doc;                 // NULL while the document is still empty
+};
+
+struct json_handles {
+	unsigned int last_id;
+	int count;
+	AST_LIST_HEAD_NOLOCK(, json_handle) entries;
+};
+
+static void json_handles_destroy(void *data) {
+	struct json_handles *handles = data;
+	struct json_handle *handle;
+	while ((handle = AST_LIST_REMOVE_HEAD(&handles->entries, entry))) {
+		ast_json_unref(handle->doc);
+		ast_free(handle);
+	}
+	ast_free(handles);
+	ast_module_unref(ast_module_info->self);
+}
+
+static const struct ast_datastore_info json_handles_info = {
+	.type = "JSONHANDLES",
+	.destroy = json_handles_destroy,
+};
+
+static unsigned int json_handle_id(const char *name) {
+// returns the handle number if name is a "handle:<n>" reference, or 0 for a variable name
+	size_t prefixlen = strlen(JSON_HANDLE_PREFIX);
+	if (strncasecmp(name, JSON_HANDLE_PREFIX, prefixlen) || !isdigit((unsigned char)name[prefixlen]))
+		return 0;
+	char *end;
+	unsigned long id = strtoul(name + prefixlen, &end, 10);
+	return (*end || (id > UINT_MAX)) ? 0 : id;
+}
+
+static struct json_handle *json_handle_find(struct ast_channel *chan, unsigned int id) {
+// call with the channel locked
+	struct ast_datastore *datastore = ast_channel_datastore_find(chan, &json_handles_info, NULL);
+	if (!datastore)
+		return NULL;
+	struct json_handles *handles = datastore->data;
+	struct json_handle *handle;
+	AST_LIST_TRAVERSE(&handles->entries, handle, entry)
+		if (handle->id == id)
+			return handle;
+	return NULL;
+}
+
+static int json_handle_get(struct ast_channel *chan, unsigned int id, struct ast_json **doc) {
+// gets a reference to the live tree of an open handle (NULL if the document is empty); returns
+//   -1 if the handle is not open
+	ast_channel_lock(chan);
+	struct json_handle *handle = json_handle_find(chan, id);
+	*doc = handle ? ast_json_ref(handle->doc) : NULL;
+	ast_channel_unlock(chan);
+	if (!handle)
+		ast_log(LOG_WARNING, "json handle %u is not open\n", id);
+	return handle ? 0 : -1;
+}
+
+static void json_handle_put(struct ast_channel *chan, unsigned int id, struct ast_json *doc) {
+// makes doc the live tree of an open handle
+	ast_channel_lock(chan);
+	struct json_handle *handle = json_handle_find(chan, id);
+	if (handle && (handle->doc != doc)) {
+		ast_json_unref(handle->doc);
+		handle->doc = ast_json_ref(doc);
+	}
+	ast_channel_unlock(chan);
+}
+
+static unsigned int json_handle_open(struct ast_channel *chan, struct ast_json *doc) {
+// opens a new handle on doc (which may be NULL), taking its own reference; returns 0 on failure
+	unsigned int id = 0;
+	ast_channel_lock(chan);
+	struct ast_datastore *datastore = ast_channel_datastore_find(chan, &json_handles_info, NULL);
+	if (!datastore) {
+		struct json_handles *handles = ast_calloc(1, sizeof(*handles));
+		if (handles && (datastore = ast_datastore_alloc(&json_handles_info, NULL))) {
+			ast_module_ref(ast_module_info->self);
+			datastore->data = handles;
+			ast_channel_datastore_add(chan, datastore);
+		} else
+			ast_free(handles);
+	}
+	struct json_handles *handles = datastore ? datastore->data : NULL;
+	struct json_handle *handle;
+	if (handles && (handles->count >= JSON_HANDLE_MAX))
+		ast_log(LOG_WARNING, "too many open json handles (%d), close some first\n", handles->count);
+	else if (handles && (handle = ast_calloc(1, sizeof(*handle)))) {
+		handle->id = id = ++handles->last_id;
+		handle->doc = ast_json_ref(doc);
+		AST_LIST_INSERT_HEAD(&handles->entries, handle, entry);
+		handles->count++;
+	}
+	ast_channel_unlock(chan);
+	return id;
+}
+
+static int json_handle_close(struct ast_channel *chan, unsigned int id, struct ast_json **doc) {
+// closes a handle, passing its tree (and the reference to it) on to the caller; returns -1 if the
+//   handle is not open
+	ast_channel_lock(chan);
+	struct ast_datastore *datastore = ast_channel_datastore_find(chan, &json_handles_info, NULL);
+	struct json_handles *handles = datastore ? datastore->data : NULL;
+	struct json_handle *handle = NULL;
+	if (handles) {
+		AST_LIST_TRAVERSE_SAFE_BEGIN(&handles->entries, handle, entry) {
+			if (handle->id == id) {
+				AST_LIST_REMOVE_CURRENT(entry);
+				handles->count--;
+				break;
+			}
+		}
+		AST_LIST_TRAVERSE_SAFE_END;
+	}
+	ast_channel_unlock(chan);
+	if (!handle) {
+		ast_log(LOG_WARNING, "json handle %u is not open\n", id);
+		return -1;
+	}
+	*doc = handle->doc;
+	ast_free(handle);
+	return 0;
+}
+
+// JSON_ITER opens a cursor over the elements of an array (or the members of an object) and keeps
+//   it in a channel datastore; every JSON_NEXT hands the next element to the dialplan. the
+//   container is looked up once and held on to, so each step costs the same however long the
+//   loop. a cursor goes away by itself once it runs past the last element; the oldest ones are
+//   dropped when a channel opens too many (loops left half way)
+#define JSON_ITER_PREFIX       "iter:"
+#define JSON_ITER_MAX          32
+
+struct json_iter {
+	AST_LIST_ENTRY(json_iter) entry;
+	unsigned int id;
+	struct ast_json *container;           // never modified while the cursor is open
+	struct ast_json_iter *member;         // the member last handed out, for objects
+	size_t index;                         // number of elements handed out so far
+	char fields[0];                       // '&' separated element fields to set as variables
+};
+
+struct json_iters {
+	unsigned int last_id;
+	int count;
+	AST_LIST_HEAD_NOLOCK(, json_iter) entries;  // newest first
+};
+
+static void json_iter_free(struct json_iter *iter) {
+	ast_json_unref(iter->container);
+	ast_free(iter);
+}
+
+static void json_iters_destroy(void *data) {
+	struct json_iters *iters = data;
+	struct json_iter *iter;
+	while ((iter = AST_LIST_REMOVE_HEAD(&iters->entries, entry)))
+		json_iter_free(iter);
+	ast_free(iters);
+	ast_module_unref(ast_module_info->self);
+}
+
+static const struct ast_datastore_info json_iters_info = {
+	.type = "JSONITERS",
+	.destroy = json_iters_destroy,
+};
+
+static unsigned int json_iter_id(const char *name) {
+// returns the cursor number of an "iter:<n>" reference, or 0
+	size_t prefixlen = strlen(JSON_ITER_PREFIX);
+	if (strncasecmp(name, JSON_ITER_PREFIX, prefixlen) || !isdigit((unsigned char)name[prefixlen]))
+		return 0;
+	char *end;
+	unsigned long id = strtoul(name + prefixlen, &end, 10);
+	return (*end || (id > UINT_MAX)) ? 0 : id;
+}
+
+static unsigned int json_iter_open(struct ast_channel *chan, struct ast_json *container,
+	const char *fields
+) {
+// opens a new cursor over container, taking its own reference; returns 0 on failure
+	struct json_iter *iter = ast_calloc(1, sizeof(*iter) + strlen(fields) + 1);
+	if (!iter)
+		return 0;
+	iter->container = ast_json_ref(container);
+	strcpy(iter->fields, fields);
+
+	struct json_iter *oldest = NULL;
+	ast_channel_lock(chan);
+	struct ast_datastore *datastore = ast_channel_datastore_find(chan, &json_iters_info, NULL);
+	if (!datastore) {
+		struct json_iters *iters = ast_calloc(1, sizeof(*iters));
+		if (iters && (datastore = ast_datastore_alloc(&json_iters_info, NULL))) {
+			ast_module_ref(ast_module_info->self);
+			datastore->data = iters;
+			ast_channel_datastore_add(chan, datastore);
+		} else
+			ast_free(iters);
+	}
+	struct json_iters *iters = datastore ? datastore->data : NULL;
+	if (iters) {
+		iter->id = ++iters->last_id;
+		AST_LIST_INSERT_HEAD(&iters->entries, iter, entry);
+		if (++iters->count > JSON_ITER_MAX) {
+			AST_LIST_TRAVERSE(&iters->entries, oldest, entry)
+				if (!AST_LIST_NEXT(oldest, entry))
+					break;
+			AST_LIST_REMOVE(&iters->entries, oldest, entry);
+			iters->count--;
+		}
+	}
+	ast_channel_unlock(chan);
+	if (oldest) {
+		ast_log(LOG_DEBUG, "too many json cursors open, dropping iter:%u\n", oldest->id);
+		json_iter_free(oldest);
+	}
+	if (!iters) {
+		json_iter_free(iter);
+		return 0;
+	}
+	return iter->id;
+}
+
+static struct json_iter *json_iter_find(struct ast_channel *chan, unsigned int id, int remove) {
+// looks a cursor up, taking it out of the datastore if asked to; call with the channel locked
+	struct ast_datastore *datastore = ast_channel_datastore_find(chan, &json_iters_info, NULL);
+	if (!datastore)
+		return NULL;
+	struct json_iters *iters = datastore->data;
+	struct json_iter *iter;
+	AST_LIST_TRAVERSE_SAFE_BEGIN(&iters->entries, iter, entry) {
+		if (iter->id == id) {
+			if (remove) {
+				AST_LIST_REMOVE_CURRENT(entry);
+				iters->count--;
+			}
+			return iter;
+		}
+	}
+	AST_LIST_TRAVERSE_SAFE_END;
+	return NULL;
+}
+
+// documents shared by all the channels: parsed once when they are published under a name, then
+//   read by JSON_SHARED without any parsing. a published entry is never changed; publishing the
+//   name again links a new entry in its place, in one step under the container lock. readers hold
+//   a reference to the entry they found, so they finish with the old tree while new lookups get
+//   the new one, and the last reader frees the old one
+#define JSON_SHARED_BUCKETS    53
+
+struct json_shared {
+	struct ast_json *doc;
+	size_t size;                          // bytes of json text it was parsed from
+	unsigned int version;                 // how many times the name has been published
+	int file;                             // loaded by JSONFILE, named after the file
+	struct timeval published;
+	char name[0];
+};
+
+static struct ao2_container *json_shared_docs;
+
+AO2_STRING_FIELD_HASH_FN(json_shared, name)
+AO2_STRING_FIELD_CMP_FN(json_shared, name)
+
+static void json_shared_destroy(void *obj) {
+	struct json_shared *shared = obj;
+	ast_json_unref(shared->doc);
+}
+
+static struct json_shared *json_shared_find(const char *name) {
+// returns a reference to the current version of a shared document, or NULL
+	return ao2_find(json_shared_docs, name, OBJ_SEARCH_KEY);
+}
+
+static void json_shared_changed(const char *name);
+
+static int json_shared_set(const char *name, struct ast_json *doc, size_t size, int file) {
+// makes doc (the caller's reference to it) the current version of a shared document. the tree is
+//   parsed before this is called, so lookups only ever wait for the swap itself
+	struct json_shared *shared = ao2_alloc_options(sizeof(*shared) + strlen(name) + 1,
+		json_shared_destroy, AO2_ALLOC_OPT_LOCK_NOLOCK);
+	if (!shared) {
+		ast_json_unref(doc);
+		return ASTJSON_UNDECIDED;
+	}
+	shared->doc = doc;
+	shared->size = size;
+	shared->file = file;
+	shared->published = ast_tvnow();
+	strcpy(shared->name, name);
+
+	ao2_wrlock(json_shared_docs);
+	struct json_shared *old = ao2_find(json_shared_docs, name, OBJ_SEARCH_KEY | OBJ_NOLOCK);
+	shared->version = old ? old->version + 1 : 1;
+	ao2_link_flags(json_shared_docs, shared, OBJ_NOLOCK);
+	ao2_unlock(json_shared_docs);
+	ao2_cleanup(old);
+	ao2_ref(shared, -1);
+	json_shared_changed(name);
+	return ASTJSON_OK;
+}
+
+static int json_shared_publish(const char *name, const char *source) {
+// parses source and makes it the current version of a shared document; an empty source removes
+//   the document
+	if (ast_strlen_zero(source)) {
+		ao2_find(json_shared_docs, name, OBJ_SEARCH_KEY | OBJ_UNLINK | OBJ_NODATA);
+		json_shared_changed(name);
+		return ASTJSON_OK;
+	}
+	struct ast_json *doc = json_load(source, 0);
+	if (!doc)
+		return ASTJSON_PARSE_ERROR;
+	return json_shared_set(name, doc, strlen(source), 0);
+}
+
+// json files: JSONFILE maps a file into memory, parses it straight from there and publishes it as
+//   a shared document named after the file. the directories of the files are watched with inotify:
+//   when a file is written or replaced, it is parsed again (by the watcher thread, not by a call)
+//   and swapped in like any shared document; if the new text does not parse, the old version stays.
+//   the number of files loaded is capped, and a file that could not be loaded is not tried again
+//   (nor logged again) for a while: the misses are kept apart, so that looking one up does not take
+//   json_file_lock
+#define JSON_FILE_MAX          256        // files loaded by JSONFILE at once
+#define JSON_FILE_RETRY        10         // seconds before a file that could not be loaded is tried again
+
+struct json_file_miss {
+	time_t when;
+	int ret;                              // why it could not be loaded
+	char name[0];
+};
+
+static struct ao2_container *json_file_misses;
+
+AO2_STRING_FIELD_HASH_FN(json_file_miss, name)
+AO2_STRING_FIELD_CMP_FN(json_file_miss, name)
+
+struct json_watch {
+	int wd;
+	AST_LIST_ENTRY(json_watch) list;
+	char dir[0];
+};
+
+AST_MUTEX_DEFINE_STATIC(json_file_lock);             // loading files, and the watch list
+static AST_LIST_HEAD_NOLOCK_STATIC(json_watches, json_watch);
+static int json_watch_fd = -1;
+static int json_watch_pipe[2] = { -1, -1 };         // tells the watcher thread to stop
+static pthread_t json_watch_thread = AST_PTHREADT_NULL;
+
+static int json_file_parse(const char *filename, struct ast_json **doc, size_t *size) {
+// parses a json file through a read-only mapping of it, with no copy of the text in between
+	*doc = NULL;
+	*size = 0;
+	int fd = open(filename, O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		ast_log(LOG_WARNING, "cannot open json file %s: %s\n", filename, strerror(errno));
+		return ASTJSON_NOTFOUND;
+	}
+	struct stat st;
+	if (fstat(fd, &st) || !S_ISREG(st.st_mode)) {
+		ast_log(LOG_WARNING, "%s is not a json file\n", filename);
+		close(fd);
+		return ASTJSON_NOTFOUND;
+	}
+	if (st.st_size > 0) {
+		void *text = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (text == MAP_FAILED) {
+			ast_log(LOG_WARNING, "cannot map json file %s: %s\n", filename, strerror(errno));
+			close(fd);
+			return ASTJSON_UNDECIDED;
+		}
+		madvise(text, st.st_size, MADV_SEQUENTIAL);
+		*size = st.st_size;
+		*doc = ast_json_load_buf(text, st.st_size, NULL);
+		munmap(text, st.st_size);
+	}
+	close(fd);
+	if (!*doc) {
+		ast_log(LOG_WARNING, "json file %s parsing error\n", filename);
+		return ASTJSON_PARSE_ERROR;
+	}
+	return ASTJSON_OK;
+}
+
+static void json_watch_add(const char *filename) {
+// starts watching the directory of a file, if it is not watched yet. called with json_file_lock
+#ifdef HAVE_INOTIFY
+	if (json_watch_fd < 0)
+		return;
+	const char *slash = strrchr(filename, '/');
+	size_t len = slash - filename;
+	struct json_watch *watch;
+	AST_LIST_TRAVERSE(&json_watches, watch, list)
+		if ((strlen(watch->dir) == len) && !strncmp(watch->dir, filename, len))
+			return;
+	if (!(watch = ast_calloc(1, sizeof(*watch) + len + 2)))
+		return;
+	memcpy(watch->dir, filename, len);
+	watch->wd = inotify_add_watch(json_watch_fd, len ? watch->dir : "/", IN_CLOSE_WRITE | IN_MOVED_TO);
+	if (watch->wd < 0) {
+		ast_log(LOG_WARNING, "cannot watch %s for changes: %s\n", watch->dir, strerror(errno));
+		ast_free(watch);
+		return;
+	}
+	AST_LIST_INSERT_HEAD(&json_watches, watch, list);
+#endif
+}
+
+static int json_file_count(void *obj, void *arg, int flags) {
+	struct json_shared *shared = obj;
+	if (shared->file)
+		(*(int *)arg)++;
+	return 0;
+}
+
+static int json_file_load(const char *filename) {
+// parses a file and publishes it; called with json_file_lock
+	struct ast_json *doc;
+	size_t size;
+	struct json_shared *shared = json_shared_find(filename);
+	if (!shared) {
+		int count = 0;
+		ao2_callback(json_shared_docs, OBJ_NODATA | OBJ_MULTIPLE, json_file_count, &count);
+		if (count >= JSON_FILE_MAX) {
+			json_limits_hit("files");
+			return ASTJSON_LIMIT;
+		}
+	}
+	ao2_cleanup(shared);
+	int ret = json_file_parse(filename, &doc, &size);
+	struct json_stats_call *call = json_stats_current();
+	if (call)
+		call->parsed += size;
+	if (ret != ASTJSON_OK)
+		return ret;
+	json_watch_add(filename);
+	return json_shared_set(filename, doc, size, 1);
+}
+
+static struct json_shared *json_file_get(const char *filename, int *ret) {
+// returns a reference to the shared document of a file, loading the file the first time
+	struct json_shared *shared = json_shared_find(filename);
+	*ret = ASTJSON_OK;
+	if (shared)
+		return shared;
+	time_t now = ast_tvnow().tv_sec;
+	struct json_file_miss *miss = ao2_find(json_file_misses, filename, OBJ_SEARCH_KEY);
+	if (miss && (now - miss->when < JSON_FILE_RETRY)) {
+		*ret = miss->ret;
+		ao2_ref(miss, -1);
+		return NULL;
+	}
+	ao2_cleanup(miss);
+	ast_mutex_lock(&json_file_lock);
+	if (!(shared = json_shared_find(filename)) && ((*ret = json_file_load(filename)) == ASTJSON_OK))
+		shared = json_shared_find(filename);
+	ast_mutex_unlock(&json_file_lock);
+	if (shared) {
+		ao2_find(json_file_misses, filename, OBJ_SEARCH_KEY | OBJ_UNLINK | OBJ_NODATA);
+		return shared;
+	}
+	if (*ret == ASTJSON_LIMIT)
+		return NULL;
+	// remember the miss; when there are too many of them, start over
+	if (ao2_container_count(json_file_misses) >= JSON_FILE_MAX)
+		ao2_callback(json_file_misses, OBJ_UNLINK | OBJ_NODATA | OBJ_MULTIPLE, NULL, NULL);
+	if ((miss = ao2_alloc_options(sizeof(*miss) + strlen(filename) + 1, NULL,
+		AO2_ALLOC_OPT_LOCK_NOLOCK))) {
+		miss->when = now;
+		miss->ret = *ret;
+		strcpy(miss->name, filename);
+		ao2_link(json_file_misses, miss);
+		ao2_ref(miss, -1);
+	}
+	return NULL;
+}
+
+static void json_file_name(const char *file, char *filename, size_t size) {
+// the name a file is shared under: its path, where a relative one is in the configuration directory
+	if (file[0] == '/')
+		ast_copy_string(filename, file, size);
+	else
+		snprintf(filename, size, "%s/%s", ast_config_AST_CONFIG_DIR, file);
+}
+
+static struct json_shared *json_shared_named(const char *name) {
+// returns a reference to a shared document named in the dialplan: published under that name, or
+//   read from that file with JSONFILE
+	struct json_shared *shared = json_shared_find(name);
+	if (shared || (name[0] == '/'))
+		return shared;
+	char filename[PATH_MAX];
+	json_file_name(name, filename, sizeof(filename));
+	return json_shared_find(filename);
+}
+
+#ifdef HAVE_INOTIFY
+static void json_watch_event(int wd, const char *name) {
+// a file changed in a watched directory: if it is one of ours, load it again
+	struct json_watch *watch;
+	ast_mutex_lock(&json_file_lock);
+	AST_LIST_TRAVERSE(&json_watches, watch, list)
+		if (watch->wd == wd)
+			break;
+	if (watch) {
+		char filename[PATH_MAX];
+		snprintf(filename, sizeof(filename), "%s/%s", watch->dir, name);
+		struct json_shared *shared = json_shared_find(filename);
+		if (shared && shared->file) {
+			ast_debug(1, "json file %s changed, loading it again\n", filename);
+			json_file_load(filename);
+		}
+		ao2_cleanup(shared);
+	}
+	ast_mutex_unlock(&json_file_lock);
+}
+
+static void *json_watch_run(void *data) {
+	char events[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+	struct pollfd fds[2] = {
+		{ .fd = json_watch_fd, .events = POLLIN },
+		{ .fd = json_watch_pipe[0], .events = POLLIN },
+	};
+	for (;;) {
+		if (poll(fds, 2, -1) < 0) {
+			if (errno == EINTR)
+				continue;
+			break;
+		}
+		if (fds[1].revents)
+			break;
+		ssize_t len = read(json_watch_fd, events, sizeof(events));
+		char *p;
+		for (p = events; (len > 0) && (p < events + len); ) {
+			const struct inotify_event *event = (const struct inotify_event *)p;
+			if (event->len)
+				json_watch_event(event->wd, event->name);
+			p += sizeof(*event) + event->len;
+		}
+	}
+	return NULL;
+}
+#endif
+
+static void json_watch_start(void) {
+// starts the thread that reloads changed files; without it the files are only read once
+#ifdef HAVE_INOTIFY
+	if ((json_watch_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC)) < 0) {
+		ast_log(LOG_WARNING, "cannot use inotify, json files will not be reloaded: %s\n",
+			strerror(errno));
+		return;
+	}
+	if (pipe(json_watch_pipe) ||
+		ast_pthread_create_background(&json_watch_thread, NULL, json_watch_run, NULL)) {
+		ast_log(LOG_WARNING, "cannot start the json file watcher, json files will not be reloaded\n");
+		json_watch_thread = AST_PTHREADT_NULL;
+		if (json_watch_pipe[0] >= 0) {
+			close(json_watch_pipe[0]);
+			close(json_watch_pipe[1]);
+			json_watch_pipe[0] = json_watch_pipe[1] = -1;
+		}
+		close(json_watch_fd);
+		json_watch_fd = -1;
+	}
+#endif
+}
+
+static void json_watch_stop(void) {
+	struct json_watch *watch;
+	if (json_watch_thread != AST_PTHREADT_NULL) {
+		while ((write(json_watch_pipe[1], "", 1) < 0) && (errno == EINTR))
+			;
+		pthread_join(json_watch_thread, NULL);
+		json_watch_thread = AST_PTHREADT_NULL;
+		close(json_watch_pipe[0]);
+		close(json_watch_pipe[1]);
+		json_watch_pipe[0] = json_watch_pipe[1] = -1;
+	}
+	if (json_watch_fd >= 0) {
+		close(json_watch_fd);
+		json_watch_fd = -1;
+	}
+	while ((watch = AST_LIST_REMOVE_HEAD(&json_watches, list)))
+		ast_free(watch);
+}
+
+static struct ast_json *json_doc_load(struct ast_channel *chan, const char *varname,
+	const char *source, size_t len, uint64_t hash, int vetted
+) {
+// returns the cached tree for the contents of varname, parsing (and caching) it if needed
+	struct ast_json *doc = json_cache_lookup(chan, varname, len, hash, NULL, NULL);
+	if (doc)
+		return doc;
+	doc = json_load(source, vetted);
+	if (doc)
+		json_cache_store(chan, varname, doc, len, hash, 0);
+	return doc;
+}
+
+static struct ast_json *json_doc_get(struct ast_channel *chan, const char *varname) {
+// returns a reference to the parsed contents of a doc variable (or the tree of a handle), or NULL
+//   if it cannot be parsed. the tree may be shared with the channel cache: it is strictly
+//   read-only for the caller
+	unsigned int id = json_handle_id(varname);
+	if (id) {
+		struct ast_json *doc;
+		json_handle_get(chan, id, &doc);
+		return doc;
+	}
+	const char *source = S_OR(pbx_builtin_getvar_helper(chan, varname), "");
+	size_t len = strlen(source);
+	return json_doc_load(chan, varname, source, len, json_fingerprint(source, len), 0);
+}
+
+static void json_doc_update(struct ast_channel *chan, const char *varname, struct ast_json *doc,
+	const char *jsonresult
+) {
+// write the serialized form of a modified document back into its variable; the tree goes into
+//   the cache, so the next read of the variable does not need to parse it again
+	size_t len = strlen(jsonresult);
+	pbx_builtin_setvar_helper(chan, varname, jsonresult);
+	json_cache_store(chan, varname, doc, len, json_fingerprint(jsonresult, len), 0);
+}
+
+static int json_doc_edit(struct ast_channel *chan, const char *name, struct ast_json **doc,
+	int *live
+) {
+// gets a document for an app to modify: the live tree of a handle or, with lazy write-back, the
+//   dirty tree of a variable; otherwise a tree of its own parsed from the variable. *live tells
+//   which: changing a live tree changes the document right away. *doc is NULL when the document
+//   is (still) empty. returns ASTJSON_OK, or ASTJSON_PARSE_ERROR if there is no document to be had
+	*doc = NULL;
+	*live = 0;
+	unsigned int id = json_handle_id(name);
+	if (id) {
+		*live = 1;
+		return json_handle_get(chan, id, doc) ? ASTJSON_PARSE_ERROR : ASTJSON_OK;
+	}
+	const char *source = S_OR(pbx_builtin_getvar_helper(chan, name), "");
+	if (json_config_current()->writeback_lazy) {
+		size_t len = strlen(source);
+		int dirty;
+		*doc = json_cache_lookup(chan, name, len, json_fingerprint(source, len), NULL, &dirty);
+		if (*doc && dirty) {
+			*live = 1;
+			return ASTJSON_OK;
+		}
+		ast_json_unref(*doc);
+		*doc = NULL;
+	}
+	if (ast_strlen_zero(source))
+		return ASTJSON_OK;
+	*doc = json_load(source, 0);
+	return *doc ? ASTJSON_OK : ASTJSON_PARSE_ERROR;
+}
+
+static void json_doc_save(struct ast_channel *chan, const char *name, struct ast_json *doc) {
+// keeps the changes an app made to a document: a handle simply holds on to the tree, a variable
+//   gets it serialized back into it - or, with lazy write-back, cached as a dirty tree
+	unsigned int id = json_handle_id(name);
+	if (id) {
+		json_handle_put(chan, id, doc);
+		return;
+	}
+	if (json_config_current()->writeback_lazy) {
+		const char *source = S_OR(pbx_builtin_getvar_helper(chan, name), "");
+		size_t len = strlen(source);
+		json_cache_store(chan, name, doc, len, json_fingerprint(source, len), 1);
+		return;
+	}
+	const char *jsonresult = json_dump(doc, 0);
+	if (!jsonresult)
+		return;
+	ast_log(LOG_DEBUG, "resulting json: %s\n", jsonresult);
+	json_doc_update(chan, name, doc, jsonresult);
+}
+
+static int json_cache_outdated(struct ast_channel *chan, struct json_cache_entry *entry) {
+// tells whether the variable of a dirty entry was set by something else since the entry was
+//   cached, by comparing its text with the fingerprint; the changes in the tree are then dropped
+	const char *source = S_OR(pbx_builtin_getvar_helper(chan, entry->name), "");
+	size_t len = strlen(source);
+	if ((len == entry->len) && (json_fingerprint(source, len) == entry->hash))
+		return 0;
+	ast_log(LOG_WARNING, "json document %s was set since it was changed, the changes are dropped\n",
+		entry->name);
+	return -1;
+}
+
+static void json_cache_writeback(struct ast_channel *chan, struct json_cache_entry *entry) {
+// frees an entry that left the cache, writing its document into the variable first if it is dirty
+//   (and the variable was not set in the meantime). a dirty document that cannot be serialized
+//   (over the output limit) goes back into the cache
+	if (entry->dirty && !json_cache_outdated(chan, entry)) {
+		const char *jsonresult = json_dump(entry->doc, 0);
+		if (!jsonresult) {
+			ast_log(LOG_ERROR, "cannot write json document %s back into its variable\n", entry->name);
+			json_cache_keep(chan, entry);
+			return;
+		}
+		pbx_builtin_setvar_helper(chan, entry->name, jsonresult);
+	}
+	json_cache_entry_free(entry);
+}
+
+static int json_cache_flush(struct ast_channel *chan, const char *varname) {
+// writes the dirty documents of the channel back into their variables, or only the one of
+//   varname if given; they stay in the cache as clean entries. a document whose variable was set
+//   in the meantime is dropped instead. returns -1 if one of them could not be written, and is
+//   still dirty
+	struct json_cache_entry *flushed[JSON_CACHE_MAX_DOCS];
+	int count = 0, i, res = 0;
+	ast_channel_lock(chan);
+	struct json_cache *cache = json_cache_find(chan, 0);
+	if (cache) {
+		struct json_cache_entry *entry;
+		AST_LIST_TRAVERSE_SAFE_BEGIN(&cache->entries, entry, entry) {
+			if (!entry->dirty || (varname && strcmp(entry->name, varname)))
+				continue;
+			AST_LIST_REMOVE_CURRENT(entry);
+			cache->count--;
+			flushed[count++] = entry;
+			if (count == JSON_CACHE_MAX_DOCS)
+				break;
+		}
+		AST_LIST_TRAVERSE_SAFE_END;
+	}
+	ast_channel_unlock(chan);
+	for (i = 0; i < count; i++) {
+		if (json_cache_outdated(chan, flushed[i])) {
+			json_cache_entry_free(flushed[i]);
+			continue;
+		}
+		const char *jsonresult = json_dump(flushed[i]->doc, 0);
+		if (!jsonresult) {
+			ast_log(LOG_ERROR, "cannot write json document %s back into its variable\n",
+				flushed[i]->name);
+			json_cache_keep(chan, flushed[i]);
+			res = -1;
+			continue;
+		}
+		json_doc_update(chan, flushed[i]->name, flushed[i]->doc, jsonresult);
+		json_cache_entry_free(flushed[i]);
+	}
+	return res;
+}
+
+// path strings (like "/path/to/element/3") are compiled once into a list of segments and kept in a
+//   module-wide cache shared by all the functions and apps that walk a path. the cache is bounded;
+//   the least recently used paths are evicted first
+#define JSON_PATH_CACHE_BUCKETS  256
+
+struct json_path_segment {
+	const char *key;                      // member name, when looking into an object
+	int index;                            // element index, when looking into an array
+	int is_index;
+};
+
+struct json_path {
+	AST_LIST_ENTRY(json_path) chain;      // hash bucket
+	AST_DLLIST_ENTRY(json_path) lru;
+	unsigned int hash;
+	int count;                            // number of segments; 0 addresses the document root
+	const char *source;
+	struct json_path_segment segments[0];
+};
+
+AST_MUTEX_DEFINE_STATIC(path_cache_lock);
+static AST_LIST_HEAD_NOLOCK(, json_path) path_cache[JSON_PATH_CACHE_BUCKETS];
+static AST_DLLIST_HEAD_NOLOCK_STATIC(path_cache_lru, json_path);
+static int path_cache_count;
+static unsigned int path_cache_hits;
+static unsigned int path_cache_misses;
+
+static struct json_path *json_path_compile(const char *source, unsigned int hash) {
+// a heading and a trailing slash are ignored and the rest is split at the slashes; a piece that
+//   starts with a number is an index into an array, anything else is the name of an object member
+	const char *start = source + ((source[0] == '/') ? 1 : 0);
+	size_t len = strlen(start);
+	if (len && (start[len - 1] == '/'))
+		len--;
+	int count = 0;
+	if (len) {
+		size_t i;
+		for (count = 1, i = 0; i < len; i++)
+			if (start[i] == '/')
+				count++;
+	}
+	struct json_path *path = ao2_alloc_options(sizeof(*path) + count * sizeof(path->segments[0]) +
+		strlen(source) + 1 + len + 1, NULL, AO2_ALLOC_OPT_LOCK_NOLOCK);
+	if (!path)
+		return NULL;
+	char *storage = (char *)&path->segments[count];
+	strcpy(storage, source);
+	path->source = storage;
+	storage += strlen(source) + 1;
+	memcpy(storage, start, len);
+	storage[len] = 0;
+	path->hash = hash;
+	path->count = count;
+
+	char *pathpiece;
+	int i = 0;
+	while (len && (pathpiece = strsep(&storage, "/"))) {
+		path->segments[i].key = pathpiece;
+		path->segments[i].is_index = (sscanf(pathpiece, "%3d", &path->segments[i].index) == 1);
+		i++;
+	}
+	return path;
+}
+
+static struct json_path *json_path_lookup(const char *source, unsigned int hash) {
+// call with path_cache_lock held
+	struct json_path *path;
+	AST_LIST_TRAVERSE(&path_cache[hash % JSON_PATH_CACHE_BUCKETS], path, chain) {
+		if ((path->hash == hash) && !strcmp(path->source, source))
+			break;
+	}
+	return path;
+}
+
+static struct json_path *json_path_get(const char *source) {
+// returns a reference to the compiled form of a path string, compiling and caching it if needed
+	unsigned int hash = ast_str_hash(source);
+	struct json_path *path;
+
+	ast_mutex_lock(&path_cache_lock);
+	if ((path = json_path_lookup(source, hash))) {
+		path_cache_hits++;
+		AST_DLLIST_REMOVE(&path_cache_lru, path, lru);
+		AST_DLLIST_INSERT_HEAD(&path_cache_lru, path, lru);
+		ao2_ref(path, +1);
+		ast_mutex_unlock(&path_cache_lock);
+		return path;
+	}
+	path_cache_misses++;
+	ast_mutex_unlock(&path_cache_lock);
+
+	struct json_path *compiled = json_path_compile(source, hash);
+	if (!compiled)
+		return NULL;
+
+	ast_mutex_lock(&path_cache_lock);
+	if ((path = json_path_lookup(source, hash))) {
+		// somebody compiled the same path in the meantime
+		ao2_ref(path, +1);
+		ast_mutex_unlock(&path_cache_lock);
+		ao2_ref(compiled, -1);
+		return path;
+	}
+	ao2_ref(compiled, +1);
+	AST_LIST_INSERT_HEAD(&path_cache[hash % JSON_PATH_CACHE_BUCKETS], compiled, chain);
+	AST_DLLIST_INSERT_HEAD(&path_cache_lru, compiled, lru);
+	path_cache_count++;
+	// a reload may have made the cache smaller
+	while (path_cache_count > json_config_current()->path_cache) {
+		path = AST_DLLIST_LAST(&path_cache_lru);
+		AST_DLLIST_REMOVE(&path_cache_lru, path, lru);
+		AST_LIST_REMOVE(&path_cache[path->hash % JSON_PATH_CACHE_BUCKETS], path, chain);
+		path_cache_count--;
+		ao2_ref(path, -1);
+	}
+	ast_mutex_unlock(&path_cache_lock);
+	return compiled;
+}
+
+static void json_path_cache_flush(void) {
+	struct json_path *path;
+	ast_mutex_lock(&path_cache_lock);
+	while ((path = AST_DLLIST_REMOVE_HEAD(&path_cache_lru, lru))) {
+		AST_LIST_REMOVE(&path_cache[path->hash % JSON_PATH_CACHE_BUCKETS], path, chain);
+		ao2_ref(path, -1);
+	}
+	path_cache_count = 0;
+	ast_mutex_unlock(&path_cache_lock);
+}
+
+static struct ast_json *json_path_step(struct ast_json *node, const struct json_path_segment *segment) {
+	if (segment->is_index)
+		return ast_json_array_get(node, segment->index);
+	return ast_json_object_get(node, segment->key);
+}
+
+static struct ast_json *json_path_walk(struct ast_json *doc, const struct json_path *path, int count) {
+// follows the first count segments of a path down from doc; returns NULL if one of them is missing
+	int i;
+	for (i = 0; doc && (i < count); i++)
+		doc = json_path_step(doc, &path->segments[i]);
+	return doc;
+}
+
+// when JSONGET is given several paths, they are merged into a trie so that the segments they have
+//   in common (like "/data/user" in "/data/user/id,/data/user/name") are looked up only once
+struct json_path_trie_node {
+	const struct json_path_segment *segment;
+	struct ast_json *value;               // what the path up to this node points to, or NULL
+	struct json_path_trie_node *child;
+	struct json_path_trie_node *sibling;
+};
+
+static int json_path_segment_equal(const struct json_path_segment *a, const struct json_path_segment *b) {
+	if (a->is_index || b->is_index)
+		return a->is_index && b->is_index && (a->index == b->index);
+	return !strcmp(a->key, b->key);
+}
+
+static void json_path_resolve_all(struct ast_json *doc, struct json_path **paths, int count,
+	struct ast_json **values
+) {
+// finds the element each of the paths points to, in a single descent from the root; values[i] is
+//   NULL if paths[i] is missing (or could not be compiled). the values are borrowed from doc
+	int i, j, segments = 0;
+	for (i = 0; i < count; i++)
+		segments += paths[i] ? paths[i]->count : 0;
+	struct json_path_trie_node *nodes = ast_calloc(segments + 1, sizeof(*nodes));
+	if (!nodes) {
+		// fall back to walking the paths one by one
+		for (i = 0; i < count; i++)
+			values[i] = paths[i] ? json_path_walk(doc, paths[i], paths[i]->count) : NULL;
+		return;
+	}
+	struct json_path_trie_node *root = &nodes[0], *next = &nodes[1];
+	root->value = doc;
+	for (i = 0; i < count; i++) {
+		struct json_path_trie_node *node = root;
+		if (!paths[i]) {
+			values[i] = NULL;
+			continue;
+		}
+		for (j = 0; j < paths[i]->count; j++) {
+			const struct json_path_segment *segment = &paths[i]->segments[j];
+			struct json_path_trie_node *child;
+			for (child = node->child; child; child = child->sibling) {
+				if (json_path_segment_equal(child->segment, segment))
+					break;
+			}
+			if (!child) {
+				// first path going this way, resolve the new segment
+				child = next++;
+				child->segment = segment;
+				child->value = node->value ? json_path_step(node->value, segment) : NULL;
+				child->sibling = node->child;
+				node->child = child;
+			}
+			node = child;
+		}
+		values[i] = node->value;
+	}
+	ast_free(nodes);
+}
+
+// indexes over the arrays of shared documents: JSON_INDEX_CREATE hashes every element of an array
+//   of objects by the value of one of its fields, so that JSON_LOOKUP finds an element by that
+//   value in one probe instead of a dialplan loop over the array. an index has a name of its own
+//   (the document name unless given one), so a document can have several, by different fields or
+//   over different arrays. it belongs to its shared document and is just as immutable: when a new
+//   version of the document is published, a new index is built over it by the publisher and
+//   swapped in after it; until then lookups go on with the old index, which holds on to the
+//   document version it was built over
+#define JSON_INDEX_INTKEY      24        // room for an integer key in text form
+
+struct json_index_slot {
+	uint64_t hash;
+	const char *key;                      // NULL for an empty slot
+	struct ast_json *element;
+};
+
+struct json_index {
+	struct json_shared *shared;           // the document version indexed
+	const char *doc;                      // the name of the document
+	const char *arraypath;
+	const char *keyfield;
+	size_t mask;                          // number of slots - 1, a power of two minus one
+	struct json_index_slot *slots;
+	char *intkeys;                        // text form of the integer keys
+	unsigned int count;                   // elements indexed
+	unsigned int duplicates;              // elements left out because their key was taken
+	unsigned int skipped;                 // elements left out for a missing or non-scalar key
+	int64_t usecs;                        // how long the build took
+	char name[0];
+};
+
+static struct ao2_container *json_indexes;
+
+AST_MUTEX_DEFINE_STATIC(json_index_lock);            // one build at a time, so the last one wins
+
+AO2_STRING_FIELD_HASH_FN(json_index, name)
+AO2_STRING_FIELD_CMP_FN(json_index, name)
+
+static void json_index_destroy(void *obj) {
+	struct json_index *index = obj;
+	ast_free(index->slots);
+	ast_free(index->intkeys);
+	ao2_cleanup(index->shared);
+}
+
+static int json_index_build(const char *name, struct json_shared *shared, const char *arraypath,
+	const char *keyfield
+) {
+// builds an index over a version of a shared document (the caller's reference to it) and swaps it
+//   in place of the previous one of that name; returns a JSONRESULT code
+	struct timeval start = ast_tvnow();
+	struct json_path *path = json_path_get(arraypath);
+	struct json_path *key = json_path_get(keyfield);
+	struct ast_json *array = path ? json_path_walk(shared->doc, path, path->count) : NULL;
+	ao2_cleanup(path);
+	if (!array || !key) {
+		ao2_cleanup(key);
+		ao2_ref(shared, -1);
+		return ASTJSON_NOTFOUND;
+	}
+	if (ast_json_typeof(array) != AST_JSON_ARRAY) {
+		ao2_ref(key, -1);
+		ao2_ref(shared, -1);
+		return ASTJSON_INVALID_TYPE;
+	}
+
+	// keep at most half of the slots busy
+	size_t n = ast_json_array_size(array), slots = 2, i;
+	while (slots < 2 * n)
+		slots <<= 1;
+	struct json_index *index = ao2_alloc_options(sizeof(*index) + strlen(name) + 1 +
+		strlen(shared->name) + 1 + strlen(arraypath) + 1 + strlen(keyfield) + 1,
+		json_index_destroy, AO2_ALLOC_OPT_LOCK_NOLOCK);
+	if (!index || !(index->slots = ast_calloc(slots, sizeof(*index->slots)))) {
+		ao2_cleanup(index);
+		ao2_ref(key, -1);
+		ao2_ref(shared, -1);
+		return ASTJSON_UNDECIDED;
+	}
+	index->shared = shared;
+	index->mask = slots - 1;
+	strcpy(index->name, name);
+	index->doc = strcpy(index->name + strlen(name) + 1, shared->name);
+	index->arraypath = strcpy((char *)index->doc + strlen(shared->name) + 1, arraypath);
+	index->keyfield = strcpy((char *)index->arraypath + strlen(arraypath) + 1, keyfield);
+
+	char *intkey = NULL;
+	for (i = 0; i < n; i++) {
+		struct ast_json *element = ast_json_array_get(array, i);
+		struct ast_json *value = json_path_walk(element, key, key->count);
+		const char *text;
+		if (value && (ast_json_typeof(value) == AST_JSON_STRING))
+			text = ast_json_string_get(value);
+		else if (value && (ast_json_typeof(value) == AST_JSON_INTEGER)) {
+			if (!index->intkeys && !(intkey = index->intkeys = ast_malloc(n * JSON_INDEX_INTKEY)))
+				break;
+			snprintf(intkey, JSON_INDEX_INTKEY, "%jd", ast_json_integer_get(value));
+			text = intkey;
+			intkey += JSON_INDEX_INTKEY;
+		} else {
+			index->skipped++;
+			continue;
+		}
+		uint64_t hash = json_fingerprint(text, strlen(text));
+		struct json_index_slot *slot;
+		for (slot = &index->slots[hash & index->mask]; slot->key;
+				slot = &index->slots[(slot - index->slots + 1) & index->mask])
+			if ((slot->hash == hash) && !strcmp(slot->key, text))
+				break;
+		if (slot->key) {
+			// like a loop over the array would, the first element with a key wins
+			index->duplicates++;
+			continue;
+		}
+		slot->hash = hash;
+		slot->key = text;
+		slot->element = element;
+		index->count++;
+	}
+	ao2_ref(key, -1);
+	if (i < n) {
+		ao2_ref(index, -1);
+		return ASTJSON_UNDECIDED;
+	}
+	index->usecs = ast_tvdiff_us(ast_tvnow(), start);
+	ao2_link(json_indexes, index);
+	ao2_ref(index, -1);
+	return ASTJSON_OK;
+}
+
+static int json_index_create(const char *name, const char *doc, const char *arraypath,
+	const char *keyfield
+) {
+// builds the index name over the current version of the shared document doc (a name given in the
+//   dialplan, resolved like JSONFILE does for a file)
+	struct json_shared *shared = json_shared_named(doc);
+	if (!shared)
+		return ASTJSON_NOTFOUND;
+	ast_mutex_lock(&json_index_lock);
+	int ret = json_index_build(name, shared, arraypath, keyfield);
+	ast_mutex_unlock(&json_index_lock);
+	return ret;
+}
+
+struct json_index_stale {
+	const char *doc;
+	struct json_shared *shared;           // the current version of the document, or NULL
+};
+
+static int json_index_stale_cb(void *obj, void *arg, int flags) {
+	struct json_index *index = obj;
+	struct json_index_stale *stale = arg;
+	return ((index->shared != stale->shared) && !strcmp(index->doc, stale->doc)) ?
+		CMP_MATCH | CMP_STOP : 0;
+}
+
+static void json_index_refresh(const char *name) {
+// a new version of a shared document was published (or the document was removed): rebuild its
+//   indexes over whatever version is current now
+	struct json_index_stale stale = { .doc = name };
+	struct json_index *index;
+	ast_mutex_lock(&json_index_lock);
+	stale.shared = json_shared_find(name);
+	while ((index = ao2_callback(json_indexes, 0, json_index_stale_cb, &stale))) {
+		if (!stale.shared)
+			ao2_unlink(json_indexes, index);
+		else if (json_index_build(index->name, ao2_bump(stale.shared), index->arraypath,
+			index->keyfield) != ASTJSON_OK) {
+			ast_log(LOG_WARNING, "cannot index the new version of %s by %s, dropping index %s\n",
+				name, index->keyfield, index->name);
+			ao2_unlink(json_indexes, index);
+		}
+		ao2_ref(index, -1);
+	}
+	ao2_cleanup(stale.shared);
+	ast_mutex_unlock(&json_index_lock);
+}
+
+static struct ast_json *json_index_lookup(struct json_index *index, const char *key) {
+// returns the element indexed under key (not a reference: it lives as long as the index), or NULL
+	uint64_t hash = json_fingerprint(key, strlen(key));
+	struct json_index_slot *slot;
+	for (slot = &index->slots[hash & index->mask]; slot->key;
+			slot = &index->slots[(slot - index->slots + 1) & index->mask])
+		if ((slot->hash == hash) && !strcmp(slot->key, key))
+			return slot->element;
+	return NULL;
+}
+
+// tries and sets are compiled from a table - an object or an array - in a shared document, named
+//   by the document name followed by the path to the table inside it. they start with the same
+//   header, and are looked up, compiled the first time they are used and compiled again when a new
+//   version of their document is published in the same way
+struct json_compiled {
+	struct json_shared *shared;           // the document version it was compiled from
+	size_t namelen;                       // the document name is the start of the table name
+	const char *table;
+};
+
+typedef int (*json_compile_fn)(const char *table, struct json_shared *shared, size_t namelen);
+
+static struct json_shared *json_compiled_source(const char *table, size_t *namelen) {
+// finds the shared document a table is in: the longest start of the table name, up to a slash,
+//   that is the name of a shared document. the rest is the path to the table inside it
+	char *name = ast_strdupa(table);
+	size_t len = strlen(name);
+	while (len) {
+		name[len] = 0;
+		struct json_shared *shared = json_shared_find(name);
+		if (shared) {
+			*namelen = len;
+			return shared;
+		}
+		while (len && (name[len - 1] != '/'))
+			len--;
+		if (len)
+			len--;
+	}
+	return NULL;
+}
+
+static int json_compiled_table(const char *table, struct json_shared *shared, size_t namelen,
+	struct ast_json **source
+) {
+// finds the table in its document; it has to be an object or an array
+	struct json_path *path = json_path_get(table + namelen + (table[namelen] == '/'));
+	*source = path ? json_path_walk(shared->doc, path, path->count) : NULL;
+	ao2_cleanup(path);
+	if (!*source)
+		return ASTJSON_NOTFOUND;
+	enum ast_json_type type = ast_json_typeof(*source);
+	return ((type == AST_JSON_OBJECT) || (type == AST_JSON_ARRAY)) ? ASTJSON_OK : ASTJSON_INVALID_TYPE;
+}
+
+static void *json_compiled_get(struct ao2_container *container, ast_mutex_t *lock,
+	json_compile_fn compile, const char *table, int *ret
+) {
+// returns a reference to what was compiled from a table, compiling it the first time
+	void *compiled = ao2_find(container, table, OBJ_SEARCH_KEY);
+	*ret = ASTJSON_OK;
+	if (compiled)
+		return compiled;
+	ast_mutex_lock(lock);
+	if (!(compiled = ao2_find(container, table, OBJ_SEARCH_KEY))) {
+		size_t namelen;
+		struct json_shared *shared = json_compiled_source(table, &namelen);
+		if (!shared)
+			*ret = ASTJSON_NOTFOUND;
+		else if ((*ret = compile(table, shared, namelen)) == ASTJSON_OK)
+			compiled = ao2_find(container, table, OBJ_SEARCH_KEY);
+	}
+	ast_mutex_unlock(lock);
+	return compiled;
+}
+
+struct json_compiled_stale {
+	const char *name;
+	struct json_shared *shared;           // the current version of the document, or NULL
+};
+
+static int json_compiled_stale_cb(void *obj, void *arg, int flags) {
+	struct json_compiled *compiled = obj;
+	struct json_compiled_stale *stale = arg;
+	return ((compiled->shared != stale->shared) &&
+		!strncmp(compiled->table, stale->name, compiled->namelen) &&
+		!stale->name[compiled->namelen]) ? CMP_MATCH | CMP_STOP : 0;
+}
+
+static void json_compiled_refresh(struct ao2_container *container, ast_mutex_t *lock,
+	json_compile_fn compile, const char *name, const char *what
+) {
+// a new version of a shared document was published (or the document was removed): compile its
+//   tables again from whatever version is current now, dropping the ones that cannot be
+	struct json_compiled_stale stale = { .name = name };
+	struct json_compiled *compiled;
+	ast_mutex_lock(lock);
+	stale.shared = json_shared_find(name);
+	while ((compiled = ao2_callback(container, 0, json_compiled_stale_cb, &stale))) {
+		if (!stale.shared ||
+			(compile(compiled->table, ao2_bump(stale.shared), compiled->namelen) != ASTJSON_OK)) {
+			if (stale.shared)
+				ast_log(LOG_WARNING, "cannot build the %s %s from the new version of %s, "
+					"dropping it\n", what, compiled->table, name);
+			ao2_unlink(container, compiled);
+		}
+		ao2_ref(compiled, -1);
+	}
+	ao2_cleanup(stale.shared);
+	ast_mutex_unlock(lock);
+}
+
+// longest prefix match tables, for routing and rating: JSON_LPM compiles a table of prefixes - an
+//   object like {"1555":"trunkA","1":"trunkB"}, or an array of objects with a "prefix" member - in
+//   a shared document into a digit trie the first time it is used, then finds the longest prefix of
+//   a number in one walk down the trie, one step per digit. like an index, a trie is immutable and
+//   holds the document version it was built over; when a new version is published, the publisher
+//   builds the new tries and swaps them in
+#define JSON_LPM_DIGITS        12        // 0 to 9, * and #
+#define JSON_LPM_PREFIX        "prefix"  // the member with the prefix, in an array of objects
+
+struct json_lpm_node {
+	unsigned int child[JSON_LPM_DIGITS];  // 0 for none: the root is nobody's child
+	const char *prefix;                   // the prefix ending here, or NULL
+	struct ast_json *value;
+};
+
+struct json_lpm {
+	struct json_compiled source;
+	struct json_lpm_node *nodes;          // the root is nodes[0]
+	unsigned int count;                   // nodes in use
+	unsigned int size;                    // nodes allocated
+	unsigned int prefixes;                // prefixes stored
+	unsigned int skipped;                 // prefixes left out: not digits, or there twice
+	char table[0];                        // the document name, then the path to the table in it
+};
+
+static struct ao2_container *json_lpms;
+
+AST_MUTEX_DEFINE_STATIC(json_lpm_lock);              // one build at a time
+
+AO2_STRING_FIELD_HASH_FN(json_lpm, table)
+AO2_STRING_FIELD_CMP_FN(json_lpm, table)
+
+static void json_lpm_destroy(void *obj) {
+	struct json_lpm *lpm = obj;
+	ast_free(lpm->nodes);
+	ao2_cleanup(lpm->source.shared);
+}
+
+static int json_lpm_digit(char c) {
+	if ((c >= '0') && (c <= '9'))
+		return c - '0';
+	return (c == '*') ? 10 : ((c == '#') ? 11 : -1);
+}
+
+static int json_lpm_insert(struct json_lpm *lpm, const char *prefix, struct ast_json *value) {
+// adds a prefix to the trie; a heading + is ignored, like in the numbers looked up. returns 0 when
+//   added, 1 when left out and -1 when out of memory
+	const char *p = prefix + (*prefix == '+');
+	if (p[strspn(p, "0123456789*#")])
+		return 1;
+	unsigned int node = 0;
+	for (; *p; p++) {
+		int digit = json_lpm_digit(*p);
+		if (!lpm->nodes[node].child[digit]) {
+			if (lpm->count == lpm->size) {
+				struct json_lpm_node *nodes = ast_realloc(lpm->nodes, 2 * lpm->size * sizeof(*nodes));
+				if (!nodes)
+					return -1;
+				memset(&nodes[lpm->size], 0, lpm->size * sizeof(*nodes));
+				lpm->nodes = nodes;
+				lpm->size *= 2;
+			}
+			lpm->nodes[node].child[digit] = lpm->count++;
+		}
+		node = lpm->nodes[node].child[digit];
+	}
+	if (lpm->nodes[node].prefix)
+		return 1;
+	lpm->nodes[node].prefix = prefix;
+	lpm->nodes[node].value = value;
+	lpm->prefixes++;
+	return 0;
+}
+
+static const struct json_lpm_node *json_lpm_match(const struct json_lpm *lpm, const char *number) {
+// walks down the trie along the digits of number; returns the node of the longest prefix found on
+//   the way, or NULL
+	const struct json_lpm_node *node = &lpm->nodes[0], *match = node->prefix ? node : NULL;
+	const char *p = number + (*number == '+');
+	for (; *p; p++) {
+		int digit = json_lpm_digit(*p);
+		if ((digit < 0) || !node->child[digit])
+			break;
+		node = &lpm->nodes[node->child[digit]];
+		if (node->prefix)
+			match = node;
+	}
+	return match;
+}
+
+static int json_lpm_build(const char *table, struct json_shared *shared, size_t namelen) {
+// compiles the table inside (a reference to) a shared document and swaps the trie in; returns a
+//   JSONRESULT code. call with json_lpm_lock held
+	struct ast_json *source;
+	int ret = json_compiled_table(table, shared, namelen, &source);
+	if (ret != ASTJSON_OK) {
+		ao2_ref(shared, -1);
+		return ret;
+	}
+	enum ast_json_type type = ast_json_typeof(source);
+	struct json_lpm *lpm = ao2_alloc_options(sizeof(*lpm) + strlen(table) + 1, json_lpm_destroy,
+		AO2_ALLOC_OPT_LOCK_NOLOCK);
+	if (!lpm) {
+		ao2_ref(shared, -1);
+		return ASTJSON_UNDECIDED;
+	}
+	lpm->source.shared = shared;
+	lpm->source.namelen = namelen;
+	lpm->source.table = strcpy(lpm->table, table);
+	lpm->size = 64;
+	lpm->count = 1;
+	if (!(lpm->nodes = ast_calloc(lpm->size, sizeof(*lpm->nodes)))) {
+		ao2_ref(lpm, -1);
+		return ASTJSON_UNDECIDED;
+	}
+
+	int res = 0;
+	if (type == AST_JSON_OBJECT) {
+		struct ast_json_iter *iter;
+		for (iter = ast_json_object_iter(source); iter && (res >= 0);
+				iter = ast_json_object_iter_next(source, iter)) {
+			res = json_lpm_insert(lpm, ast_json_object_iter_key(iter), ast_json_object_iter_value(iter));
+			lpm->skipped += (res > 0);
+		}
+	} else {
+		size_t i, n = ast_json_array_size(source);
+		for (i = 0; (i < n) && (res >= 0); i++) {
+			struct ast_json *element = ast_json_array_get(source, i);
+			struct ast_json *prefix = (ast_json_typeof(element) == AST_JSON_OBJECT) ?
+				ast_json_object_get(element, JSON_LPM_PREFIX) : NULL;
+			if (prefix && (ast_json_typeof(prefix) == AST_JSON_STRING))
+				res = json_lpm_insert(lpm, ast_json_string_get(prefix), element);
+			else
+				res = 1;
+			lpm->skipped += (res > 0);
+		}
+	}
+	if (res < 0) {
+		ao2_ref(lpm, -1);
+		return ASTJSON_UNDECIDED;
+	}
+	ao2_link(json_lpms, lpm);
+	ao2_ref(lpm, -1);
+	return ASTJSON_OK;
+}
+
+// sets, for blocklists: JSON_MEMBER compiles an array of numbers and strings in a shared document
+//   into a hash set the first time it is used, and rebuilds it with the document, like a trie.
+//   numbers - json integers, and strings of up to 17 digits with an optional heading + - are packed
+//   into 64-bit integers and kept in buckets of 4 slots, searched 4 at a time with avx2 where the
+//   cpu has it; the other strings go into a table of their own. a big set also gets a bloom filter
+//   in front of it: a few bits per element, small enough to stay in the cpu caches, that answer
+//   most of the lookups of values not in the set without touching the tables
+#define JSON_SET_BUCKET        4          // slots per bucket of packed numbers
+#define JSON_SET_DIGITS        17         // digits that fit in a packed number
+#define JSON_SET_BLOOM_MIN     65536      // elements from which a set gets a bloom filter
+#define JSON_SET_BLOOM_BITS    10         // bloom filter bits per element
+#define JSON_SET_TEXT          24         // room for an integer in text form
+
+struct json_set_string {
+	uint64_t hash;
+	const char *text;                     // NULL for an empty slot
+};
+
+struct json_set {
+	struct json_compiled source;
+	uint64_t *numbers;                    // buckets of packed numbers, 0 in the empty slots
+	size_t number_mask;                   // number of buckets - 1
+	struct json_set_string *strings;
+	size_t string_mask;                   // number of slots - 1
+	uint64_t *bloom;                      // NULL for a small set
+	size_t bloom_mask;                    // number of bits - 1
+	char *texts;                          // text form of the integers that cannot be packed
+	unsigned int packed;                  // elements stored as packed numbers
+	unsigned int unpacked;                // elements stored as strings
+	unsigned int duplicates;
+	unsigned int skipped;                 // elements that are neither numbers nor strings
+	size_t memory;                        // bytes taken by the tables
+	int64_t usecs;                        // how long the build took
+	char table[0];
+};
+
+static struct ao2_container *json_sets;
+
+AST_MUTEX_DEFINE_STATIC(json_set_lock);              // one build at a time
+
+AO2_STRING_FIELD_HASH_FN(json_set, table)
+AO2_STRING_FIELD_CMP_FN(json_set, table)
+
+static void json_set_destroy(void *obj) {
+	struct json_set *set = obj;
+	ast_free(set->numbers);
+	ast_free(set->strings);
+	ast_free(set->bloom);
+	ast_free(set->texts);
+	ao2_cleanup(set->source.shared);
+}
+
+static uint64_t json_set_pack(const char *text) {
+// the packed form of a number of up to 17 digits: their value, with the number of digits and the
+//   heading + in the top bits, so that "0123", "123" and "+123" stay different. never 0; returns 0
+//   for anything else
+	uint64_t plus = (*text == '+'), value = 0;
+	const char *p = text + plus;
+	size_t len = strspn(p, "0123456789");
+	if (!len || (len > JSON_SET_DIGITS) || p[len])
+		return 0;
+	for (; *p; p++)
+		value = value * 10 + (*p - '0');
+	return ((uint64_t)len << 59) | (plus << 58) | value;
+}
+
+static uint64_t json_set_mix(uint64_t key) {
+// spreads the bits of a packed number over a hash (the splitmix64 finalizer)
+	key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	key = (key ^ (key >> 27)) * 0x94d049bb133111ebULL;
+	return key ^ (key >> 31);
+}
+
+static int json_set_probe_scalar(const uint64_t *numbers, size_t mask, uint64_t key, uint64_t hash) {
+// the slots of a bucket are filled in order, so an empty slot ends the search
+	size_t bucket = hash & mask;
+	for (;;) {
+		const uint64_t *slot = &numbers[bucket * JSON_SET_BUCKET];
+		int i;
+		for (i = 0; i < JSON_SET_BUCKET; i++) {
+			if (slot[i] == key)
+				return 1;
+			if (!slot[i])
+				return 0;
+		}
+		bucket = (bucket + 1) & mask;
+	}
+}
+
+#ifdef JSON_SCAN_X86
+__attribute__((target("avx2")))
+static int json_set_probe_avx2(const uint64_t *numbers, size_t mask, uint64_t key, uint64_t hash) {
+	const __m256i needle = _mm256_set1_epi64x(key), empty = _mm256_setzero_si256();
+	size_t bucket = hash & mask;
+	for (;;) {
+		__m256i slots = _mm256_loadu_si256((const __m256i *)&numbers[bucket * JSON_SET_BUCKET]);
+		if (_mm256_movemask_epi8(_mm256_cmpeq_epi64(slots, needle)))
+			return 1;
+		if (_mm256_movemask_epi8(_mm256_cmpeq_epi64(slots, empty)))
+			return 0;
+		bucket = (bucket + 1) & mask;
+	}
+}
+#endif
+
+static const char *json_set_isa = "scalar";
+static int (*json_set_probe)(const uint64_t *numbers, size_t mask, uint64_t key, uint64_t hash) =
+	json_set_probe_scalar;
+
+static void json_set_init(void) {
+#ifdef JSON_SCAN_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) {
+		json_set_isa = "avx2";
+		json_set_probe = json_set_probe_avx2;
+	}
+#endif
+	ast_log(LOG_DEBUG, "using the %s json set lookup\n", json_set_isa);
+}
+
+static int json_set_bloom_test(const struct json_set *set, uint64_t hash) {
+// three bits per element, taken from three parts of its hash
+	size_t a = hash & set->bloom_mask, b = (hash >> 21) & set->bloom_mask;
+	size_t c = (hash >> 42) & set->bloom_mask;
+	return ((set->bloom[a / 64] >> (a % 64)) & (set->bloom[b / 64] >> (b % 64)) &
+		(set->bloom[c / 64] >> (c % 64)) & 1);
+}
+
+static void json_set_bloom_add(struct json_set *set, uint64_t hash) {
+	size_t a = hash & set->bloom_mask, b = (hash >> 21) & set->bloom_mask;
+	size_t c = (hash >> 42) & set->bloom_mask;
+	set->bloom[a / 64] |= 1ULL << (a % 64);
+	set->bloom[b / 64] |= 1ULL << (b % 64);
+	set->bloom[c / 64] |= 1ULL << (c % 64);
+}
+
+static int json_set_add(struct json_set *set, const char *text) {
+// adds a value; returns 0 when added, 1 when it was there already
+	uint64_t key = json_set_pack(text);
+	uint64_t hash = key ? json_set_mix(key) : json_fingerprint(text, strlen(text));
+	if (key) {
+		size_t bucket = hash & set->number_mask;
+		uint64_t *slot;
+		for (;;) {
+			int i;
+			slot = &set->numbers[bucket * JSON_SET_BUCKET];
+			for (i = 0; (i < JSON_SET_BUCKET) && slot[i] && (slot[i] != key); i++)
+				;
+			if (i < JSON_SET_BUCKET) {
+				slot += i;
+				break;
+			}
+			bucket = (bucket + 1) & set->number_mask;
+		}
+		if (*slot)
+			return 1;
+		*slot = key;
+		set->packed++;
+	} else {
+		struct json_set_string *slot;
+		for (slot = &set->strings[hash & set->string_mask]; slot->text;
+				slot = &set->strings[(slot - set->strings + 1) & set->string_mask])
+			if ((slot->hash == hash) && !strcmp(slot->text, text))
+				return 1;
+		slot->hash = hash;
+		slot->text = text;
+		set->unpacked++;
+	}
+	if (set->bloom)
+		json_set_bloom_add(set, hash);
+	return 0;
+}
+
+static int json_set_contains(const struct json_set *set, const char *text) {
+	uint64_t key = json_set_pack(text);
+	uint64_t hash = key ? json_set_mix(key) : json_fingerprint(text, strlen(text));
+	if (set->bloom && !json_set_bloom_test(set, hash))
+		return 0;
+	if (key)
+		return json_set_probe(set->numbers, set->number_mask, key, hash);
+	const struct json_set_string *slot;
+	for (slot = &set->strings[hash & set->string_mask]; slot->text;
+			slot = &set->strings[(slot - set->strings + 1) & set->string_mask])
+		if ((slot->hash == hash) && !strcmp(slot->text, text))
+			return 1;
+	return 0;
+}
+
+static int json_set_build(const char *table, struct json_shared *shared, size_t namelen) {
+// compiles the array inside (a reference to) a shared document into a set and swaps it in;
+//   returns a JSONRESULT code. call with json_set_lock held
+	struct timeval start = ast_tvnow();
+	struct ast_json *source;
+	int ret = json_compiled_table(table, shared, namelen, &source);
+	if ((ret == ASTJSON_OK) && (ast_json_typeof(source) != AST_JSON_ARRAY))
+		ret = ASTJSON_INVALID_TYPE;
+	if (ret != ASTJSON_OK) {
+		ao2_ref(shared, -1);
+		return ret;
+	}
+	struct json_set *set = ao2_alloc_options(sizeof(*set) + strlen(table) + 1, json_set_destroy,
+		AO2_ALLOC_OPT_LOCK_NOLOCK);
+	if (!set) {
+		ao2_ref(shared, -1);
+		return ASTJSON_UNDECIDED;
+	}
+	set->source.shared = shared;
+	set->source.namelen = namelen;
+	set->source.table = strcpy(set->table, table);
+
+	// a first pass counts what goes where, to size the tables: the buckets of numbers are filled
+	//   up to three quarters, the string table, probed one slot at a time, up to a half
+	size_t n = ast_json_array_size(source), numbers = 0, others = 0, texts = 0, i;
+	char number[JSON_SET_TEXT];
+	for (i = 0; i < n; i++) {
+		struct ast_json *element = ast_json_array_get(source, i);
+		switch (ast_json_typeof(element)) {
+		case AST_JSON_STRING:
+			if (json_set_pack(ast_json_string_get(element)))
+				numbers++;
+			else
+				others++;
+			break;
+		case AST_JSON_INTEGER:
+			snprintf(number, sizeof(number), "%jd", ast_json_integer_get(element));
+			if (json_set_pack(number))
+				numbers++;
+			else
+				texts++;
+			break;
+		default:
+			set->skipped++;
+		}
+	}
+	size_t buckets = 1, strings = 2, bits = 64;
+	while (3 * buckets * JSON_SET_BUCKET < 4 * numbers)
+		buckets <<= 1;
+	while (strings < 2 * (others + texts))
+		strings <<= 1;
+	while ((n >= JSON_SET_BLOOM_MIN) && (bits < JSON_SET_BLOOM_BITS * n))
+		bits <<= 1;
+	set->number_mask = buckets - 1;
+	set->string_mask = strings - 1;
+	set->bloom_mask = bits - 1;
+	set->memory = buckets * JSON_SET_BUCKET * sizeof(*set->numbers) +
+		strings * sizeof(*set->strings) + texts * JSON_SET_TEXT;
+	if (n >= JSON_SET_BLOOM_MIN)
+		set->memory += bits / 8;
+	if (!(set->numbers = ast_calloc(buckets * JSON_SET_BUCKET, sizeof(*set->numbers))) ||
+		!(set->strings = ast_calloc(strings, sizeof(*set->strings))) ||
+		(texts && !(set->texts = ast_malloc(texts * JSON_SET_TEXT))) ||
+		((n >= JSON_SET_BLOOM_MIN) && !(set->bloom = ast_calloc(bits / 64, sizeof(*set->bloom))))) {
+		ao2_ref(set, -1);
+		return ASTJSON_UNDECIDED;
+	}
+
+	char *text = set->texts;
+	for (i = 0; i < n; i++) {
+		struct ast_json *element = ast_json_array_get(source, i);
+		switch (ast_json_typeof(element)) {
+		case AST_JSON_STRING:
+			set->duplicates += json_set_add(set, ast_json_string_get(element));
+			break;
+		case AST_JSON_INTEGER:
+			// a packed number keeps nothing of its text; the others need a copy of it
+			snprintf(number, sizeof(number), "%jd", ast_json_integer_get(element));
+			if (json_set_pack(number))
+				set->duplicates += json_set_add(set, number);
+			else {
+				set->duplicates += json_set_add(set, strcpy(text, number));
+				text += JSON_SET_TEXT;
+			}
+			break;
+		default:
+			break;
+		}
+	}
+	set->usecs = ast_tvdiff_us(ast_tvnow(), start);
+	ao2_link(json_sets, set);
+	ao2_ref(set, -1);
+	return ASTJSON_OK;
+}
+
+static void json_shared_changed(const char *name) {
+// a shared document was published again or removed: rebuild what was built over it
+	json_index_refresh(name);
+	json_compiled_refresh(json_lpms, &json_lpm_lock, json_lpm_build, name, "prefix table");
+	json_compiled_refresh(json_sets, &json_set_lock, json_set_build, name, "set");
+}
+
+// a single element can also be read straight out of the document text, without building the tree:
+//   the scanner walks the text once, follows the path and skips everything else without allocating
+//   anything. it accepts exactly what the jansson parser accepts (same syntax, utf-8, escape,
+//   number range and nesting rules), so a document it cannot vouch for - or an element it does not
+//   know how to return, like an array or an object - is handed over to the parser instead
+#define JSON_SCAN_MAX_DEPTH     2048      // the jansson parser nesting limit
+#define JSON_SCAN_MAX_SEGMENTS  32
+#define JSON_SCAN_MAX_NUMBER    64
+
+#define JSON_SCAN_LIMIT         -2        // the document goes over a limit
+#define JSON_SCAN_GIVE_UP       -1
+#define JSON_SCAN_NOTFOUND      0
+#define JSON_SCAN_FOUND         1
+#define JSON_SCAN_VALID         2         // the element is there, but the parser has to return it
+
+struct json_scan_value {
+	enum ast_json_type type;
+	const char *start;                    // the raw text; for strings, without the quotes
+	const char *end;
+	const char *limited;                  // the limit reached, for JSON_SCAN_LIMIT
+};
+
+#define json_scan_isdigit(c)    (((c) >= '0') && ((c) <= '9'))
+
+// the bulk of a document is string contents and indentation; the scanner goes over those in
+//   blocks of 16 or 32 bytes with SSE4.2 or AVX2 when the cpu has them, and a byte at a time
+//   otherwise. the variant is picked once, when the module loads
+static const char *json_scan_plain_scalar(const char *p, const char *end) {
+// returns the first byte of a string that needs a closer look: a quote, a backslash, a control
+//   character or the start of a multibyte utf-8 sequence
+	while ((p < end) && ((unsigned char)*p >= 0x20) && ((unsigned char)*p < 0x80) &&
+		(*p != '"') && (*p != '\\'))
+		p++;
+	return p;
+}
+
+static const char *json_scan_blank_scalar(const char *p, const char *end) {
+	while ((p < end) && ((*p == ' ') || (*p == '\t') || (*p == '\n') || (*p == '\r')))
+		p++;
+	return p;
+}
+
+#ifdef JSON_SCAN_X86
+__attribute__((target("sse4.2")))
+static const char *json_scan_plain_sse42(const char *p, const char *end) {
+	const __m128i ranges = _mm_setr_epi8(0x00, 0x1F, '"', '"', '\\', '\\', (char)0x80, (char)0xFF,
+		0, 0, 0, 0, 0, 0, 0, 0);
+	while (end - p >= 16) {
+		int i = _mm_cmpestri(ranges, 8, _mm_loadu_si128((const __m128i *)p), 16,
+			_SIDD_UBYTE_OPS | _SIDD_CMP_RANGES | _SIDD_LEAST_SIGNIFICANT);
+		if (i < 16)
+			return p + i;
+		p += 16;
+	}
+	return json_scan_plain_scalar(p, end);
+}
+
+__attribute__((target("sse4.2")))
+static const char *json_scan_blank_sse42(const char *p, const char *end) {
+	const __m128i blanks = _mm_setr_epi8(' ', '\t', '\n', '\r', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+	while (end - p >= 16) {
+		int i = _mm_cmpestri(blanks, 4, _mm_loadu_si128((const __m128i *)p), 16,
+			_SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_NEGATIVE_POLARITY | _SIDD_LEAST_SIGNIFICANT);
+		if (i < 16)
+			return p + i;
+		p += 16;
+	}
+	return json_scan_blank_scalar(p, end);
+}
+
+__attribute__((target("avx2")))
+static const char *json_scan_plain_avx2(const char *p, const char *end) {
+	const __m256i quote = _mm256_set1_epi8('"'), backslash = _mm256_set1_epi8('\\');
+	const __m256i space = _mm256_set1_epi8(0x20);
+	while (end - p >= 32) {
+		__m256i block = _mm256_loadu_si256((const __m256i *)p);
+		// a signed compare with 0x20 catches both the control characters and the bytes >= 0x80
+		__m256i special = _mm256_or_si256(
+			_mm256_or_si256(_mm256_cmpeq_epi8(block, quote), _mm256_cmpeq_epi8(block, backslash)),
+			_mm256_cmpgt_epi8(space, block));
+		unsigned int mask = _mm256_movemask_epi8(special);
+		if (mask)
+			return p + __builtin_ctz(mask);
+		p += 32;
+	}
+	return json_scan_plain_scalar(p, end);
+}
+
+__attribute__((target("avx2")))
+static const char *json_scan_blank_avx2(const char *p, const char *end) {
+	const __m256i space = _mm256_set1_epi8(' '), tab = _mm256_set1_epi8('\t');
+	const __m256i newline = _mm256_set1_epi8('\n'), cr = _mm256_set1_epi8('\r');
+	while (end - p >= 32) {
+		__m256i block = _mm256_loadu_si256((const __m256i *)p);
+		__m256i blank = _mm256_or_si256(
+			_mm256_or_si256(_mm256_cmpeq_epi8(block, space), _mm256_cmpeq_epi8(block, tab)),
+			_mm256_or_si256(_mm256_cmpeq_epi8(block, newline), _mm256_cmpeq_epi8(block, cr)));
+		unsigned int mask = ~(unsigned int)_mm256_movemask_epi8(blank);
+		if (mask)
+			return p + __builtin_ctz(mask);
+		p += 32;
+	}
+	return json_scan_blank_scalar(p, end);
+}
+#endif
+
+static const char *json_scan_isa = "scalar";
+static const char *(*json_scan_plain)(const char *p, const char *end) = json_scan_plain_scalar;
+static const char *(*json_scan_blank)(const char *p, const char *end) = json_scan_blank_scalar;
+
+static void json_scan_init(void) {
+#ifdef JSON_SCAN_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) {
+		json_scan_isa = "avx2";
+		json_scan_plain = json_scan_plain_avx2;
+		json_scan_blank = json_scan_blank_avx2;
+	} else if (__builtin_cpu_supports("sse4.2")) {
+		json_scan_isa = "sse4.2";
+		json_scan_plain = json_scan_plain_sse42;
+		json_scan_blank = json_scan_blank_sse42;
+	}
+#endif
+	ast_log(LOG_DEBUG, "using the %s json text scanner\n", json_scan_isa);
+}
+
+static const char *json_scan_space(const char *p, const char *end) {
+	// most values are not preceded by any blank at all
+	if ((p >= end) || ((*p != ' ') && (*p != '\t') && (*p != '\n') && (*p != '\r')))
+		return p;
+	return json_scan_blank(p, end);
+}
+
+static int json_scan_hex(const char *p, const char *end) {
+// value of the 4 hex digits at p, or -1
+	int i, value = 0;
+	if (end - p < 4)
+		return -1;
+	for (i = 0; i < 4; i++) {
+		char c = p[i];
+		value <<= 4;
+		if ((c >= '0') && (c <= '9'))
+			value |= c - '0';
+		else if ((c >= 'a') && (c <= 'f'))
+			value |= c - 'a' + 10;
+		else if ((c >= 'A') && (c <= 'F'))
+			value |= c - 'A' + 10;
+		else
+			return -1;
+	}
+	return value;
+}
+
+static int json_scan_utf8(const unsigned char *p, const unsigned char *end) {
+// length of the valid utf-8 sequence starting at p, or 0 (overlong forms, surrogates and code
+//   points past U+10FFFF are invalid)
+	int i, len;
+	unsigned int value;
+	if (*p < 0x80)
+		return 1;
+	else if ((*p >= 0xC2) && (*p <= 0xDF)) {
+		len = 2;
+		value = *p & 0x1F;
+	} else if ((*p >= 0xE0) && (*p <= 0xEF)) {
+		len = 3;
+		value = *p & 0x0F;
+	} else if ((*p >= 0xF0) && (*p <= 0xF4)) {
+		len = 4;
+		value = *p & 0x07;
+	} else
+		return 0;
+	if (end - p < len)
+		return 0;
+	for (i = 1; i < len; i++) {
+		if ((p[i] & 0xC0) != 0x80)
+			return 0;
+		value = (value << 6) | (p[i] & 0x3F);
+	}
+	if (((len == 3) && (value < 0x800)) || ((len == 4) && (value < 0x10000)) ||
+		((value >= 0xD800) && (value <= 0xDFFF)) || (value > 0x10FFFF))
+		return 0;
+	return len;
+}
+
+static const char *json_scan_string(const char *p, const char *end, int *escaped) {
+// p is right after the opening quote; returns the closing quote, or NULL if the string is invalid
+	*escaped = 0;
+	while ((p = json_scan_plain(p, end)) < end) {
+		unsigned char c = *p;
+		if (c == '"')
+			return p;
+		if (c < 0x20)
+			return NULL;
+		if (c == '\\') {
+			*escaped = 1;
+			if (++p >= end)
+				return NULL;
+			switch (*p) {
+			case '"': case '\\': case '/': case 'b': case 'f': case 'n': case 'r': case 't':
+				p++;
+				break;
+			case 'u': {
+				int value = json_scan_hex(p + 1, end);
+				if (value <= 0)
+					return NULL;       // invalid, or \u0000
+				p += 5;
+				if ((value >= 0xD800) && (value <= 0xDBFF)) {
+					// must be followed by the low half of a surrogate pair
+					if ((end - p < 2) || (p[0] != '\\') || (p[1] != 'u'))
+						return NULL;
+					value = json_scan_hex(p + 2, end);
+					if ((value < 0xDC00) || (value > 0xDFFF))
+						return NULL;
+					p += 6;
+				} else if ((value >= 0xDC00) && (value <= 0xDFFF))
+					return NULL;
+				break;
+			}
+			default:
+				return NULL;
+			}
+		} else {
+			int len = json_scan_utf8((const unsigned char *)p, (const unsigned char *)end);
+			if (!len)
+				return NULL;
+			p += len;
+		}
+	}
+	return NULL;
+}
+
+static const char *json_scan_number(const char *p, const char *end, int *is_real) {
+// returns the end of the number at p, or NULL if it is invalid or may not fit the type jansson
+//   would store it in (long long, or a double that does not overflow)
+	const char *start = p, *digits;
+	int intdigits, exponent = 0, expsign = 1;
+	*is_real = 0;
+	if ((p < end) && (*p == '-'))
+		p++;
+	digits = p;
+	if ((p < end) && (*p == '0')) {
+		p++;
+		if ((p < end) && json_scan_isdigit(*p))
+			return NULL;
+	} else if ((p < end) && json_scan_isdigit(*p)) {
+		while ((p < end) && json_scan_isdigit(*p))
+			p++;
+	} else
+		return NULL;
+	intdigits = (*digits == '0') ? 0 : p - digits;
+	if ((p < end) && (*p == '.')) {
+		*is_real = 1;
+		if ((++p >= end) || !json_scan_isdigit(*p))
+			return NULL;
+		while ((p < end) && json_scan_isdigit(*p))
+			p++;
+	}
+	if ((p < end) && ((*p == 'e') || (*p == 'E'))) {
+		*is_real = 1;
+		p++;
+		if ((p < end) && ((*p == '+') || (*p == '-')))
+			expsign = (*p++ == '-') ? -1 : 1;
+		if ((p >= end) || !json_scan_isdigit(*p))
+			return NULL;
+		while ((p < end) && json_scan_isdigit(*p)) {
+			if (exponent < 10000)
+				exponent = exponent * 10 + (*p - '0');
+			p++;
+		}
+	}
+	// only bother with the exact value if it could be out of range
+	if (*is_real ? (intdigits + expsign * exponent > 300) : (intdigits > 18)) {
+		char number[JSON_SCAN_MAX_NUMBER];
+		if (p - start >= sizeof(number))
+			return NULL;
+		memcpy(number, start, p - start);
+		number[p - start] = 0;
+		errno = 0;
+		if (*is_real) {
+			double value = strtod(number, NULL);
+			if (((value == HUGE_VAL) || (value == -HUGE_VAL)) && (errno == ERANGE))
+				return NULL;
+		} else {
+			strtoll(number, NULL, 10);
+			if (errno == ERANGE)
+				return NULL;
+		}
+	}
+	return p;
+}
+
+static size_t json_scan_decode(const char **p, const char *end, char *encoded) {
+// decodes the next character of a (valid) raw json string into utf-8; returns its length
+	const char *c = *p;
+	unsigned int value;
+	if (*c != '\\') {
+		encoded[0] = *c;
+		*p = c + 1;
+		return 1;
+	}
+	*p = c + 2;
+	switch (c[1]) {
+	case 'b': encoded[0] = '\b'; return 1;
+	case 'f': encoded[0] = '\f'; return 1;
+	case 'n': encoded[0] = '\n'; return 1;
+	case 'r': encoded[0] = '\r'; return 1;
+	case 't': encoded[0] = '\t'; return 1;
+	case 'u': break;
+	default: encoded[0] = c[1]; return 1;
+	}
+	value = json_scan_hex(c + 2, end);
+	*p = c + 6;
+	if ((value >= 0xD800) && (value <= 0xDBFF)) {
+		value = 0x10000 + ((value - 0xD800) << 10) + (json_scan_hex(c + 8, end) - 0xDC00);
+		*p = c + 12;
+	}
+	if (value < 0x80) {
+		encoded[0] = value;
+		return 1;
+	} else if (value < 0x800) {
+		encoded[0] = 0xC0 | (value >> 6);
+		encoded[1] = 0x80 | (value & 0x3F);
+		return 2;
+	} else if (value < 0x10000) {
+		encoded[0] = 0xE0 | (value >> 12);
+		encoded[1] = 0x80 | ((value >> 6) & 0x3F);
+		encoded[2] = 0x80 | (value & 0x3F);
+		return 3;
+	}
+	encoded[0] = 0xF0 | (value >> 18);
+	encoded[1] = 0x80 | ((value >> 12) & 0x3F);
+	encoded[2] = 0x80 | ((value >> 6) & 0x3F);
+	encoded[3] = 0x80 | (value & 0x3F);
+	return 4;
+}
+
+static int json_scan_key_equal(const char *p, const char *end, const char *key) {
+// compares a raw json string holding escape sequences with a plain one
+	char encoded[4];
+	while (p < end) {
+		size_t len = json_scan_decode(&p, end, encoded);
+		if (strncmp(key, encoded, len))
+			return 0;
+		key += len;
+	}
+	return !*key;
+}
+
+static int json_scan_doc(const char *text, size_t len, const struct json_path *path,
+	const struct json_limits *limits, struct json_scan_value *result
+) {
+// looks for the element at path in the document text, holding it to the depth and elements
+//   limits (if given) on the way. returns JSON_SCAN_FOUND (with the element in result),
+//   JSON_SCAN_NOTFOUND or JSON_SCAN_VALID (the element is not a scalar, or a number too long to
+//   return) only if the whole document is valid and within the limits; JSON_SCAN_LIMIT (with the
+//   limit in result) if it goes over one, JSON_SCAN_GIVE_UP if it is not valid
+	const char *p = text, *end = text + len, *q;
+	char stack[JSON_SCAN_MAX_DEPTH];      // the open containers, '{' or '['
+	int index[JSON_SCAN_MAX_SEGMENTS];    // element counters of the arrays on the path
+	int depth = 0;                        // number of open containers
+	int onpath = 0;                       // the open containers 1..onpath are all on the path
+	int level = 0;                        // path segments matched by the next value, or -1
+	int found = 0, escaped, is_real;
+	int deferred = 0;                     // the element is there, for the parser to return
+	int max_depth = limits ? limits->depth : 0;
+	size_t elements = 0, max_elements = limits ? limits->elements : 0;
+
+	result->limited = NULL;
+	if ((path->count == 0) || (path->count > JSON_SCAN_MAX_SEGMENTS))
+		return JSON_SCAN_GIVE_UP;
+	p = json_scan_space(p, end);
+	if ((p >= end) || ((*p != '{') && (*p != '[')))
+		return JSON_SCAN_GIVE_UP;
+
+	for (;;) {
+		// p is at the start of a value
+		if ((p >= end) || (depth >= JSON_SCAN_MAX_DEPTH))
+			return JSON_SCAN_GIVE_UP;
+		if (max_elements && (++elements > max_elements)) {
+			result->limited = "elements";
+			return JSON_SCAN_LIMIT;
+		}
+		if (level == path->count)
+			result->start = p;
+		switch (*p) {
+		case '{':
+		case '[':
+			if (max_depth && (depth >= max_depth)) {
+				result->limited = "depth";
+				return JSON_SCAN_LIMIT;
+			}
+			if (level == path->count) {
+				// the rest of the document is still checked, so the parser does not have to
+				deferred = 1;
+				level = -1;
+			}
+			stack[depth++] = *p;
+			if (level >= 0) {
+				onpath = depth;
+				index[depth - 1] = 0;
+			}
+			p = json_scan_space(p + 1, end);
+			if ((p < end) && (*p == ((stack[depth - 1] == '{') ? '}' : ']'))) {
+				p++;
+				goto close;
+			}
+			if (stack[depth - 1] == '{')
+				goto member;
+			goto element;
+		case '"':
+			if (!(q = json_scan_string(p + 1, end, &escaped)))
+				return JSON_SCAN_GIVE_UP;
+			if (level == path->count) {
+				result->type = AST_JSON_STRING;
+				result->start = p + 1;
+				result->end = q;
+			}
+			p = q + 1;
+			break;
+		case 't':
+		case 'f':
+		case 'n': {
+			static const char *literals[] = { "true", "false", "null" };
+			static const enum ast_json_type types[] = { AST_JSON_TRUE, AST_JSON_FALSE, AST_JSON_NULL };
+			int i = (*p == 't') ? 0 : ((*p == 'f') ? 1 : 2);
+			size_t literal = strlen(literals[i]);
+			if ((end - p < literal) || memcmp(p, literals[i], literal))
+				return JSON_SCAN_GIVE_UP;
+			if (level == path->count)
+				result->type = types[i];
+			p += literal;
+			break;
+		}
+		default:
+			if (!(q = json_scan_number(p, end, &is_real)))
+				return JSON_SCAN_GIVE_UP;
+			if (level == path->count) {
+				if (q - p >= JSON_SCAN_MAX_NUMBER) {
+					deferred = 1;
+					level = -1;
+				} else
+					result->type = is_real ? AST_JSON_REAL : AST_JSON_INTEGER;
+			}
+			p = q;
+			break;
+		}
+		if (level == path->count) {
+			if (result->type != AST_JSON_STRING)
+				result->end = p;
+			found = 1;
+		}
+
+next:
+		// a value just ended; see what comes after it
+		p = json_scan_space(p, end);
+		if (depth == 0) {
+			if (p != end)
+				return JSON_SCAN_GIVE_UP;
+			return deferred ? JSON_SCAN_VALID : (found ? JSON_SCAN_FOUND : JSON_SCAN_NOTFOUND);
+		}
+		if (p >= end)
+			return JSON_SCAN_GIVE_UP;
+		if (*p == ',') {
+			p = json_scan_space(p + 1, end);
+			if (stack[depth - 1] == '{')
+				goto member;
+			if (depth == onpath)
+				index[depth - 1]++;
+			goto element;
+		}
+		if (*p != ((stack[depth - 1] == '{') ? '}' : ']'))
+			return JSON_SCAN_GIVE_UP;
+		p++;
+close:
+		if (onpath == depth)
+			onpath--;
+		depth--;
+		goto next;
+
+member:
+		// p is at the name of an object member
+		if ((p >= end) || (*p != '"') || !(q = json_scan_string(p + 1, end, &escaped)))
+			return JSON_SCAN_GIVE_UP;
+		level = -1;
+		if (depth == onpath) {
+			const struct json_path_segment *segment = &path->segments[depth - 1];
+			if (!segment->is_index && (escaped ? json_scan_key_equal(p + 1, q, segment->key) :
+				((q - p - 1 == strlen(segment->key)) && !memcmp(p + 1, segment->key, q - p - 1)))) {
+				// a repeated name replaces what was found under the previous one
+				level = depth;
+				found = deferred = 0;
+			}
+		}
+		p = json_scan_space(q + 1, end);
+		if ((p >= end) || (*p != ':'))
+			return JSON_SCAN_GIVE_UP;
+		p = json_scan_space(p + 1, end);
+		continue;
+
+element:
+		// p is at an array element
+		level = -1;
+		if (depth == onpath) {
+			const struct json_path_segment *segment = &path->segments[depth - 1];
+			if (segment->is_index && (segment->index == index[depth - 1]))
+				level = depth;
+		}
+	}
+}
+
+static void json_scan_unescape(const char *p, const char *end, struct ast_str **buf, ssize_t len) {
+// appends a (valid) raw json string to buf, decoding the escape sequences; the runs between them
+//   are copied as they are
+	char encoded[4];
+	while (p < end) {
+		const char *escape = memchr(p, '\\', end - p);
+		if (!escape)
+			escape = end;
+		if (escape > p) {
+			ast_str_append_substr(buf, len, p, escape - p);
+			p = escape;
+		}
+		if (p < end) {
+			size_t count = json_scan_decode(&p, end, encoded);
+			ast_str_append_substr(buf, len, encoded, count);
+		}
+	}
+}
+
+// JSONCOMPRESS and JSONPRETTY reformat the text itself in one pass rather than parsing and
+//   dumping it: the same walk as json_scan_doc checks the syntax, the blanks out of the strings
+//   are dropped (the vectorized json_scan_blank finds where they end) and the text between them
+//   is copied as it is. strings and numbers keep their written form: the escapes are not decoded
+//   and 1.50 stays 1.50, but the result says the same as the jansson output would. without an
+//   output buffer the walk only checks the text, against limits of its own if asked (JSONVALID)
+#define JSON_FORMAT_INDENT     2         // spaces per level, as AST_JSON_PRETTY
+#define JSON_FORMAT_SPACE      -1        // level for a single space, after a member name
+#define JSON_FORMAT_NONE       -2        // level for nothing at all, inside an empty container
+
+struct json_format {
+	struct ast_str **buf;                 // NULL to check the text only
+	ssize_t buflen;
+	const char *run;                      // start of the text not copied yet
+	int indent;                           // spaces per level, 0 for compact output
+	int max_depth;                        // nesting allowed, 0 for the parser limit only
+	size_t max_elements;                  // values allowed, 0 for any number
+	size_t max_output;                    // bytes of text appended allowed, 0 for any number
+	size_t elements;                      // values met so far
+	size_t error;                         // offset of the token the text went wrong at
+	const char *limited;                  // the limit reached, if that is the error
+	int deep;                             // the error is that the text nests too deep to follow
+};
+
+static void json_format_gap(struct json_format *format, const char *from, const char *to, int level) {
+// the blanks from..to between two tokens are dropped; pretty output gets a new line indented
+//   for level in their place, or what the special levels ask for
+	static const char spaces[] = "                                                                ";
+	if (!format->buf || (!format->indent && (from == to)))
+		return;
+	if (from > format->run)
+		ast_str_append_substr(format->buf, format->buflen, format->run, from - format->run);
+	format->run = to;
+	if (!format->indent || (level == JSON_FORMAT_NONE))
+		return;
+	if (level == JSON_FORMAT_SPACE) {
+		ast_str_append_substr(format->buf, format->buflen, " ", 1);
+		return;
+	}
+	ast_str_append_substr(format->buf, format->buflen, "\n", 1);
+	size_t count = (size_t)level * format->indent;
+	while (count) {
+		size_t chunk = MIN(count, sizeof(spaces) - 1);
+		ast_str_append_substr(format->buf, format->buflen, spaces, chunk);
+		count -= chunk;
+	}
+}
+
+static int json_scan_format(const char *text, size_t len, struct json_format *format) {
+// appends the document text to format->buf minified, or pretty printed with format->indent
+//   spaces per level. returns 0, or -1 (buf left as it was, format->error set) if the text is not
+//   a document the parser would accept or goes over the limits. like json_scan_doc, it may turn
+//   down a number the parser would take, if it is too long to be sure it fits
+	const char *p = text, *end = text + len, *q, *r;
+	char stack[JSON_SCAN_MAX_DEPTH];      // the open containers, '{' or '['
+	int depth = 0, escaped, is_real;
+	size_t start = format->buf ? ast_str_strlen(*format->buf) : 0;
+
+	format->limited = NULL;
+	format->deep = 0;
+	p = json_scan_space(p, end);
+	if ((p >= end) || ((*p != '{') && (*p != '[')))
+		goto invalid;
+	format->run = p;
+	format->elements = 0;
+	// minified text is no longer than the source; pretty text is most often not much longer
+	if (format->buf)
+		ast_str_make_space(format->buf, start + (end - p) + (format->indent ? (end - p) / 2 : 0) + 1);
+
+	for (;;) {
+		// p is at the start of a value
+		if (p >= end)
+			goto invalid;
+		if (depth >= JSON_SCAN_MAX_DEPTH) {
+			format->deep = 1;
+			goto invalid;
+		}
+		if (format->max_elements && (++format->elements > format->max_elements)) {
+			format->limited = "elements";
+			goto invalid;
+		}
+		switch (*p) {
+		case '{':
+		case '[':
+			if (format->max_depth && (depth >= format->max_depth)) {
+				format->limited = "depth";
+				goto invalid;
+			}
+			stack[depth++] = *p;
+			q = json_scan_space(p + 1, end);
+			if ((q < end) && (*q == ((stack[depth - 1] == '{') ? '}' : ']'))) {
+				json_format_gap(format, p + 1, q, JSON_FORMAT_NONE);
+				p = q + 1;
+				depth--;
+				goto next;
+			}
+			json_format_gap(format, p + 1, q, depth);
+			p = q;
+			if (stack[depth - 1] == '{')
+				goto member;
+			continue;
+		case '"':
+			if (!(q = json_scan_string(p + 1, end, &escaped)))
+				goto invalid;
+			p = q + 1;
+			break;
+		case 't':
+		case 'f':
+		case 'n': {
+			static const char *literals[] = { "true", "false", "null" };
+			const char *literal = literals[(*p == 't') ? 0 : ((*p == 'f') ? 1 : 2)];
+			size_t literal_len = strlen(literal);
+			if ((end - p < literal_len) || memcmp(p, literal, literal_len))
+				goto invalid;
+			p += literal_len;
+			break;
+		}
+		default:
+			if (!(q = json_scan_number(p, end, &is_real)))
+				goto invalid;
+			p = q;
+			break;
+		}
+
+next:
+		// a value just ended; see what comes after it
+		if (format->max_output && format->buf &&
+			(ast_str_strlen(*format->buf) - start > format->max_output)) {
+			format->limited = "output";
+			goto invalid;
+		}
+		q = json_scan_space(p, end);
+		if (depth == 0) {
+			if (q != end) {
+				p = q;
+				goto invalid;
+			}
+			if (!format->buf)
+				return 0;
+			if (format->max_output && (ast_str_strlen(*format->buf) - start + (p - format->run) >
+				format->max_output)) {
+				format->limited = "output";
+				goto invalid;
+			}
+			if (p > format->run)
+				ast_str_append_substr(format->buf, format->buflen, format->run, p - format->run);
+			return 0;
+		}
+		if ((q < end) && (*q == ',')) {
+			json_format_gap(format, p, q, JSON_FORMAT_NONE);
+			p = json_scan_space(q + 1, end);
+			json_format_gap(format, q + 1, p, depth);
+			if (stack[depth - 1] == '{')
+				goto member;
+			continue;
+		}
+		if ((q >= end) || (*q != ((stack[depth - 1] == '{') ? '}' : ']'))) {
+			p = q;
+			goto invalid;
+		}
+		json_format_gap(format, p, q, depth - 1);
+		p = q + 1;
+		depth--;
+		goto next;
+
+member:
+		// p is at the name of an object member
+		if ((p >= end) || (*p != '"') || !(q = json_scan_string(p + 1, end, &escaped)))
+			goto invalid;
+		r = q + 1;
+		q = json_scan_space(r, end);
+		if ((q >= end) || (*q != ':')) {
+			p = q;
+			goto invalid;
+		}
+		json_format_gap(format, r, q, JSON_FORMAT_NONE);
+		p = json_scan_space(q + 1, end);
+		json_format_gap(format, q + 1, p, JSON_FORMAT_SPACE);
+	}
+
+invalid:
+	format->error = p - text;
+	if (format->buf)
+		ast_str_truncate(*format->buf, start);
+	return -1;
+}
+
+static int json_tree_limits(struct ast_json *value, int depth, struct json_format *format) {
+// applies the depth and elements limits of format to a tree, counting the way json_scan_format
+//   does; returns -1, with format->limited set, if it goes over one
+	if (format->max_elements && (++format->elements > format->max_elements)) {
+		format->limited = "elements";
+		return -1;
+	}
+	enum ast_json_type type = ast_json_typeof(value);
+	if ((type != AST_JSON_OBJECT) && (type != AST_JSON_ARRAY))
+		return 0;
+	if (format->max_depth && (depth >= format->max_depth)) {
+		format->limited = "depth";
+		return -1;
+	}
+	if (type == AST_JSON_ARRAY) {
+		size_t i, count = ast_json_array_size(value);
+		for (i = 0; i < count; i++)
+			if (json_tree_limits(ast_json_array_get(value, i), depth + 1, format))
+				return -1;
+		return 0;
+	}
+	struct ast_json_iter *iter;
+	for (iter = ast_json_object_iter(value); iter; iter = ast_json_object_iter_next(value, iter))
+		if (json_tree_limits(ast_json_object_iter_value(iter), depth + 1, format))
+			return -1;
+	return 0;
+}
+
+static int json_doc_format(struct ast_channel *chan, const char *varname, int pretty,
+	struct ast_str **buf, ssize_t buflen
+) {
+// appends the document in varname to buf, pretty printed or minified. a tree the text would be
+//   parsed into anyway - a handle, a cached or a dirty document - is dumped, the text is
+//   reformatted otherwise; it is parsed only if the scanner cannot vouch for it, so a document
+//   the parser takes is never turned down. returns the JSONRESULT code
+	struct ast_json *doc = NULL;
+	if (json_handle_id(varname))
+		doc = json_doc_get(chan, varname);
+	else {
+		const char *source = S_OR(pbx_builtin_getvar_helper(chan, varname), "");
+		size_t len = strlen(source);
+		uint64_t hash = json_fingerprint(source, len);
+		if (!(doc = json_cache_lookup(chan, varname, len, hash, NULL, NULL))) {
+			const struct json_limits *limits = &json_config_current()->limits;
+			if (limits->size && (len > limits->size)) {
+				json_limits_hit("size");
+				return ASTJSON_LIMIT;
+			}
+			size_t start = ast_str_strlen(*buf);
+			struct json_format format = { .buf = buf, .buflen = buflen,
+				.indent = pretty ? JSON_FORMAT_INDENT : 0, .max_depth = limits->depth,
+				.max_elements = limits->elements, .max_output = limits->output };
+			int ret = json_scan_format(source, len, &format);
+			struct json_stats_call *call = json_stats_current();
+			if (!ret) {
+				if (call) {
+					call->parsed += len;
+					call->serialized += ast_str_strlen(*buf) - start;
+				}
+				return ASTJSON_OK;
+			}
+			if (format.limited) {
+				json_limits_hit(format.limited);
+				return ASTJSON_LIMIT;
+			}
+			// the scanner stopped short of the end: the parser counts the text, and holds what
+			//   it was not shown to the limits
+			doc = json_doc_load(chan, varname, source, len, hash, 0);
+		}
+	}
+	if (!doc)
+		return ASTJSON_PARSE_ERROR;
+	int ret = json_dump_str(doc, pretty ? AST_JSON_PRETTY : 0, buf, buflen);
+	ast_json_unref(doc);
+	return ret ? ASTJSON_LIMIT : ASTJSON_OK;
+}
+
+static int json_limits_check(const char *source, size_t len) {
+// checks a document against the limits before it is parsed, with a scan that allocates nothing,
+//   so that a hostile document never gets as far as the parser. returns -1, making the current
+//   call fail with ASTJSON_LIMIT, if it goes over one; 1 if the scan stopped short of the end
+//   (text the parser may turn down, or take), and the tree has to be checked after parsing
+	const struct json_limits *limits = &json_config_current()->limits;
+	if (limits->size && (len > limits->size)) {
+		json_limits_hit("size");
+		return -1;
+	}
+	if (!limits->depth && !limits->elements)
+		return 0;
+	struct json_format format = { .max_depth = limits->depth, .max_elements = limits->elements };
+	if (!json_scan_format(source, len, &format))
+		return 0;
+	if (format.limited) {
+		json_limits_hit(format.limited);
+		return -1;
+	}
+	return 1;
+}
+
+static int json_limits_tree(struct ast_json *doc) {
+// holds a tree parsed from text the scan could not settle to the depth and elements limits;
+//   returns -1, making the current call fail with ASTJSON_LIMIT, if it goes over one
+	const struct json_limits *limits = &json_config_current()->limits;
+	struct json_format format = { .max_depth = limits->depth, .max_elements = limits->elements };
+	if (json_tree_limits(doc, 0, &format)) {
+		json_limits_hit(format.limited);
+		return -1;
+	}
+	return 0;
+}
+
+static int json_scan_get(struct ast_channel *chan, const char *varname, const char *pathstring,
+	struct ast_str **buf, ssize_t buflen, struct ast_json **doc
+) {
+// reads the element at a single path for JSONGET, from the text when the document was not met
+//   before, or from the tree otherwise: a document read a second time is worth parsing and keeping
+//   in the cache. returns the JSONRESULT code, or -1 with *doc set to the (possibly NULL) tree if
+//   the caller should carry on with the tree
+	*doc = NULL;
+	const char *source = S_OR(pbx_builtin_getvar_helper(chan, varname), "");
+	size_t len = strlen(source);
+	uint64_t hash = json_fingerprint(source, len);
+	int seen;
+	if ((*doc = json_cache_lookup(chan, varname, len, hash, &seen, NULL)) || seen) {
+		if (!*doc)
+			*doc = json_doc_load(chan, varname, source, len, hash, 0);
+		return -1;
+	}
+
+	const struct json_limits *limits = &json_config_current()->limits;
+	if (limits->size && (len > limits->size)) {
+		json_limits_hit("size");
+		return ASTJSON_LIMIT;
+	}
+	struct json_scan_value value;
+	struct json_path *path = json_path_get(pathstring);
+	int ret = path ? json_scan_doc(source, len, path, limits, &value) : JSON_SCAN_GIVE_UP;
+	ao2_cleanup(path);
+	if (ret == JSON_SCAN_LIMIT) {
+		json_limits_hit(value.limited);
+		return ASTJSON_LIMIT;
+	}
+	if ((ret == JSON_SCAN_GIVE_UP) || (ret == JSON_SCAN_VALID)) {
+		*doc = json_doc_load(chan, varname, source, len, hash, ret == JSON_SCAN_VALID);
+		return -1;
+	}
+	struct json_stats_call *call = json_stats_current();
+	if (call)
+		call->parsed += len;
+	json_cache_store(chan, varname, NULL, len, hash, 0);
+	if (ret == JSON_SCAN_NOTFOUND)
+		return ASTJSON_NOTFOUND;
+
+	char number[JSON_SCAN_MAX_NUMBER];
+	const char *type = NULL;
+	switch (value.type) {
+	case AST_JSON_FALSE:
+	case AST_JSON_TRUE:
+		type = "bool";
+		ast_str_append(buf, buflen, "%s", (value.type == AST_JSON_TRUE) ? "1" : "0");
+		break;
+	case AST_JSON_NULL:
+		type = "null";
+		break;
+	case AST_JSON_INTEGER:
+	case AST_JSON_REAL:
+		type = "number";
+		memcpy(number, value.start, value.end - value.start);
+		number[value.end - value.start] = 0;
+		if (value.type == AST_JSON_REAL)
+			len = json_format_real(strtod(number, NULL), number);
+		else
+			len = json_format_int(strtoll(number, NULL, 10), number);
+		ast_str_append_substr(buf, buflen, number, len);
+		break;
+	case AST_JSON_STRING:
+		type = "string";
+		json_scan_unescape(value.start, value.end, buf, buflen);
+		break;
+	default:
+		break;
+	}
+	pbx_builtin_setvar_helper(chan, "JSONTYPE", type);
+	return ASTJSON_OK;
+}
+
+// templates render json text out of dialplan variables in one pass, instead of building a document
+//   with a series of JsonAdd: a template (from res_json.conf) is json with ${VAR} placeholders,
+//   compiled once into runs of static text - minified - and slots. a slot inside a json string
+//   gets the value escaped into the string; a slot on its own gets it as a json value. templates
+//   are immutable: loading them again builds new ones and swaps them in
+#define JSON_TEMPLATE_BUCKETS  17
+#define JSON_TEMPLATE_SLOT     16        // guess of the average length of a slot value
+
+enum json_template_type {
+	JSON_TEMPLATE_TEXT,                   // static json text
+	JSON_TEMPLATE_STRING,                 // a value escaped inside a json string
+	JSON_TEMPLATE_VALUE,                  // a value rendered as a json value of its own
+};
+
+struct json_template_op {
+	enum json_template_type type;
+	int expression;                       // a slot with a dialplan expression, not a variable name
+	size_t offset;                        // of the text, or the variable name, in the template text
+	size_t len;
+};
+
+struct json_template {
+	struct json_template_op *ops;
+	unsigned int count;
+	unsigned int slots;
+	size_t fixed;                         // bytes of static text rendered
+	char *text;                           // the static runs and the slot names
+	const char *source;                   // the file the template was read from, or "inline"
+	char name[0];
+};
+
+AO2_STRING_FIELD_HASH_FN(json_template, name)
+AO2_STRING_FIELD_CMP_FN(json_template, name)
+
+static void json_template_destroy(void *obj) {
+	struct json_template *template = obj;
+	ast_free(template->ops);
+	ast_free(template->text);
+}
+
+static void json_template_emit(struct json_template *template, char **out, char c) {
+// appends one character of static text to the template, growing its last run if it can
+	struct json_template_op *last = template->count ? &template->ops[template->count - 1] : NULL;
+	if (!last || (last->type != JSON_TEMPLATE_TEXT) || (last->offset + last->len != *out - template->text)) {
+		last = &template->ops[template->count++];
+		last->type = JSON_TEMPLATE_TEXT;
+		last->expression = 0;
+		last->offset = *out - template->text;
+		last->len = 0;
+	}
+	*(*out)++ = c;
+	last->len++;
+	template->fixed++;
+}
+
+static struct json_template *json_template_compile(const char *name, const char *source,
+	const char *text, size_t len
+) {
+// compiles the text of a template: whitespace out of strings is dropped, ${...} becomes a slot.
+//   the template is checked by parsing it with its slots filled in; returns NULL if it is invalid
+	const char *p = text, *end = text + len, *q;
+	unsigned int placeholders = 0;
+	for (q = text; (q = memmem(q, end - q, "${", 2)); q += 2)
+		placeholders++;
+	struct json_template *template = ao2_alloc_options(sizeof(*template) + strlen(name) + 1 +
+		strlen(source) + 1, json_template_destroy, AO2_ALLOC_OPT_LOCK_NOLOCK);
+	char *check = ast_malloc(len + 1);
+	if (!template || !check ||
+		!(template->ops = ast_calloc(2 * placeholders + 1, sizeof(*template->ops))) ||
+		!(template->text = ast_malloc(len + placeholders + 1))
+	) {
+		ao2_cleanup(template);
+		ast_free(check);
+		return NULL;
+	}
+	strcpy(template->name, name);
+	template->source = strcpy(template->name + strlen(name) + 1, source);
+
+	char *out = template->text, *checked = check;
+	int instring = 0;
+	while (p < end) {
+		if ((*p == '$') && (p + 1 < end) && (p[1] == '{')) {
+			// a slot, up to the matching brace
+			int depth = 1, plain = 1;
+			for (q = p + 2; (q < end) && depth; q++) {
+				if (*q == '{')
+					depth++;
+				else if (*q == '}')
+					depth--;
+				if (depth && !isalnum((unsigned char)*q) && (*q != '_'))
+					plain = 0;
+			}
+			if (depth || (q == p + 3)) {
+				ast_log(LOG_WARNING, "json template %s: invalid placeholder at offset %zu\n", name,
+					(size_t)(p - text));
+				break;
+			}
+			struct json_template_op *op = &template->ops[template->count++];
+			op->type = instring ? JSON_TEMPLATE_STRING : JSON_TEMPLATE_VALUE;
+			op->expression = !plain;
+			op->offset = out - template->text;
+			op->len = plain ? q - p - 3 : q - p;
+			memcpy(out, plain ? p + 2 : p, op->len);
+			out += op->len;
+			*out++ = 0;
+			template->slots++;
+			if (!instring)
+				*checked++ = '0';
+			p = q;
+			continue;
+		}
+		if (instring) {
+			if ((*p == '\\') && (p + 1 < end)) {
+				*checked++ = *p;
+				json_template_emit(template, &out, *p++);
+			} else if (*p == '"')
+				instring = 0;
+		} else if ((*p == ' ') || (*p == '\t') || (*p == '\n') || (*p == '\r')) {
+			p++;
+			continue;
+		} else if (*p == '"')
+			instring = 1;
+		*checked++ = *p;
+		json_template_emit(template, &out, *p++);
+	}
+	struct ast_json_error error;
+	struct ast_json *doc = (p == end) ? ast_json_load_buf(check, checked - check, &error) : NULL;
+	if ((p == end) && !doc)
+		ast_log(LOG_WARNING, "json template %s is not valid json: %s at offset %d\n", name, error.text,
+			error.position);
+	ast_json_unref(doc);
+	ast_free(check);
+	if (!doc) {
+		ao2_ref(template, -1);
+		return NULL;
+	}
+	return template;
+}
+
+static void json_config_path(const char *name, char *filename, size_t size) {
+// the full name of a file named in res_json.conf, relative to the configuration directory
+	if (*name == '/')
+		ast_copy_string(filename, name, size);
+	else
+		snprintf(filename, size, "%s/%s", ast_config_AST_CONFIG_DIR, name);
+}
+
+static int json_template_load(struct ao2_container *templates, const char *name, const char *value) {
+// compiles a template from res_json.conf into templates: the value is either the json text of
+//   the template or the name of a file holding it (relative to the configuration directory)
+	struct json_template *template;
+	value = ast_skip_blanks(value);
+	if ((*value == '{') || (*value == '['))
+		template = json_template_compile(name, "inline", value, strlen(value));
+	else {
+		char filename[PATH_MAX];
+		json_config_path(value, filename, sizeof(filename));
+		int fd = open(filename, O_RDONLY | O_CLOEXEC);
+		struct stat st;
+		if ((fd < 0) || fstat(fd, &st) || !S_ISREG(st.st_mode) || (st.st_size == 0)) {
+			ast_log(LOG_WARNING, "cannot read json template %s from %s\n", name, filename);
+			if (fd >= 0)
+				close(fd);
+			return -1;
+		}
+		void *text = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		close(fd);
+		if (text == MAP_FAILED) {
+			ast_log(LOG_WARNING, "cannot map json template file %s: %s\n", filename, strerror(errno));
+			return -1;
+		}
+		template = json_template_compile(name, filename, text, st.st_size);
+		munmap(text, st.st_size);
+	}
+	if (!template)
+		return -1;
+	ao2_link(templates, template);
+	ao2_ref(template, -1);
+	return 0;
+}
+
+static void json_template_escape(struct ast_str **buf, ssize_t buflen, const char *value) {
+// appends value to buf as the inside of a json string: the runs that need no escaping are copied
+//   as they are; quotes, backslashes and control characters are escaped, and bytes that are not
+//   valid utf-8 become U+FFFD
+	const unsigned char *p = (const unsigned char *)value, *run = p, *end = p + strlen(value);
+	while (p < end) {
+		if ((*p >= 0x20) && (*p != '"') && (*p != '\\') && (*p < 0x80)) {
+			p++;
+			continue;
+		}
+		int len = (*p >= 0x80) ? json_scan_utf8(p, end) : 0;
+		if (len) {
+			p += len;
+			continue;
+		}
+		if (p > run)
+			ast_str_append_substr(buf, buflen, (const char *)run, p - run);
+		switch (*p) {
+		case '"':  ast_str_append_substr(buf, buflen, "\\\"", 2); break;
+		case '\\': ast_str_append_substr(buf, buflen, "\\\\", 2); break;
+		case '\n': ast_str_append_substr(buf, buflen, "\\n", 2); break;
+		case '\r': ast_str_append_substr(buf, buflen, "\\r", 2); break;
+		case '\t': ast_str_append_substr(buf, buflen, "\\t", 2); break;
+		case '\b': ast_str_append_substr(buf, buflen, "\\b", 2); break;
+		case '\f': ast_str_append_substr(buf, buflen, "\\f", 2); break;
+		default:
+			if (*p < 0x20)
+				ast_str_append(buf, buflen, "\\u%04x", *p);
+			else
+				ast_str_append_substr(buf, buflen, "\\ufffd", 6);
+			break;
+		}
+		run = ++p;
+	}
+	if (p > run)
+		ast_str_append_substr(buf, buflen, (const char *)run, p - run);
+}
+
+static void json_template_value(struct ast_str **buf, ssize_t buflen, const char *value) {
+// appends value to buf as a json value of its own: a json number, true, false and null go as they
+//   are, an empty value becomes null, anything else a string
+	size_t len = strlen(value);
+	const char *end;
+	int is_real;
+	if (!len)
+		ast_str_append_substr(buf, buflen, "null", 4);
+	else if (!strcmp(value, "true") || !strcmp(value, "false") || !strcmp(value, "null") ||
+		((end = json_scan_number(value, value + len, &is_real)) && (end == value + len))
+	)
+		ast_str_append_substr(buf, buflen, value, len);
+	else {
+		ast_str_append_substr(buf, buflen, "\"", 1);
+		json_template_escape(buf, buflen, value);
+		ast_str_append_substr(buf, buflen, "\"", 1);
+	}
+}
+
+static int json_template_render(struct ast_channel *chan, const struct json_template *template,
+	struct ast_str **buf, ssize_t buflen
+) {
+// renders a template into buf: the static runs are copied, the slots filled with the values of
+//   their variables (or expressions) on the channel
+	struct ast_str *expanded = NULL;
+	unsigned int i;
+	ast_str_make_space(buf, template->fixed + template->slots * JSON_TEMPLATE_SLOT + 1);
+	for (i = 0; i < template->count; i++) {
+		const struct json_template_op *op = &template->ops[i];
+		const char *text = template->text + op->offset, *value;
+		if (op->type == JSON_TEMPLATE_TEXT) {
+			ast_str_append_substr(buf, buflen, text, op->len);
+			continue;
+		}
+		if (op->expression) {
+			if (!expanded && !(expanded = ast_str_create(JSON_TEMPLATE_SLOT * 4)))
+				return ASTJSON_UNDECIDED;
+			// the expression may call the functions of this module, which count themselves in the
+			//   same thread storage as this call
+			struct json_stats_call *call = json_stats_current(), saved;
+			if (call)
+				saved = *call;
+			ast_str_reset(expanded);
+			ast_str_substitute_variables(&expanded, 0, chan, text);
+			if (call)
+				*call = saved;
+			value = ast_str_buffer(expanded);
+		} else
+			value = S_OR(pbx_builtin_getvar_helper(chan, text), "");
+		if (op->type == JSON_TEMPLATE_STRING)
+			json_template_escape(buf, buflen, value);
+		else
+			json_template_value(buf, buflen, value);
+	}
+	ast_free(expanded);
+	return ASTJSON_OK;
+}
+
+static char *handle_cli_json_show_cache(struct ast_cli_entry *e, int cmd, struct ast_cli_args *a) {
+	switch (cmd) {
+	case CLI_INIT:
+		e->command = "json show cache";
+		e->usage =
+			"Usage: json show cache\n"
+			"       Shows the size and the hit rate of the compiled path cache.\n";
+		return NULL;
+	case CLI_GENERATE:
+		return NULL;
+	}
+	if (a->argc != 3)
+		return CLI_SHOWUSAGE;
+
+	ast_mutex_lock(&path_cache_lock);
+	int count = path_cache_count;
+	unsigned int hits = path_cache_hits, misses = path_cache_misses;
+	ast_mutex_unlock(&path_cache_lock);
+	struct json_config *config = ao2_global_obj_ref(json_config_holder);
+	ast_cli(a->fd, "compiled paths: %d (max %u)\n", count,
+		config ? config->path_cache : json_config_defaults.path_cache);
+	ao2_cleanup(config);
+	ast_cli(a->fd, "hits: %u, misses: %u\n", hits, misses);
+	return CLI_SUCCESS;
+}
+
+static char *handle_cli_json_show_stats(struct ast_cli_entry *e, int cmd, struct ast_cli_args *a) {
+	switch (cmd) {
+	case CLI_INIT:
+		e->command = "json show stats";
+		e->usage =
+			"Usage: json show stats\n"
+			"       Shows how many times each json function and app was called, the result\n"
+			"       codes they set, how much json text they read and generated and how long\n"
+			"       the calls took.\n";
+		return NULL;
+	case CLI_GENERATE:
+		return NULL;
+	}
+	if (a->argc != 3)
+		return CLI_SHOWUSAGE;
+
+	int i, j;
+	ast_cli(a->fd, "%-14s %10s %10s %14s %14s %10s\n",
+		"name", "calls", "errors", "bytes parsed", "bytes written", "avg usecs");
+	for (i = 0; i < JSON_STATS_COUNT; i++) {
+		struct json_stats *stats = &json_stats[i];
+		unsigned int calls = __atomic_load_n(&stats->calls, __ATOMIC_RELAXED);
+		unsigned int ok = __atomic_load_n(&stats->results[ASTJSON_OK], __ATOMIC_RELAXED);
+		ast_cli(a->fd, "%-14s %10u %10u %14" PRIu64 " %14" PRIu64 " %10" PRIu64 "\n",
+			stats->name, calls, (calls > ok) ? calls - ok : 0,
+			__atomic_load_n(&stats->parsed, __ATOMIC_RELAXED),
+			__atomic_load_n(&stats->serialized, __ATOMIC_RELAXED),
+			calls ? __atomic_load_n(&stats->usecs, __ATOMIC_RELAXED) / calls : 0);
+	}
+	for (i = 0; i < JSON_STATS_COUNT; i++) {
+		struct json_stats *stats = &json_stats[i];
+		if (!__atomic_load_n(&stats->calls, __ATOMIC_RELAXED))
+			continue;
+		ast_cli(a->fd, "\n%s\n  results:", stats->name);
+		for (j = 0; j < ASTJSON_RESULTS; j++) {
+			unsigned int count = __atomic_load_n(&stats->results[j], __ATOMIC_RELAXED);
+			if (count)
+				ast_cli(a->fd, " %s(%d) %u", json_result_names[j], j, count);
+		}
+		ast_cli(a->fd, "\n  usecs:  ");
+		for (j = 0; j < JSON_STATS_BUCKETS; j++) {
+			unsigned int count = __atomic_load_n(&stats->latency[j], __ATOMIC_RELAXED);
+			if (j < JSON_STATS_BUCKETS - 1)
+				ast_cli(a->fd, " <%u: %u", json_stats_bounds[j], count);
+			else
+				ast_cli(a->fd, " more: %u", count);
+		}
+		ast_cli(a->fd, "\n");
+	}
+	return CLI_SUCCESS;
+}
+
+static char *handle_cli_json_reset_stats(struct ast_cli_entry *e, int cmd, struct ast_cli_args *a) {
+	switch (cmd) {
+	case CLI_INIT:
+		e->command = "json reset stats";
+		e->usage =
+			"Usage: json reset stats\n"
+			"       Sets all the json function and app statistics back to zero.\n";
+		return NULL;
+	case CLI_GENERATE:
+		return NULL;
+	}
+	if (a->argc != 3)
+		return CLI_SHOWUSAGE;
+
+	json_stats_reset();
+	ast_cli(a->fd, "json statistics reset\n");
+	return CLI_SUCCESS;
+}
+
+static char *handle_cli_json_show_shared(struct ast_cli_entry *e, int cmd, struct ast_cli_args *a) {
+	switch (cmd) {
+	case CLI_INIT:
+		e->command = "json show shared";
+		e->usage =
+			"Usage: json show shared\n"
+			"       Lists the json documents published with JSON_SHARED.\n";
+		return NULL;
+	case CLI_GENERATE:
+		return NULL;
+	}
+	if (a->argc != 3)
+		return CLI_SHOWUSAGE;
+
+	struct ao2_iterator i = ao2_iterator_init(json_shared_docs, 0);
+	struct json_shared *shared;
+	struct timeval now = ast_tvnow();
+	ast_cli(a->fd, "%-30s %10s %12s %12s\n", "name", "version", "bytes", "age (secs)");
+	while ((shared = ao2_iterator_next(&i))) {
+		ast_cli(a->fd, "%-30s %10u %12zu %12" PRId64 "\n", shared->name, shared->version,
+			shared->size, ast_tvdiff_sec(now, shared->published));
+		ao2_ref(shared, -1);
+	}
+	ao2_iterator_destroy(&i);
+	ast_cli(a->fd, "%d shared documents\n", ao2_container_count(json_shared_docs));
+	return CLI_SUCCESS;
+}
+
+static char *handle_cli_json_show_indexes(struct ast_cli_entry *e, int cmd, struct ast_cli_args *a) {
+	switch (cmd) {
+	case CLI_INIT:
+		e->command = "json show indexes";
+		e->usage =
+			"Usage: json show indexes\n"
+			"       Lists the indexes built with JSON_INDEX_CREATE over shared json documents.\n";
+		return NULL;
+	case CLI_GENERATE:
+		return NULL;
+	}
+	if (a->argc != 3)
+		return CLI_SHOWUSAGE;
+
+	struct ao2_iterator i = ao2_iterator_init(json_indexes, 0);
+	struct json_index *index;
+	ast_cli(a->fd, "%-20s %-30s %-16s %-16s %8s %10s %10s %10s %11s\n", "name", "document", "array",
+		"key", "version", "elements", "duplicates", "skipped", "build usecs");
+	while ((index = ao2_iterator_next(&i))) {
+		ast_cli(a->fd, "%-20s %-30s %-16s %-16s %8u %10u %10u %10u %11" PRId64 "\n", index->name,
+			index->doc, S_OR(index->arraypath, "/"), index->keyfield, index->shared->version, index->count,
+			index->duplicates, index->skipped, index->usecs);
+		ao2_ref(index, -1);
+	}
+	ao2_iterator_destroy(&i);
+	ast_cli(a->fd, "%d indexes\n", ao2_container_count(json_indexes));
+	return CLI_SUCCESS;
+}
+
+static char *handle_cli_json_show_sets(struct ast_cli_entry *e, int cmd, struct ast_cli_args *a) {
+	switch (cmd) {
+	case CLI_INIT:
+		e->command = "json show sets";
+		e->usage =
+			"Usage: json show sets\n"
+			"       Lists the sets compiled for JSON_MEMBER, with their size, the memory they\n"
+			"       take and how long they took to build.\n";
+		return NULL;
+	case CLI_GENERATE:
+		return NULL;
+	}
+	if (a->argc != 3)
+		return CLI_SHOWUSAGE;
+
+	struct ao2_iterator i = ao2_iterator_init(json_sets, 0);
+	struct json_set *set;
+	ast_cli(a->fd, "%-30s %8s %10s %10s %10s %10s %6s %12s %11s\n", "name", "version", "packed",
+		"strings", "duplicates", "skipped", "bloom", "bytes", "build usecs");
+	while ((set = ao2_iterator_next(&i))) {
+		ast_cli(a->fd, "%-30s %8u %10u %10u %10u %10u %6s %12zu %11" PRId64 "\n", set->table,
+			set->source.shared->version, set->packed, set->unpacked, set->duplicates, set->skipped,
+			set->bloom ? "yes" : "no", set->memory, set->usecs);
+		ao2_ref(set, -1);
+	}
+	ao2_iterator_destroy(&i);
+	ast_cli(a->fd, "%d sets, looked up with %s\n", ao2_container_count(json_sets), json_set_isa);
+	return CLI_SUCCESS;
+}
+
+static char *handle_cli_json_show_templates(struct ast_cli_entry *e, int cmd, struct ast_cli_args *a) {
+	switch (cmd) {
+	case CLI_INIT:
+		e->command = "json show templates";
+		e->usage =
+			"Usage: json show templates\n"
+			"       Lists the templates loaded from res_json.conf, with the number of their\n"
+			"       slots and the bytes of static json text they render.\n";
+		return NULL;
+	case CLI_GENERATE:
+		return NULL;
+	}
+	if (a->argc != 3)
+		return CLI_SHOWUSAGE;
+
+	struct json_config *config = ao2_global_obj_ref(json_config_holder);
+	if (!config)
+		return CLI_FAILURE;
+	struct ao2_iterator i = ao2_iterator_init(config->templates, 0);
+	struct json_template *template;
+	ast_cli(a->fd, "%-30s %6s %6s %10s  %s\n", "name", "slots", "runs", "bytes", "source");
+	while ((template = ao2_iterator_next(&i))) {
+		ast_cli(a->fd, "%-30s %6u %6u %10zu  %s\n", template->name, template->slots,
+			template->count - template->slots, template->fixed, template->source);
+		ao2_ref(template, -1);
+	}
+	ao2_iterator_destroy(&i);
+	ast_cli(a->fd, "%d templates\n", ao2_container_count(config->templates));
+	ao2_ref(config, -1);
+	return CLI_SUCCESS;
+}
+
+static struct ast_cli_entry cli_json[] = {
+	AST_CLI_DEFINE(handle_cli_json_show_cache, "Show compiled path cache statistics"),
+	AST_CLI_DEFINE(handle_cli_json_show_stats, "Show json function and app statistics"),
+	AST_CLI_DEFINE(handle_cli_json_reset_stats, "Reset json function and app statistics"),
+	AST_CLI_DEFINE(handle_cli_json_show_shared, "List the shared json documents"),
+	AST_CLI_DEFINE(handle_cli_json_show_indexes, "List the indexes over shared json documents"),
+	AST_CLI_DEFINE(handle_cli_json_show_sets, "List the sets compiled from shared json documents"),
+	AST_CLI_DEFINE(handle_cli_json_show_templates, "List the json templates"),
+};
+
+static const char *json_value_str(struct ast_json *value, struct ast_str **buf, ssize_t buflen) {
+// appends the dialplan form of a json element to buf and returns its JSONTYPE: booleans are 1 or
+//   0, null is empty, arrays and objects are their (compact) json text
+	enum ast_json_type jtype = ast_json_typeof(value);
+	char number[JSON_NUMBER_MAX];
+	switch (jtype) {
+		case AST_JSON_FALSE:
+			ast_str_append(buf, buflen, "0");
+			return "bool";
+		case AST_JSON_TRUE:
+			ast_str_append(buf, buflen, "1");
+			return "bool";
+		case AST_JSON_NULL:
+			return "null";
+		case AST_JSON_REAL:
+			ast_str_append_substr(buf, buflen, number, json_format_real(ast_json_real_get(value), number));
+			return "number";
+		case AST_JSON_INTEGER:
+			ast_str_append_substr(buf, buflen, number, json_format_int(ast_json_integer_get(value), number));
+			return "number";
+		case AST_JSON_STRING:
+			ast_str_append(buf, buflen, "%s", ast_json_string_get(value));
+			return "string";
+		case AST_JSON_ARRAY:
+		case AST_JSON_OBJECT:
+			json_dump_str(value, 0, buf, buflen);
+			return (jtype == AST_JSON_ARRAY) ? "array" : "node";
+	}
+	return NULL;
+}
+
+static int json_get_paths(struct ast_channel *chan, struct ast_json *doc, char *pathlist,
+	struct ast_str **buf, ssize_t buflen
+) {
+// appends the elements at a comma separated list of paths in doc to buf, the way JSONGET returns
+//   them, and sets JSONTYPE to the type of the last one. doc is only ever read
+	int count = 1, i;
+	char *pathstring;
+	for (pathstring = pathlist; *pathstring; pathstring++)
+		if (*pathstring == ',')
+			count++;
+	struct json_path **paths = ast_calloc(count, sizeof(*paths) + sizeof(struct ast_json *));
+	if (!paths)
+		return ASTJSON_UNDECIDED;
+	struct ast_json **values = (struct ast_json **)&paths[count];
+	for (i = 0; (pathstring = strsep(&pathlist, ",")); i++)
+		paths[i] = json_path_get(pathstring);
+	if (count == 1)
+		values[0] = paths[0] ? json_path_walk(doc, paths[0], paths[0]->count) : NULL;
+	else
+		json_path_resolve_all(doc, paths, count, values);
+	for (i = 0; i < count; i++)
+		ao2_cleanup(paths[i]);
+
+	const char *type = NULL;
+	for (i = 0; i < count; i++) {
+		struct ast_json *thisobject = values[i];
+		if (!thisobject) {
+			ast_free(paths);
+			return ASTJSON_NOTFOUND;
+		}
+
+		if (i)
+			ast_str_append(buf, buflen, ",");
+
+		// got to the end of our path, evaluate the object type and set the value
+		type = json_value_str(thisobject, buf, buflen);
+	}
+	ast_free(paths);
+	pbx_builtin_setvar_helper(chan, "JSONTYPE", type);
+	return ASTJSON_OK;
+}
+
+static int jsonpretty_exec(struct ast_channel *chan, 
+	const char *cmd, char *parse, struct ast_str **buf, ssize_t buflen
+) {
+// nicely format the contents of a varable that contains json
+
+	ast_str_reset(*buf);
+
+	// parse the function arguments
+	AST_DECLARE_APP_ARGS(args,
+		AST_APP_ARG(json);
+	);
+	if (ast_strlen_zero(parse)) {
+		ast_log(LOG_WARNING, "jsonpretty requires arguments (json)\n");
+		json_set_operation_result(chan, ASTJSON_ARG_NEEDED);
+		return 0;
+	}
+	AST_STANDARD_APP_ARGS(args, parse);
+	if (ast_strlen_zero(args.json)) {
+		ast_log(LOG_WARNING, "a valid asterisk variable name is required\n");
+		json_set_operation_result(chan, ASTJSON_ARG_NEEDED);
+		return 0;
+	}
+	// reformat json
+	int res = json_doc_format(chan, args.json, 1, buf, buflen);
+	if (res == ASTJSON_PARSE_ERROR)
+		ast_log(LOG_WARNING, "source json parsing error\n");
+	json_set_operation_result(chan, res);
+	return 0;
+
+}
+
+static int jsoncompress_exec(struct ast_channel *chan, 
+	const char *cmd, char *parse, struct ast_str **buf, ssize_t buflen
+) {
+// return a json string by stripping the unneeded characters (smallest footprint)
+
+	ast_str_reset(*buf);
+
+	// parse the function arguments
+	AST_DECLARE_APP_ARGS(args,
+		AST_APP_ARG(json);
+	);
+	if (ast_strlen_zero(parse)) {
+		ast_log(LOG_WARNING, "jsoncompress requires arguments (json)\n");
+		json_set_operation_result(chan, ASTJSON_ARG_NEEDED);
+		return 0;
+	}
+	AST_STANDARD_APP_ARGS(args, parse);
+	if (ast_strlen_zero(args.json)) {
+		ast_log(LOG_WARNING, "a valid asterisk variable name is required\n");
+		json_set_operation_result(chan, ASTJSON_ARG_NEEDED);
+		return 0;
+	}
+	// reformat json
+	int res = json_doc_format(chan, args.json, 0, buf, buflen);
+	if (res == ASTJSON_PARSE_ERROR)
+		ast_log(LOG_WARNING, "source json parsing error\n");
+	json_set_operation_result(chan, res);
+	return 0;
+
+}
+
+static int jsonvalid_exec(struct ast_channel *chan, 
+	const char *cmd, char *parse, char *buffer, size_t buflen
+) {
+// returns 1 if a variable holds a valid json document (within the limits given), 0 if not
+
+	json_set_operation_result(chan, ASTJSON_UNDECIDED);
+	buffer[0] = 0;
+
+	// parse the function arguments
+	AST_DECLARE_APP_ARGS(args,
+		AST_APP_ARG(json);
+		AST_APP_ARG(depth);
+		AST_APP_ARG(size);
+		AST_APP_ARG(elements);
+	);
+	if (ast_strlen_zero(parse)) {
+		ast_log(LOG_WARNING, "jsonvalid requires arguments (json[,depth[,size[,elements]]])\n");
+		json_set_operation_result(chan, ASTJSON_ARG_NEEDED);
+		return 0;
+	}
+	AST_STANDARD_APP_ARGS(args, parse);
+	if (ast_strlen_zero(args.json)) {
+		ast_log(LOG_WARNING, "a valid asterisk variable name is required\n");
+		json_set_operation_result(chan, ASTJSON_ARG_NEEDED);
+		return 0;
+	}
+	// the limits of res_json.conf, unless others are given
+	const struct json_config *config = json_config_current();
+	struct json_format format = { .max_depth = config->limits.depth,
+		.max_elements = config->limits.elements };
+	size_t size = config->limits.size, depth = format.max_depth;
+	if ((!ast_strlen_zero(args.depth) && json_parse_count(args.depth, &depth)) ||
+		(!ast_strlen_zero(args.size) && json_parse_count(args.size, &size)) ||
+		(!ast_strlen_zero(args.elements) && json_parse_count(args.elements, &format.max_elements))
+	) {
+		ast_log(LOG_WARNING, "the limits must be whole numbers (0 for no limit)\n");
+		json_set_operation_result(chan, ASTJSON_INVALID_TYPE);
+		return 0;
+	}
+	// the parser does not go deeper than the scanner anyway
+	format.max_depth = (depth < JSON_SCAN_MAX_DEPTH) ? depth : 0;
+
+	int valid = 0, dirty = 0;
+	unsigned int id = json_handle_id(args.json);
+	struct ast_json *doc = NULL;
+	const char *source = S_OR(pbx_builtin_getvar_helper(chan, args.json), "");
+	size_t len = strlen(source);
+	if (!id && config->writeback_lazy)
+		doc = json_cache_lookup(chan, args.json, len, json_fingerprint(source, len), NULL, &dirty);
+	if (id || dirty) {
+		// an open document, or a changed one not written back yet, was parsed already: it is
+		//   checked as a tree, against the size of its text
+		if (id)
+			json_handle_get(chan, id, &doc);
+		valid = doc && !json_tree_limits(doc, 0, &format);
+		if (valid && size) {
+			char *text = ast_json_dump_string_format(doc, AST_JSON_COMPACT);
+			valid = text && (strlen(text) <= size);
+			ast_json_free(text);
+		}
+		format.error = 0;
+	} else {
+		if (size && (len > size)) {
+			valid = 0;
+			format.error = size;
+		} else
+			valid = !json_scan_format(source, len, &format);
+		// the scanner gives up on numbers too long to be sure of, and on text nested deeper than
+		//   it follows: the parser has the last word, and the tree is held to the limits
+		if (!valid && !format.limited && (format.error < len) && (format.deep ||
+			(source[format.error] == '-') || isdigit((unsigned char)source[format.error]))) {
+			struct ast_json *parsed = ast_json_load_string(source, NULL);
+			format.elements = 0;
+			valid = parsed && !json_tree_limits(parsed, 0, &format);
+			ast_json_unref(parsed);
+		}
+		struct json_stats_call *call = json_stats_current();
+		if (call)
+			call->parsed += len;
+	}
+	ast_json_unref(doc);
+	if (valid)
+		pbx_builtin_setvar_helper(chan, "JSONERROROFFSET", NULL);
+	else {
+		char offset[JSON_NUMBER_MAX];
+		offset[json_format_int(format.error, offset)] = 0;
+		pbx_builtin_setvar_helper(chan, "JSONERROROFFSET", offset);
+	}
+	ast_copy_string(buffer, valid ? "1" : "0", buflen);
+	json_set_operation_result(chan, ASTJSON_OK);
+	return 0;
+
+}
+
+static int jsonget_exec(struct ast_channel *chan, 
+	const char *cmd, char *parse, struct ast_str **buf, ssize_t buflen
+) {
+// searches for a json element found based on a path (like "/path/to/element/3/value")  
+//   and populates the element value and type with the contents of the element
+
+	json_set_operation_result(chan, ASTJSON_UNDECIDED);
+	ast_str_reset(*buf);
+
+	// parse the function arguments
+	AST_DECLARE_APP_ARGS(args,
+		AST_APP_ARG(json);
+		AST_APP_ARG(path);
+	);
+	if (ast_strlen_zero(parse)) {
+		ast_log(LOG_WARNING, "jsonget requires arguments (json,path)\n");
+		json_set_operation_result(chan, ASTJSON_ARG_NEEDED);
+		return 0;
+	}
+	AST_STANDARD_APP_ARGS(args, parse);
+	if (ast_strlen_zero(args.json)) {
+		ast_log(LOG_WARNING, "a valid asterisk variable name is required\n");
+		json_set_operation_result(chan, ASTJSON_ARG_NEEDED);
+		return 0;
+	}
+	if (ast_strlen_zero(args.path)) {
+		ast_log(LOG_WARNING, "path is empty, returning full json\n");
+		ast_str_set(buf, buflen, "%s", args.json);
+		json_set_operation_result(chan, ASTJSON_OK);
+		return 0;
+	}
+	// parse json; a single path may not need the tree at all
+	struct ast_json *doc;
+	if (!strchr(args.path, ',') && !json_handle_id(args.json)) {
+		int ret = json_scan_get(chan, args.json, args.path, buf, buflen, &doc);
+		if (ret >= 0) {
+			json_set_operation_result(chan, ret);
+			return 0;
+		}
+	} else
+		doc = json_doc_get(chan, args.json);
+	if (!doc) {
+		ast_log(LOG_WARNING, "source json parsing error\n");
+		json_set_operation_result(chan, ASTJSON_PARSE_ERROR);
+		return 0;
+	}
+
+	int ret = json_get_paths(chan, doc, args.path, buf, buflen);
+	ast_json_unref(doc);
+	json_set_operation_result(chan, ret);
+	return 0;
+
+}
+
+static int jsonvariables_exec(struct ast_channel *chan, const char *data) {
+// considers that the json string offered as input is a list of key-value pairs; associates each
+//   key with an asterisk variable name, and sets the value for it
+// depending on the type of the json variable, the values are:
+//   True, False: 1, 0
+//   NULL: '' (resulting variable contains an empty string)
+//   Number, String: the number or the string
+//   Array: !array! (literal)
+//   Object: string, the json representation of the underlying object
+// note that this is mainly intended for simple key-value lists; if you have variables that are 
+//   arrays or objects, things may get screwed up because of the separators and braces...
+
+	json_set_operation_result(chan, ASTJSON_UNDECIDED);
+
+	// parse the app arguments
+	char *argcopy;
+	AST_DECLARE_APP_ARGS(args,
+		AST_APP_ARG(json);
+	);
+	if (ast_strlen_zero(data)) {
+		ast_log(LOG_WARNING, "jsonvariables requires arguments (jsonsource)\n");
+		json_set_operation_result(chan, ASTJSON_ARG_NEEDED);
+		return 0;
+	}
+	argcopy = ast_strdupa(data);
+	AST_STANDARD_APP_ARGS(args, argcopy);
+	if (ast_strlen_zero(args.json)) {
+		ast_log(LOG_WARNING, "json string is empty\n");
+		json_set_operation_result(chan, ASTJSON_ARG_NEEDED);
+		return 0;
+	}
+	// parse json
+	struct ast_json *doc = json_doc_get(chan, args.json);
+	if (!doc) {
+		ast_log(LOG_WARNING, "source json parsing error\n");
+		json_set_operation_result(chan, ASTJSON_PARSE_ERROR);
+		return 0;
+	}
+	// for each element
+	struct ast_json_iter *doc_iter;
+	char num[JSON_NUMBER_MAX]; const char *eljson = NULL;
+
+	doc_iter = ast_json_object_iter(doc);
+	if (doc_iter == NULL)
+		goto out;
+
+	while (doc_iter) {
+		const char *nvp_key;
+		struct ast_json *nvp;
+		enum ast_json_type type;
+
+		nvp_key = ast_json_object_iter_key(doc_iter);
+		nvp = ast_json_object_iter_value(doc_iter);
+		type = ast_json_typeof(nvp);
+
+		switch (type) {
+			case AST_JSON_FALSE: pbx_builtin_setvar_helper(chan, nvp_key, "0"); break;
+			case AST_JSON_TRUE: pbx_builtin_setvar_helper(chan, nvp_key, "1"); break;
+			case AST_JSON_NULL: pbx_builtin_setvar_helper(chan, nvp_key, ""); break;
+			case AST_JSON_REAL:
+			case AST_JSON_INTEGER:
+				if (type == AST_JSON_REAL)
+					json_format_real(ast_json_real_get(nvp), num);
+				else
+					json_format_int(ast_json_integer_get(nvp), num);
+				pbx_builtin_setvar_helper(chan, nvp_key, num);
+				break;
+			case AST_JSON_STRING: pbx_builtin_setvar_helper(chan, nvp_key, ast_json_string_get(nvp)); break;
+			case AST_JSON_ARRAY: pbx_builtin_setvar_helper(chan, nvp_key, "!array!"); break;
+			case AST_JSON_OBJECT:
+				eljson = json_dump(nvp, 0);
+				pbx_builtin_setvar_helper(chan, nvp_key, eljson);
+				break;
+			default:
+				break;
+		}
+		doc_iter = ast_json_object_iter_next(doc, doc_iter);
+	}
+out:
+	ast_json_unref(doc);
+	json_set_operation_result(chan, ASTJSON_OK);
+	return 0;
+
+}
+
+static struct ast_json *json_number_create(const char *value) {
+// creates a json number out of its text: an integer if the text is one that fits a json_int_t,
+//   a real otherwise; like with atof, anything that does not read as a number is 0
+	char *end;
+	value = S_OR(value, "");
+	errno = 0;
+	long long integer = strtoll(value, &end, 10);
+	if ((end != value) && !*end && !errno)
+		return ast_json_integer_create(integer);
+	double real = strtod(value, &end);
+	return (end != value) ? ast_json_real_create(real) : ast_json_integer_create(0);
+}
+
+static int json_element_create(const char *type, const char *value, struct ast_json **element) {
+// create a new element of the given type (bool, null, number, string, node or array) out of its
+//   string value; the value is ignored for null, node and array types
+	*element = NULL;
+	if (ast_strlen_zero(type)) {
+		ast_log(LOG_WARNING, "an element type is needed (bool, null, number, string, node or array)\n");
+		return ASTJSON_ARG_NEEDED;
+	}
+	if (strcasecmp(type, "bool") == 0)
+		*element = (
+			(value == 0) || (strlen(value) == 0) || 
+			(strcasecmp(value, "0") == 0) ||
+			(strcasecmp(value, "no") == 0) || (strcasecmp(value, "n") == 0) ||
+			(strcasecmp(value, "false") == 0) || (strcasecmp(value, "f") == 0) 
+		) ? ast_json_false() : ast_json_true();
+	else if (strcasecmp(type, "null") == 0)
+		*element = ast_json_null();
+	else if (strcasecmp(type, "number") == 0)
+		*element = json_number_create(value);
+	else if (strcasecmp(type, "string") == 0)
+		*element = ast_json_string_create(S_OR(value, ""));
+	else if (strcasecmp(type, "array") == 0)
+		*element = ast_json_array_create();
+	else if (strcasecmp(type, "node") == 0)
+		*element = ast_json_object_create();
+	else {
+		ast_log(LOG_WARNING, "invalid element type '%s'; need bool, null, number, string, node or array\n", type);
+		return ASTJSON_ARG_NEEDED;
+	}
+	return (*element) ? ASTJSON_OK : ASTJSON_ADD_FAILED;
+}
+
+static int json_add_element(struct ast_json *doc, const char *pathstring, const char *name,
+	struct ast_json *element
+) {
+// add element under the node at the end of the path (appended if that node is an array); a NULL
+//   path adds to the root. the element is always consumed
+	struct ast_json *thisobject = doc;
+	if (pathstring) {
+		struct json_path *path = json_path_get(pathstring);
+		thisobject = path ? json_path_walk(doc, path, path->count) : NULL;
+		ao2_cleanup(path);
+	}
+	if (!thisobject) {
+		// path element not found
+		ast_json_unref(element);
+		return ASTJSON_NOTFOUND;
+	}
+	// done going down the path, add object here
+	ast_log(LOG_DEBUG, "adding to type %d\n", ast_json_typeof(thisobject));
+	switch (ast_json_typeof(thisobject)) {
+	case AST_JSON_ARRAY:
+		if (ast_json_array_append(thisobject, element) == 0)
+			return ASTJSON_OK;
+		return ASTJSON_ADD_FAILED;
+	case AST_JSON_OBJECT:
+		if (ast_json_object_set(thisobject, name, element) == 0)
+			return ASTJSON_OK;
+		return ASTJSON_ADD_FAILED;
+	default:
+		ast_json_unref(element);
+		return ASTJSON_ADD_FAILED;
+	}
+}
+
+static int json_set_element(struct ast_json *doc, const char *pathstring, const char *value) {
+// replace the element at the path with a new one of the same type, built out of value
+	struct json_path *path = json_path_get(pathstring);
+	if (!path || (path->count == 0)) {
+		ast_log(LOG_WARNING, "invalid path to the object we want to set\n");
+		ao2_cleanup(path);
+		return ASTJSON_NOTFOUND;
+	}
+	int ret = ASTJSON_NOTFOUND;
+	struct json_path_segment *key = &path->segments[path->count - 1];
+	struct ast_json *thisobject = json_path_walk(doc, path, path->count - 1);
+	struct ast_json *nextobject = thisobject ? json_path_step(thisobject, key) : NULL;
+	if (nextobject) {
+		struct ast_json *newobject = NULL;
+		// done going down the path, this is the object we want to change the value for
+		switch (ast_json_typeof(nextobject)) {
+		case AST_JSON_FALSE:
+		case AST_JSON_TRUE:
+			newobject = (
+				(value == 0) || (strlen(value) == 0) || 
+				(strcasecmp(value, "0") == 0) ||
+				(strcasecmp(value, "no") == 0) || (strcasecmp(value, "n") == 0) ||
+				(strcasecmp(value, "false") == 0) || (strcasecmp(value, "f") == 0) 
+			) ? ast_json_false() : ast_json_true();
+			break;
+		case AST_JSON_NULL:
+			break;
+		case AST_JSON_REAL:
+		case AST_JSON_INTEGER:
+			newobject = json_number_create(value);
+			break;
+		case AST_JSON_STRING:
+			newobject = ast_json_string_create(S_OR(value, ""));
+			break;
+		case AST_JSON_ARRAY:
+			break;
+		case AST_JSON_OBJECT:
+			newobject = json_load(S_OR(value, ""), 0);
+			break;
+		default:
+			break;
+		}
+		if (newobject) {
+			// replace in the parent object with what we've just created here
+			ret = ASTJSON_OK;
+			if (key->is_index) {
+				if (ast_json_array_set(thisobject, key->index, newobject) != 0)
+					ret = ASTJSON_SET_FAILED;
+			} else {
+				if (ast_json_object_set(thisobject, key->key, newobject) != 0)
+					ret = ASTJSON_SET_FAILED;
+			}
+		} else
+			ret = ASTJSON_INVALID_TYPE;
+	}
+	ao2_ref(path, -1);
+	return ret;
+}
+
+static int json_delete_element(struct ast_json *doc, const char *pathstring) {
+// remove the element at the path from its parent; an empty path leaves the document alone
+	if (ast_strlen_zero(pathstring)) {
+		ast_log(LOG_WARNING, "path is empty, will not delete the whole doc\n");
+		return ASTJSON_OK;
+	}
+	int ret = ASTJSON_NOTFOUND;
+	struct json_path *path = json_path_get(pathstring);
+	if (path && path->count) {
+		struct json_path_segment *deleteitem = &path->segments[path->count - 1];
+		struct ast_json *thisobject = json_path_walk(doc, path, path->count - 1);
+		if (thisobject && json_path_step(thisobject, deleteitem)) {
+			// got to the end of our path, we need to delete the last item from 'thisobject'
+			ret = ASTJSON_DELETE_FAILED;
+			if (deleteitem->is_index) {
+				if (ast_json_array_remove(thisobject, deleteitem->index) == 0)
+					ret = ASTJSON_OK;
+			} else {
+				if (ast_json_object_del(thisobject, deleteitem->key) == 0)
+					ret = ASTJSON_OK;
+			}
+		}
+	}
+	ao2_cleanup(path);
+	return ret;
+}
+
+static int jsonadd_exec(struct ast_channel *chan, const char *data) {
+// add an element of a certain type into a json structure, at the path indicated
+// accepted types are bool, null, number, string or array
+// the value parameter is ignored for null and array types; boolean false are represented by an 
+//    empty string, 0, n, no, f or false (case insensitive) - anything else is considered true
+// if the element at the path is an array, append to the array (in this case the name is ignored)
+// rewrite the contents of the variable that contains the json doc and set an error code variable
+
+	json_set_operation_result(chan, ASTJSON_UNDECIDED);
+
+	// parse the app arguments
+	char *argcopy;
+	AST_DECLARE_APP_ARGS(args,
+		AST_APP_ARG(json);
+		AST_APP_ARG(path);
+		AST_APP_ARG(type);
+		AST_APP_ARG(name);
+		AST_APP_ARG(value);
+	);
+	if (ast_strlen_zero(data)) {
+		ast_log(LOG_WARNING, "jsonadd requires arguments (jsonvarname,path,type,name,value)\n");
+		json_set_operation_result(chan, ASTJSON_ARG_NEEDED);
+		return 0;
+	}
+	argcopy = ast_strdupa(data);
+	AST_STANDARD_APP_ARGS(args, argcopy);
+	if (!ast_strlen_zero(args.json))
+		ast_log(LOG_DEBUG, "getting json and setting result back into variable '%s'\n", args.json);
+	else {
+		ast_log(LOG_WARNING, "a valid dialplan variable name is needed as first argument\n");
+		json_set_operation_result(chan, ASTJSON_ARG_NEEDED);
+		return 0;
+	}
+	if (ast_strlen_zero(args.path))
+		ast_log(LOG_WARNING, "path is empty, adding element to the root\n");
+
+	// create the object to add
+	struct ast_json *newobject;
+	int ret = json_element_create(args.type, args.value, &newobject);
+	if (ret != ASTJSON_OK) {
+		json_set_operation_result(chan, ret);
+		return 0;
+	}
+	// parse document
+	struct ast_json *doc;
+	int live;
+	if (json_doc_edit(chan, args.json, &doc, &live) != ASTJSON_OK) {
+		ast_log(LOG_WARNING, "json document parsing error\n");
+		ast_json_unref(newobject);
+		json_set_operation_result(chan, ASTJSON_PARSE_ERROR);
+		return 0;
+	}
+	if (!doc) {
+		// variable containing document is missing or empty string, 
+		// it needs to be initialized as either {} or []
+		doc = (ast_strlen_zero(args.name)) ? ast_json_array_create() : ast_json_object_create();
+		ret = json_add_element(doc, NULL, args.name, newobject);
+	} else {
+		// go over the path (an empty path adds to the json root)
+		ret = json_add_element(doc, S_OR(args.path, ""), args.name, newobject);
+	}
+	// regenerate the source json
+	if (ret == ASTJSON_OK)
+		json_doc_save(chan, args.json, doc);
+	// cleanup the mess and let's get outta here
+	ast_json_unref(doc);
+	json_set_operation_result(chan, ret);
+	return 0;
+
+}
+
+static int jsonset_exec(struct ast_channel *chan, const char *data) {
+// sets the value of the element at the path indicated (like "/path/to/element/3/value") 
+// the new value must be of the same type as the existing element. you cannot set the value of
+//    existing null elements, or array elements: you can only delete or add them (then for the 
+//    arrays you would need to add the elements with repeated "add" operations)
+// regarding boolean values to be set, false is represented by an empty string, 0, n, no, f or false 
+//    (case insensitive) - anything else is considered true
+// rewrite the contents of the variable that contains the json source and set an error code variable
+
+	json_set_operation_result(chan, ASTJSON_UNDECIDED);
+
+	// parse the app arguments
+	char *argcopy;
+	AST_DECLARE_APP_ARGS(args,
+		AST_APP_ARG(json);
+		AST_APP_ARG(path);
+		AST_APP_ARG(value);
+	);
+	if (ast_strlen_zero(data)) {
+		ast_log(LOG_WARNING, "jsonset requires arguments (jsonvarname,path,value)\n");
+		json_set_operation_result(chan, ASTJSON_ARG_NEEDED);
+		return 0;
+	}
+	argcopy = ast_strdupa(data);
+	AST_STANDARD_APP_ARGS(args, argcopy);
+	if (!ast_strlen_zero(args.json))
+		ast_log(LOG_DEBUG, "getting json and setting result back into variable '%s'\n", args.json);
+	else {
+		ast_log(LOG_WARNING, "a valid dialplan variable name is needed as first argument\n");
+		json_set_operation_result(chan, ASTJSON_ARG_NEEDED);
+		return 0;
+	}
+	if (ast_strlen_zero(args.path))
+		ast_log(LOG_WARNING, "path is empty, adding element to the root\n");
+
+	// parse source
+	struct ast_json *doc;
+	int live;
+	if (json_doc_edit(chan, args.json, &doc, &live) != ASTJSON_OK) {
+		ast_log(LOG_WARNING, "source json parsing error\n");
+		json_set_operation_result(chan, ASTJSON_PARSE_ERROR);
+		return 0;
+	}
+	if (!doc) {
+		ast_log(LOG_WARNING, "source json is empty\n");
+		json_set_operation_result(chan, ASTJSON_INVALID_TYPE);
+		return 0;
+	}
+	// go over the path and change the value
+	int ret = json_set_element(doc, S_OR(args.path, ""), args.value);
+	// regenerate the source json
+	if (ret == ASTJSON_OK)
+		json_doc_save(chan, args.json, doc);
+	// cleanup the mess and let's get outta here
+	ast_json_unref(doc);
+	json_set_operation_result(chan, ret);
+	return 0;
+
+}
+
+static int jsondelete_exec(struct ast_channel *chan, const char *data) {
+// delete a json element in a path (like "/path/to/element/3/value")  
+// rewrite the contents of the variable that contains the json source and set an error code variable
+
+	json_set_operation_result(chan, ASTJSON_UNDECIDED);
+
+	// parse the app arguments
+	char *argcopy;
+	AST_DECLARE_APP_ARGS(args,
+		AST_APP_ARG(jsonvarname);
+		AST_APP_ARG(path);
+	);
+	if (ast_strlen_zero(data)) {
+		ast_log(LOG_WARNING, "jsondelete requires arguments (jsonvarname,path)\n");
+		json_set_operation_result(chan, ASTJSON_ARG_NEEDED);
+		return 0;
+	}
+	argcopy = ast_strdupa(data);
+	AST_STANDARD_APP_ARGS(args, argcopy);
+	if (!ast_strlen_zero(args.jsonvarname))
+		ast_log(LOG_DEBUG, "setting result into variable '%s'\n", args.jsonvarname);
+	else {
+		ast_log(LOG_WARNING, "a valid dialplan variable name is needed as first argument\n");
+		json_set_operation_result(chan, ASTJSON_ARG_NEEDED);
+		return 0;
+	}
+	if (ast_strlen_zero(args.path)) {
+		ast_log(LOG_WARNING, "path is empty, will not delete the whole doc\n");
+		json_set_operation_result(chan, ASTJSON_OK);
+		return 0;
+	}
+	// parse source
+	struct ast_json *doc;
+	int live;
+	if (json_doc_edit(chan, args.jsonvarname, &doc, &live) != ASTJSON_OK) {
+		ast_log(LOG_WARNING, "source json parsing error\n");
+		json_set_operation_result(chan, ASTJSON_PARSE_ERROR);
+		return 0;
+	}
+	if (!doc) {
+		ast_log(LOG_WARNING, "source json is 0-length, delete would have no effect\n");
+		json_set_operation_result(chan, ASTJSON_NOTFOUND);
+		return 0;
+	}
+	// go over the path and drop the element
+	int ret = json_delete_element(doc, args.path);
+	// regenerate the source json
+	if (ret == ASTJSON_OK)
+		json_doc_save(chan, args.jsonvarname, doc);
+	ast_json_unref(doc);
+	json_set_operation_result(chan, ret);
+	return 0;
+
+}
+
+static int json_edit_operation(struct ast_json **doc, char *operation) {
+// run one JsonEdit operation - add(path,type,name,value), set(path,value) or delete(path) - 
+//    against the document. *doc is NULL while the variable is still empty: like JsonAdd, the 
+//    first add creates the root as either {} or [] and adds to it
+	char *opname = operation, *opargs = strchr(operation, '(');
+	size_t len;
+	if (!opargs || !(len = strlen(opargs)) || (opargs[len - 1] != ')')) {
+		ast_log(LOG_WARNING, "invalid operation '%s'; need add(...), set(...) or delete(...)\n", operation);
+		return ASTJSON_ARG_NEEDED;
+	}
+	*opargs++ = 0;
+	opargs[len - 2] = 0;
+	opname = ast_strip(opname);
+
+	if (strcasecmp(opname, "add") == 0) {
+		AST_DECLARE_APP_ARGS(args,
+			AST_APP_ARG(path);
+			AST_APP_ARG(type);
+			AST_APP_ARG(name);
+			AST_APP_ARG(value);
+		);
+		AST_STANDARD_APP_ARGS(args, opargs);
+		struct ast_json *newobject;
+		int ret = json_element_create(args.type, args.value, &newobject);
+		if (ret != ASTJSON_OK)
+			return ret;
+		if (!*doc) {
+			*doc = (ast_strlen_zero(args.name)) ? ast_json_array_create() : ast_json_object_create();
+			return json_add_element(*doc, NULL, args.name, newobject);
+		}
+		return json_add_element(*doc, S_OR(args.path, ""), args.name, newobject);
+	} else if (strcasecmp(opname, "set") == 0) {
+		AST_DECLARE_APP_ARGS(args,
+			AST_APP_ARG(path);
+			AST_APP_ARG(value);
+		);
+		AST_STANDARD_APP_ARGS(args, opargs);
+		if (!*doc) {
+			ast_log(LOG_WARNING, "source json is empty\n");
+			return ASTJSON_INVALID_TYPE;
+		}
+		return json_set_element(*doc, S_OR(args.path, ""), args.value);
+	} else if (strcasecmp(opname, "delete") == 0) {
+		AST_DECLARE_APP_ARGS(args,
+			AST_APP_ARG(path);
+		);
+		AST_STANDARD_APP_ARGS(args, opargs);
+		if (!*doc) {
+			ast_log(LOG_WARNING, "source json is 0-length, delete would have no effect\n");
+			return ASTJSON_NOTFOUND;
+		}
+		return json_delete_element(*doc, args.path);
+	}
+	ast_log(LOG_WARNING, "invalid operation '%s'; need add, set or delete\n", opname);
+	return ASTJSON_ARG_NEEDED;
+}
+
+static int jsonedit_exec(struct ast_channel *chan, const char *data) {
+// run a list of add / set / delete operations against a json document, parsing it only once and 
+//    rewriting the variable only once, at the end
+// the operations run in order and stop at the first one that fails; in that case the variable is 
+//    left unchanged, and the (1-based) number of the failed operation goes into JSONFAILEDOP
+
+	json_set_operation_result(chan, ASTJSON_UNDECIDED);
+	pbx_builtin_setvar_helper(chan, "JSONFAILEDOP", "0");
+
+	// parse the app arguments; the operations keep their quotes until they get split themselves
+	char *argcopy;
+	AST_DECLARE_APP_ARGS(args,
+		AST_APP_ARG(json);
+		AST_APP_ARG(operations)[JSON_EDIT_MAX_OPS];
+	);
+	if (ast_strlen_zero(data)) {
+		ast_log(LOG_WARNING, "jsonedit requires arguments (jsonvarname,operation[,operation...])\n");
+		json_set_operation_result(chan, ASTJSON_ARG_NEEDED);
+		return 0;
+	}
+	argcopy = ast_strdupa(data);
+	AST_STANDARD_RAW_ARGS(args, argcopy);
+	if (!ast_strlen_zero(args.json))
+		ast_log(LOG_DEBUG, "getting json and setting result back into variable '%s'\n", args.json);
+	else {
+		ast_log(LOG_WARNING, "a valid dialplan variable name is needed as first argument\n");
+		json_set_operation_result(chan, ASTJSON_ARG_NEEDED);
+		return 0;
+	}
+	if (args.argc < 2) {
+		ast_log(LOG_WARNING, "jsonedit needs at least one operation\n");
+		json_set_operation_result(chan, ASTJSON_ARG_NEEDED);
+		return 0;
+	}
+
+	// parse document; a live tree is copied, so that it stays untouched if an operation fails
+	struct ast_json *doc;
+	int live;
+	if (json_doc_edit(chan, args.json, &doc, &live) != ASTJSON_OK) {
+		ast_log(LOG_WARNING, "source json parsing error\n");
+		json_set_operation_result(chan, ASTJSON_PARSE_ERROR);
+		return 0;
+	}
+	if (doc && live) {
+		struct ast_json *copy = ast_json_deep_copy(doc);
+		ast_json_unref(doc);
+		if (!(doc = copy)) {
+			json_set_operation_result(chan, ASTJSON_UNDECIDED);
+			return 0;
+		}
+	}
+	// run the operations
+	int ret = ASTJSON_OK;
+	unsigned int i;
+	for (i = 0; i < args.argc - 1; i++) {
+		ret = json_edit_operation(&doc, args.operations[i]);
+		if (ret != ASTJSON_OK) {
+			char failedop[16];
+			ast_log(LOG_WARNING, "jsonedit operation %u failed with code %d\n", i + 1, ret);
+			snprintf(failedop, sizeof(failedop), "%u", i + 1);
+			pbx_builtin_setvar_helper(chan, "JSONFAILEDOP", failedop);
+			break;
+		}
+	}
+	// regenerate the source json
+	if ((ret == ASTJSON_OK) && doc)
+		json_doc_save(chan, args.json, doc);
+	ast_json_unref(doc);
+	json_set_operation_result(chan, ret);
+	return 0;
+
+}
+
+// JsonPatch applies json patches (rfc 6902) and JsonMergePatch json merge patches (rfc 7386). the
+//   paths of a json patch are json pointers (rfc 6901): unlike the paths of the other functions,
+//   a token is an array index only if the element it is applied to is an array, and / and ~ in
+//   keys are escaped as ~1 and ~0
+
+static int json_pointer_next(char **pointer, char **token) {
+// splits the next reference token off a json pointer, unescaping it in place; *pointer is left
+//   NULL after the last token. returns -1 on an invalid escape
+	char *p = *pointer, *slash = strchr(p, '/'), *q;
+	if (slash) {
+		*slash = 0;
+		*pointer = slash + 1;
+	} else
+		*pointer = NULL;
+	*token = q = p;
+	while (*p) {
+		if (*p != '~')
+			*q++ = *p++;
+		else if ((p[1] == '0') || (p[1] == '1')) {
+			*q++ = (p[1] == '0') ? '~' : '/';
+			p += 2;
+		} else
+			return -1;
+	}
+	*q = 0;
+	return 0;
+}
+
+static int json_pointer_index(struct ast_json *array, const char *token, int append, size_t *index) {
+// gets the array index a token stands for: digits without heading zeros, or "-" for the end of
+//   the array if append is set (an index can then also be the size of the array). returns -1 if
+//   the token is not a valid index
+	size_t size = ast_json_array_size(array);
+	if (append && !strcmp(token, "-")) {
+		*index = size;
+		return 0;
+	}
+	if (!json_scan_isdigit(*token) || ((token[0] == '0') && token[1]))
+		return -1;
+	*index = 0;
+	for (; *token; token++) {
+		if (!json_scan_isdigit(*token) || (*index > size))
+			return -1;
+		*index = *index * 10 + (*token - '0');
+	}
+	return (*index < size + !!append) ? 0 : -1;
+}
+
+static struct ast_json *json_pointer_step(struct ast_json *node, const char *token) {
+// gets the member or the array element a token points to, or NULL
+	size_t index;
+	if (!node)
+		return NULL;
+	switch (ast_json_typeof(node)) {
+	case AST_JSON_OBJECT:
+		return ast_json_object_get(node, token);
+	case AST_JSON_ARRAY:
+		return json_pointer_index(node, token, 0, &index) ? NULL : ast_json_array_get(node, index);
+	default:
+		return NULL;
+	}
+}
+
+static int json_pointer_resolve(struct ast_json *doc, char *pointer, struct ast_json **parent,
+	char **last
+) {
+// follows a json pointer (modified in place) down to the parent of the element it points to, which
+//   goes into *parent, with the last token in *last. *parent is NULL for the pointer "", that
+//   points to the whole document. returns -1 if the pointer is invalid or the parent is missing
+	*parent = NULL;
+	*last = NULL;
+	if (!*pointer)
+		return 0;
+	if (*pointer != '/')
+		return -1;
+	struct ast_json *node = doc;
+	char *cursor = pointer + 1, *token;
+	for (;;) {
+		if (json_pointer_next(&cursor, &token))
+			return -1;
+		if (!cursor)
+			break;
+		if (!(node = json_pointer_step(node, token)))
+			return -1;
+	}
+	if (!node)
+		return -1;
+	*parent = node;
+	*last = token;
+	return 0;
+}
+
+static struct ast_json *json_pointer_get(struct ast_json *doc, const char *pointer) {
+// gets the element a json pointer points to, or NULL
+	struct ast_json *parent;
+	char *last;
+	if (json_pointer_resolve(doc, ast_strdupa(pointer), &parent, &last))
+		return NULL;
+	return parent ? json_pointer_step(parent, last) : doc;
+}
+
+static int json_patch_root(struct ast_json **doc, struct ast_json *value, int failed) {
+// makes value the whole document (consuming it); only an object or an array can be a document
+	if ((ast_json_typeof(value) != AST_JSON_OBJECT) && (ast_json_typeof(value) != AST_JSON_ARRAY)) {
+		ast_log(LOG_WARNING, "a json document can only be replaced with an object or an array\n");
+		ast_json_unref(value);
+		return failed;
+	}
+	ast_json_unref(*doc);
+	*doc = value;
+	return ASTJSON_OK;
+}
+
+static int json_patch_add(struct ast_json **doc, const char *path, struct ast_json *value) {
+// the add operation: sets an object member or inserts an array element; the value is consumed
+	struct ast_json *parent;
+	char *last;
+	size_t index;
+	if (json_pointer_resolve(*doc, ast_strdupa(path), &parent, &last)) {
+		ast_json_unref(value);
+		return ASTJSON_ADD_FAILED;
+	}
+	if (!parent)
+		return json_patch_root(doc, value, ASTJSON_ADD_FAILED);
+	switch (ast_json_typeof(parent)) {
+	case AST_JSON_OBJECT:
+		return ast_json_object_set(parent, last, value) ? ASTJSON_ADD_FAILED : ASTJSON_OK;
+	case AST_JSON_ARRAY:
+		if (json_pointer_index(parent, last, 1, &index))
+			break;
+		if (index == ast_json_array_size(parent))
+			return ast_json_array_append(parent, value) ? ASTJSON_ADD_FAILED : ASTJSON_OK;
+		return ast_json_array_insert(parent, index, value) ? ASTJSON_ADD_FAILED : ASTJSON_OK;
+	default:
+		break;
+	}
+	ast_json_unref(value);
+	return ASTJSON_ADD_FAILED;
+}
+
+static int json_patch_remove(struct ast_json *doc, const char *path, struct ast_json **removed) {
+// the remove operation; the element removed goes into *removed, if given, for a move
+	struct ast_json *parent, *element;
+	char *last;
+	size_t index;
+	if (json_pointer_resolve(doc, ast_strdupa(path), &parent, &last) || !parent ||
+		!(element = json_pointer_step(parent, last))
+	)
+		return ASTJSON_DELETE_FAILED;
+	if (removed)
+		*removed = ast_json_ref(element);
+	if (ast_json_typeof(parent) == AST_JSON_OBJECT) {
+		if (ast_json_object_del(parent, last) == 0)
+			return ASTJSON_OK;
+	} else if ((json_pointer_index(parent, last, 0, &index) == 0) &&
+		(ast_json_array_remove(parent, index) == 0)
+	)
+		return ASTJSON_OK;
+	if (removed) {
+		ast_json_unref(*removed);
+		*removed = NULL;
+	}
+	return ASTJSON_DELETE_FAILED;
+}
+
+static int json_patch_replace(struct ast_json **doc, const char *path, struct ast_json *value) {
+// the replace operation: the element must exist already; the value is consumed
+	struct ast_json *parent;
+	char *last;
+	size_t index;
+	if (json_pointer_resolve(*doc, ast_strdupa(path), &parent, &last) ||
+		(parent && !json_pointer_step(parent, last))
+	) {
+		ast_json_unref(value);
+		return ASTJSON_SET_FAILED;
+	}
+	if (!parent)
+		return json_patch_root(doc, value, ASTJSON_SET_FAILED);
+	if (ast_json_typeof(parent) == AST_JSON_OBJECT)
+		return ast_json_object_set(parent, last, value) ? ASTJSON_SET_FAILED : ASTJSON_OK;
+	json_pointer_index(parent, last, 0, &index);
+	return ast_json_array_set(parent, index, value) ? ASTJSON_SET_FAILED : ASTJSON_OK;
+}
+
+static int json_patch_operation(struct ast_json **doc, struct ast_json *operation) {
+// run one operation of a json patch - add, remove, replace, move, copy or test - against the
+//   document. the values are copied out of the patch, which stays untouched
+	struct ast_json *member, *value = NULL, *element;
+	const char *op = NULL, *path = NULL, *from = NULL;
+	if (ast_json_typeof(operation) == AST_JSON_OBJECT) {
+		if ((member = ast_json_object_get(operation, "op")) && (ast_json_typeof(member) == AST_JSON_STRING))
+			op = ast_json_string_get(member);
+		if ((member = ast_json_object_get(operation, "path")) && (ast_json_typeof(member) == AST_JSON_STRING))
+			path = ast_json_string_get(member);
+		if ((member = ast_json_object_get(operation, "from")) && (ast_json_typeof(member) == AST_JSON_STRING))
+			from = ast_json_string_get(member);
+		value = ast_json_object_get(operation, "value");
+	}
+	if (!op || !path) {
+		ast_log(LOG_WARNING, "a json patch operation needs an op and a path\n");
+		return ASTJSON_INVALID_TYPE;
+	}
+	if (!strcmp(op, "remove"))
+		return json_patch_remove(*doc, path, NULL);
+	if (!strcmp(op, "move") || !strcmp(op, "copy")) {
+		if (!from) {
+			ast_log(LOG_WARNING, "json patch operation '%s' needs a from\n", op);
+			return ASTJSON_INVALID_TYPE;
+		}
+		if (*op == 'c') {
+			if (!(element = json_pointer_get(*doc, from)) || !(value = ast_json_deep_copy(element)))
+				return ASTJSON_ADD_FAILED;
+			return json_patch_add(doc, path, value);
+		}
+		size_t len = strlen(from);
+		if (!strncmp(path, from, len) && (path[len] == '/'))
+			return ASTJSON_ADD_FAILED;         // cannot move an element into one of its children
+		if (!strcmp(path, from))
+			return json_pointer_get(*doc, from) ? ASTJSON_OK : ASTJSON_DELETE_FAILED;
+		int ret = json_patch_remove(*doc, from, &value);
+		return (ret == ASTJSON_OK) ? json_patch_add(doc, path, value) : ret;
+	}
+	if (!value) {
+		ast_log(LOG_WARNING, "json patch operation '%s' needs a value\n", op);
+		return ASTJSON_INVALID_TYPE;
+	}
+	if (!strcmp(op, "test")) {
+		element = json_pointer_get(*doc, path);
+		return (element && ast_json_equal(element, value)) ? ASTJSON_OK : ASTJSON_NOTFOUND;
+	}
+	if (strcmp(op, "add") && strcmp(op, "replace")) {
+		ast_log(LOG_WARNING, "invalid json patch operation '%s'\n", op);
+		return ASTJSON_INVALID_TYPE;
+	}
+	if (!(value = ast_json_deep_copy(value)))
+		return (*op == 'a') ? ASTJSON_ADD_FAILED : ASTJSON_SET_FAILED;
+	return (*op == 'a') ? json_patch_add(doc, path, value) : json_patch_replace(doc, path, value);
+}
+
+static int json_merge_patch(struct ast_json **target, struct ast_json *patch) {
+// merges a patch into *target, as in rfc 7386: the members of a patch object are merged into the
+//   members of the same name, a null member removes a member; anything else than an object
+//   replaces the target. the values are copied out of the patch
+	if (ast_json_typeof(patch) != AST_JSON_OBJECT) {
+		struct ast_json *copy = ast_json_deep_copy(patch);
+		if (!copy)
+			return ASTJSON_SET_FAILED;
+		ast_json_unref(*target);
+		*target = copy;
+		return ASTJSON_OK;
+	}
+	if (!*target || (ast_json_typeof(*target) != AST_JSON_OBJECT)) {
+		ast_json_unref(*target);
+		if (!(*target = ast_json_object_create()))
+			return ASTJSON_SET_FAILED;
+	}
+	struct ast_json_iter *iter;
+	for (iter = ast_json_object_iter(patch); iter; iter = ast_json_object_iter_next(patch, iter)) {
+		const char *key = ast_json_object_iter_key(iter);
+		struct ast_json *value = ast_json_object_iter_value(iter);
+		if (ast_json_typeof(value) == AST_JSON_NULL) {
+			ast_json_object_del(*target, key);
+			continue;
+		}
+		struct ast_json *old = ast_json_object_get(*target, key);
+		struct ast_json *member = old ? ast_json_ref(old) : NULL;
+		int ret = json_merge_patch(&member, value);
+		if ((ret != ASTJSON_OK) || (member == old)) {
+			// merged in place (or failed), the member is where it was
+			ast_json_unref(member);
+			if (ret != ASTJSON_OK)
+				return ret;
+			continue;
+		}
+		if (ast_json_object_set(*target, key, member))
+			return ASTJSON_SET_FAILED;
+	}
+	return ASTJSON_OK;
+}
+
+static int jsonpatch_exec(struct ast_channel *chan, const char *data) {
+// apply a json patch (rfc 6902) - an array of add, remove, replace, move, copy and test 
+//    operations - to a json document, parsing both only once and rewriting the variable once
+// like for JsonEdit, the operations stop at the first one that fails; the variable is then left 
+//    unchanged, and the (1-based) number of the failed operation goes into JSONFAILEDOP
+
+	json_set_operation_result(chan, ASTJSON_UNDECIDED);
+	pbx_builtin_setvar_helper(chan, "JSONFAILEDOP", "0");
+
+	// parse the app arguments
+	char *argcopy;
+	AST_DECLARE_APP_ARGS(args,
+		AST_APP_ARG(json);
+		AST_APP_ARG(patch);
+	);
+	if (ast_strlen_zero(data)) {
+		ast_log(LOG_WARNING, "jsonpatch requires arguments (jsonvarname,patchvarname)\n");
+		json_set_operation_result(chan, ASTJSON_ARG_NEEDED);
+		return 0;
+	}
+	argcopy = ast_strdupa(data);
+	AST_STANDARD_APP_ARGS(args, argcopy);
+	if (ast_strlen_zero(args.json) || ast_strlen_zero(args.patch)) {
+		ast_log(LOG_WARNING, "valid dialplan variable names are needed for the document and the patch\n");
+		json_set_operation_result(chan, ASTJSON_ARG_NEEDED);
+		return 0;
+	}
+
+	// parse the patch and the document; a live tree is copied, so that it stays untouched if an
+	//   operation fails
+	struct ast_json *patch = json_doc_get(chan, args.patch);
+	if (!patch) {
+		ast_log(LOG_WARNING, "json patch parsing error\n");
+		json_set_operation_result(chan, ASTJSON_PARSE_ERROR);
+		return 0;
+	}
+	if (ast_json_typeof(patch) != AST_JSON_ARRAY) {
+		ast_log(LOG_WARNING, "a json patch must be an array of operations\n");
+		ast_json_unref(patch);
+		json_set_operation_result(chan, ASTJSON_INVALID_TYPE);
+		return 0;
+	}
+	struct ast_json *doc;
+	int live;
+	if (json_doc_edit(chan, args.json, &doc, &live) != ASTJSON_OK) {
+		ast_log(LOG_WARNING, "source json parsing error\n");
+		ast_json_unref(patch);
+		json_set_operation_result(chan, ASTJSON_PARSE_ERROR);
+		return 0;
+	}
+	if (doc && live) {
+		struct ast_json *copy = ast_json_deep_copy(doc);
+		ast_json_unref(doc);
+		if (!(doc = copy)) {
+			ast_json_unref(patch);
+			json_set_operation_result(chan, ASTJSON_UNDECIDED);
+			return 0;
+		}
+	}
+	// run the operations
+	int ret = ASTJSON_OK;
+	size_t i, count = ast_json_array_size(patch);
+	for (i = 0; i < count; i++) {
+		ret = json_patch_operation(&doc, ast_json_array_get(patch, i));
+		if (ret != ASTJSON_OK) {
+			char failedop[24];
+			ast_log(LOG_WARNING, "jsonpatch operation %zu failed with code %d\n", i + 1, ret);
+			snprintf(failedop, sizeof(failedop), "%zu", i + 1);
+			pbx_builtin_setvar_helper(chan, "JSONFAILEDOP", failedop);
+			break;
+		}
+	}
+	// regenerate the source json
+	if ((ret == ASTJSON_OK) && doc)
+		json_doc_save(chan, args.json, doc);
+	ast_json_unref(doc);
+	ast_json_unref(patch);
+	json_set_operation_result(chan, ret);
+	return 0;
+
+}
+
+static int jsonmergepatch_exec(struct ast_channel *chan, const char *data) {
+// merge a json merge patch (rfc 7386) into a json document, parsing both only once and rewriting
+//    the variable once
+// the patch must be an object or an array (an array replaces the whole document)
+
+	json_set_operation_result(chan, ASTJSON_UNDECIDED);
+
+	// parse the app arguments
+	char *argcopy;
+	AST_DECLARE_APP_ARGS(args,
+		AST_APP_ARG(json);
+		AST_APP_ARG(patch);
+	);
+	if (ast_strlen_zero(data)) {
+		ast_log(LOG_WARNING, "jsonmergepatch requires arguments (jsonvarname,patchvarname)\n");
+		json_set_operation_result(chan, ASTJSON_ARG_NEEDED);
+		return 0;
+	}
+	argcopy = ast_strdupa(data);
+	AST_STANDARD_APP_ARGS(args, argcopy);
+	if (ast_strlen_zero(args.json) || ast_strlen_zero(args.patch)) {
+		ast_log(LOG_WARNING, "valid dialplan variable names are needed for the document and the patch\n");
+		json_set_operation_result(chan, ASTJSON_ARG_NEEDED);
 		return 0;
 	}
-	// parse json
-	struct ast_json *doc = ast_json_load_string(pbx_builtin_getvar_helper(chan, args.json), NULL);
-	if (!doc) {
+
+	// parse the patch and the document; a live tree is changed in place, as merging can only
+	//   fail when running out of memory
+	struct ast_json *patch = json_doc_get(chan, args.patch);
+	if (!patch) {
+		ast_log(LOG_WARNING, "json patch parsing error\n");
+		json_set_operation_result(chan, ASTJSON_PARSE_ERROR);
+		return 0;
+	}
+	if ((ast_json_typeof(patch) != AST_JSON_OBJECT) && (ast_json_typeof(patch) != AST_JSON_ARRAY)) {
+		ast_log(LOG_WARNING, "a json merge patch must be an object or an array\n");
+		ast_json_unref(patch);
+		json_set_operation_result(chan, ASTJSON_INVALID_TYPE);
+		return 0;
+	}
+	struct ast_json *doc;
+	int live;
+	if (json_doc_edit(chan, args.json, &doc, &live) != ASTJSON_OK) {
 		ast_log(LOG_WARNING, "source json parsing error\n");
+		ast_json_unref(patch);
 		json_set_operation_result(chan, ASTJSON_PARSE_ERROR);
 		return 0;
 	}
-	char *unpretty = ast_json_dump_string_format(doc, 0);
-	ast_copy_string(buffer, unpretty, buflen);
+	// merge, and regenerate the source json
+	int ret = json_merge_patch(&doc, patch);
+	if (ret == ASTJSON_OK)
+		json_doc_save(chan, args.json, doc);
 	ast_json_unref(doc);
-	ast_json_free(unpretty);
-	json_set_operation_result(chan, ASTJSON_OK);
+	ast_json_unref(patch);
+	json_set_operation_result(chan, ret);
 	return 0;
 
 }
 
-static int jsonget_exec(struct ast_channel *chan, 
+static int json_open_exec(struct ast_channel *chan, 
 	const char *cmd, char *parse, char *buffer, size_t buflen
 ) {
-// searches for a json element found based on a path (like "/path/to/element/3/value")  
-//   and populates the element value and type with the contents of the element
+// parses the contents of a doc variable once and keeps the tree under a new handle; returns the
+//   reference to it ("handle:<n>"), to be used instead of the variable name from then on
 
 	json_set_operation_result(chan, ASTJSON_UNDECIDED);
 	buffer[0] = 0;
@@ -336,619 +5656,945 @@ static int jsonget_exec(struct ast_channel *chan,
 	// parse the function arguments
 	AST_DECLARE_APP_ARGS(args,
 		AST_APP_ARG(json);
-		AST_APP_ARG(path);
 	);
 	if (ast_strlen_zero(parse)) {
-		ast_log(LOG_WARNING, "jsonget requires arguments (json,path)\n");
+		ast_log(LOG_WARNING, "json_open requires arguments (jsonvarname)\n");
 		json_set_operation_result(chan, ASTJSON_ARG_NEEDED);
 		return 0;
 	}
 	AST_STANDARD_APP_ARGS(args, parse);
-	if (ast_strlen_zero(args.json)) {
+	if (ast_strlen_zero(args.json) || json_handle_id(args.json)) {
 		ast_log(LOG_WARNING, "a valid asterisk variable name is required\n");
 		json_set_operation_result(chan, ASTJSON_ARG_NEEDED);
 		return 0;
 	}
-	if (ast_strlen_zero(args.path)) {
-		ast_log(LOG_WARNING, "path is empty, returning full json\n");
-		ast_copy_string(buffer, args.json, buflen);
-		json_set_operation_result(chan, ASTJSON_OK);
-		return 0;
-	}
-	// parse json
-	struct ast_json *doc = ast_json_load_string(pbx_builtin_getvar_helper(chan, args.json), NULL);
-	if (!doc) {
+	// parse json; an empty document is fine, the first JsonAdd creates its root. the handle gets
+	//    a tree of its own, not one that still has to be written back to the variable
+	struct ast_json *doc;
+	int live;
+	if (json_doc_edit(chan, args.json, &doc, &live) != ASTJSON_OK) {
 		ast_log(LOG_WARNING, "source json parsing error\n");
 		json_set_operation_result(chan, ASTJSON_PARSE_ERROR);
 		return 0;
 	}
+	if (doc && live) {
+		struct ast_json *copy = ast_json_deep_copy(doc);
+		ast_json_unref(doc);
+		if (!(doc = copy)) {
+			json_set_operation_result(chan, ASTJSON_UNDECIDED);
+			return 0;
+		}
+	}
+	unsigned int id = json_handle_open(chan, doc);
+	ast_json_unref(doc);
+	if (!id) {
+		json_set_operation_result(chan, ASTJSON_UNDECIDED);
+		return 0;
+	}
+	snprintf(buffer, buflen, JSON_HANDLE_PREFIX "%u", id);
+	json_set_operation_result(chan, ASTJSON_OK);
+	return 0;
 
-	int first = 1;
-	char *path = "", *type = NULL;
-	while ((path = strsep(&args.path, ","))) {
-		// go over the path (and eliminate heading and trailing slash in the process)
-		char *thispath = ast_strdupa((char *)(path + ((path[0] == '/') ? 1 : 0)));
-		if (thispath[strlen(thispath) - 1] == '/') thispath[strlen(thispath) - 1] = 0;
+}
 
-		struct ast_json *thisobject = doc, *nextobject = NULL;
-		int ixarray;
-		char *pathpiece = strsep(&thispath, "/");
-		while (pathpiece) {
-			// determine if we have an object with the given name or index
-			if (sscanf(pathpiece, "%3d", &ixarray) == 1)
-				nextobject = ast_json_array_get(thisobject, ixarray);
-			else
-				nextobject = ast_json_object_get(thisobject, pathpiece);
-			if (!nextobject) {
-				ast_json_unref(doc);
-				json_set_operation_result(chan, ASTJSON_NOTFOUND);
-				return 0;
-			}
-			thisobject = nextobject;
-			pathpiece = strsep(&thispath, "/");
-		}
-		ast_free(thispath);
+static int json_close_exec(struct ast_channel *chan, 
+	const char *cmd, char *parse, char *buffer, size_t buflen
+) {
+// closes a handle opened by JSON_OPEN, serializing its document into a variable first if one is
+//   given; without a variable the document (and any change made to it) is dropped
 
-		if (!first)
-			ast_build_string(&buffer, &buflen, ",");
+	json_set_operation_result(chan, ASTJSON_UNDECIDED);
+	buffer[0] = 0;
 
-		// got to the end of our path, evaluate the object type and set the value
-		char *value = NULL;
-		enum ast_json_type jtype = ast_json_typeof(thisobject);
-		switch (jtype) {
-			case AST_JSON_FALSE:
-				type = ast_strdupa("bool");
-				ast_build_string(&buffer, &buflen, "0");
-				break;
-			case AST_JSON_TRUE:
-				type = ast_strdupa("bool");
-				ast_build_string(&buffer, &buflen, "1");
-				break;
-			case AST_JSON_NULL:
-				type = ast_strdupa("null");
-				ast_build_string(&buffer, &buflen, "");
-				break;
-			case AST_JSON_REAL:
-			case AST_JSON_INTEGER:
-				type = ast_strdupa("number");
-				if (jtype == AST_JSON_REAL)
-					ast_asprintf(&value, "%f", ast_json_real_get(thisobject));
-				else
-					ast_asprintf(&value, "%d", (int)ast_json_integer_get(thisobject));
-				ast_build_string(&buffer, &buflen, value);
-				ast_free(value);
-				break;
-			case AST_JSON_STRING:
-				type = ast_strdupa("string");
-				ast_build_string(&buffer, &buflen, ast_json_string_get(thisobject));
-				break;
-			case AST_JSON_ARRAY:
-				type = ast_strdupa("array");
-				ast_build_string(&buffer, &buflen, ast_json_dump_string_format(thisobject, 0));
-				break;
-			case AST_JSON_OBJECT:
-				type = ast_strdupa("node");
-				ast_build_string(&buffer, &buflen, ast_json_dump_string_format(thisobject, 0));
-				break;
-		}
-		first = 0;
+	// parse the function arguments
+	AST_DECLARE_APP_ARGS(args,
+		AST_APP_ARG(handle);
+		AST_APP_ARG(json);
+	);
+	if (ast_strlen_zero(parse)) {
+		ast_log(LOG_WARNING, "json_close requires arguments (handle[,jsonvarname])\n");
+		json_set_operation_result(chan, ASTJSON_ARG_NEEDED);
+		return 0;
+	}
+	AST_STANDARD_APP_ARGS(args, parse);
+	unsigned int id = json_handle_id(S_OR(args.handle, ""));
+	if (!id || (!ast_strlen_zero(args.json) && json_handle_id(args.json))) {
+		ast_log(LOG_WARNING, "a handle returned by JSON_OPEN and a valid asterisk variable name are required\n");
+		json_set_operation_result(chan, ASTJSON_ARG_NEEDED);
+		return 0;
+	}
+	struct ast_json *doc;
+	if (json_handle_close(chan, id, &doc)) {
+		json_set_operation_result(chan, ASTJSON_NOTFOUND);
+		return 0;
+	}
+	// write the document back
+	if (!ast_strlen_zero(args.json)) {
+		if (doc)
+			json_doc_save(chan, args.json, doc);
+		else
+			pbx_builtin_setvar_helper(chan, args.json, "");
 	}
-	pbx_builtin_setvar_helper(chan, "JSONTYPE", type);
-	json_set_operation_result(chan, ASTJSON_OK);
 	ast_json_unref(doc);
+	json_set_operation_result(chan, ASTJSON_OK);
 	return 0;
 
 }
 
-static int jsonvariables_exec(struct ast_channel *chan, const char *data) {
-// considers that the json string offered as input is a list of key-value pairs; associates each
-//   key with an asterisk variable name, and sets the value for it
-// depending on the type of the json variable, the values are:
-//   True, False: 1, 0
-//   NULL: '' (resulting variable contains an empty string)
-//   Number, String: the number or the string
-//   Array: !array! (literal)
-//   Object: string, the json representation of the underlying object
-// note that this is mainly intended for simple key-value lists; if you have variables that are 
-//   arrays or objects, things may get screwed up because of the separators and braces...
+static int json_iter_exec(struct ast_channel *chan, 
+	const char *cmd, char *parse, char *buffer, size_t buflen
+) {
+// opens a cursor over the array or the object at a path of a json document, for JSON_NEXT to walk
+//   through; returns the reference to it ("iter:<n>")
 
 	json_set_operation_result(chan, ASTJSON_UNDECIDED);
+	buffer[0] = 0;
 
-	// parse the app arguments
-	char *argcopy;
+	// parse the function arguments
 	AST_DECLARE_APP_ARGS(args,
 		AST_APP_ARG(json);
+		AST_APP_ARG(path);
+		AST_APP_ARG(fields);
 	);
-	if (ast_strlen_zero(data)) {
-		ast_log(LOG_WARNING, "jsonvariables requires arguments (jsonsource)\n");
+	if (ast_strlen_zero(parse)) {
+		ast_log(LOG_WARNING, "json_iter requires arguments (jsonvarname,path[,fields])\n");
 		json_set_operation_result(chan, ASTJSON_ARG_NEEDED);
 		return 0;
 	}
-	argcopy = ast_strdupa(data);
-	AST_STANDARD_APP_ARGS(args, argcopy);
+	AST_STANDARD_APP_ARGS(args, parse);
 	if (ast_strlen_zero(args.json)) {
-		ast_log(LOG_WARNING, "json string is empty\n");
+		ast_log(LOG_WARNING, "a valid asterisk variable name is required\n");
 		json_set_operation_result(chan, ASTJSON_ARG_NEEDED);
 		return 0;
 	}
-	// parse json
-	struct ast_json *doc = ast_json_load_string(pbx_builtin_getvar_helper(chan, args.json), NULL);
+	// parse json and find the container
+	struct ast_json *doc = json_doc_get(chan, args.json);
 	if (!doc) {
 		ast_log(LOG_WARNING, "source json parsing error\n");
 		json_set_operation_result(chan, ASTJSON_PARSE_ERROR);
 		return 0;
 	}
-	// for each element
-	struct ast_json_iter *doc_iter;
-	char *num = NULL; char *eljson = NULL;
+	struct json_path *path = json_path_get(S_OR(args.path, ""));
+	struct ast_json *container = path ? json_path_walk(doc, path, path->count) : NULL;
+	ao2_cleanup(path);
+	if (!container) {
+		ast_json_unref(doc);
+		json_set_operation_result(chan, ASTJSON_NOTFOUND);
+		return 0;
+	}
+	enum ast_json_type type = ast_json_typeof(container);
+	if ((type != AST_JSON_ARRAY) && (type != AST_JSON_OBJECT)) {
+		ast_log(LOG_WARNING, "the element at the path is neither an array nor an object\n");
+		ast_json_unref(doc);
+		json_set_operation_result(chan, ASTJSON_INVALID_TYPE);
+		return 0;
+	}
+	// the tree of a handle (or a dirty one) may still change: the cursor walks a (shallow) copy
+	//    of the container
+	container = ast_json_copy(container);
+	ast_json_unref(doc);
+	unsigned int id = container ? json_iter_open(chan, container, S_OR(args.fields, "")) : 0;
+	ast_json_unref(container);
+	if (!id)
+		return 0;
+	snprintf(buffer, buflen, JSON_ITER_PREFIX "%u", id);
+	json_set_operation_result(chan, ASTJSON_OK);
+	return 0;
 
-	doc_iter = ast_json_object_iter(doc);
-	if (doc_iter == NULL)
-		goto out;
+}
 
-	while (doc_iter) {
-		const char *nvp_key;
-		struct ast_json *nvp;
-		enum ast_json_type type;
+static int json_next_exec(struct ast_channel *chan, 
+	const char *cmd, char *parse, char *buffer, size_t buflen
+) {
+// moves a JSON_ITER cursor on to the next element: returns 1 and sets JSONKEY, JSONVALUE and 
+//   JSONTYPE (plus the variables for the fields asked for), or returns 0 once past the last one
 
-		nvp_key = ast_json_object_iter_key(doc_iter);
-		nvp = ast_json_object_iter_value(doc_iter);
-		type = ast_json_typeof(nvp);
+	json_set_operation_result(chan, ASTJSON_UNDECIDED);
+	ast_copy_string(buffer, "0", buflen);
 
-		switch (type) {
-			case AST_JSON_FALSE: pbx_builtin_setvar_helper(chan, nvp_key, "0"); break;
-			case AST_JSON_TRUE: pbx_builtin_setvar_helper(chan, nvp_key, "1"); break;
-			case AST_JSON_NULL: pbx_builtin_setvar_helper(chan, nvp_key, ""); break;
-			case AST_JSON_REAL:
-			case AST_JSON_INTEGER:
-				if (type == AST_JSON_REAL)
-					ast_asprintf(&num, "%f", ast_json_real_get(nvp));
-				else
-					ast_asprintf(&num, "%d", (int)ast_json_integer_get(nvp));
-				pbx_builtin_setvar_helper(chan, nvp_key, num);
-				ast_free(num);
-				break;
-			case AST_JSON_STRING: pbx_builtin_setvar_helper(chan, nvp_key, ast_json_string_get(nvp)); break;
-			case AST_JSON_ARRAY: pbx_builtin_setvar_helper(chan, nvp_key, "!array!"); break;
-			case AST_JSON_OBJECT:
-				eljson = ast_json_dump_string_format(nvp, 0);
-				pbx_builtin_setvar_helper(chan, nvp_key, eljson);
-				ast_free(eljson);
-				break;
-			default:
-				break;
+	// parse the function arguments
+	AST_DECLARE_APP_ARGS(args,
+		AST_APP_ARG(iter);
+	);
+	AST_STANDARD_APP_ARGS(args, parse);
+	unsigned int id = json_iter_id(S_OR(args.iter, ""));
+	if (!id) {
+		ast_log(LOG_WARNING, "json_next requires a cursor returned by JSON_ITER\n");
+		json_set_operation_result(chan, ASTJSON_ARG_NEEDED);
+		return 0;
+	}
+	// take the next element; the cursor is closed when there is none left
+	struct ast_json *container = NULL, *value = NULL;
+	const char *key = NULL;
+	size_t index = 0;
+	char *fields = NULL;
+	ast_channel_lock(chan);
+	struct json_iter *iter = json_iter_find(chan, id, 0);
+	if (iter) {
+		if (ast_json_typeof(iter->container) == AST_JSON_ARRAY)
+			value = ast_json_array_get(iter->container, iter->index);
+		else {
+			iter->member = iter->index ? ast_json_object_iter_next(iter->container, iter->member) :
+				ast_json_object_iter(iter->container);
+			if (iter->member) {
+				value = ast_json_object_iter_value(iter->member);
+				key = ast_json_object_iter_key(iter->member);
+			}
 		}
-		doc_iter = ast_json_object_iter_next(doc, doc_iter);
+		if (value) {
+			container = ast_json_ref(iter->container);
+			value = ast_json_ref(value);
+			index = iter->index++;
+			fields = ast_strdupa(iter->fields);
+		} else {
+			json_iter_find(chan, id, 1);
+			json_iter_free(iter);
+		}
+	}
+	ast_channel_unlock(chan);
+	if (!iter) {
+		ast_log(LOG_WARNING, "json cursor %u is not open\n", id);
+		json_set_operation_result(chan, ASTJSON_NOTFOUND);
+		return 0;
+	}
+	if (!value) {
+		json_set_operation_result(chan, ASTJSON_OK);
+		return 0;
+	}
+
+	// hand the element to the dialplan
+	struct ast_str *str = ast_str_create(64);
+	if (!str) {
+		ast_json_unref(value);
+		ast_json_unref(container);
+		return 0;
+	}
+	if (key)
+		pbx_builtin_setvar_helper(chan, "JSONKEY", key);
+	else {
+		ast_str_set(&str, 0, "%zu", index);
+		pbx_builtin_setvar_helper(chan, "JSONKEY", ast_str_buffer(str));
+	}
+	ast_str_reset(str);
+	pbx_builtin_setvar_helper(chan, "JSONTYPE", json_value_str(value, &str, 0));
+	pbx_builtin_setvar_helper(chan, "JSONVALUE", ast_str_buffer(str));
+	// each field is either a path inside the element, set into the variable named like its last
+	//    segment, or name=path
+	char *field;
+	while ((field = strsep(&fields, "&"))) {
+		char *varname = strsep(&field, "=");
+		const char *subpath = field ? field : varname;
+		if (!field) {
+			char *slash = strrchr(varname, '/');
+			while (slash && !slash[1] && (slash > varname)) {
+				*slash = 0;
+				slash = strrchr(varname, '/');
+			}
+			if (slash)
+				varname = slash + 1;
+		}
+		if (ast_strlen_zero(varname))
+			continue;
+		struct json_path *path = json_path_get(subpath);
+		struct ast_json *element = path ? json_path_walk(value, path, path->count) : NULL;
+		ao2_cleanup(path);
+		ast_str_reset(str);
+		if (element)
+			json_value_str(element, &str, 0);
+		pbx_builtin_setvar_helper(chan, varname, ast_str_buffer(str));
+	}
+	ast_free(str);
+	ast_json_unref(value);
+	ast_json_unref(container);
+	ast_copy_string(buffer, "1", buflen);
+	json_set_operation_result(chan, ASTJSON_OK);
+	return 0;
+
+}
+
+static int json_flush_exec(struct ast_channel *chan, 
+	const char *cmd, char *parse, char *buffer, size_t buflen
+) {
+// with lazy write-back, serializes the changed documents into their variables: the ones named, or
+//   all of them when no name is given. returns an empty string
+
+	json_set_operation_result(chan, ASTJSON_UNDECIDED);
+	buffer[0] = 0;
+
+	// parse the function arguments
+	AST_DECLARE_APP_ARGS(args,
+		AST_APP_ARG(json)[JSON_CACHE_MAX_DOCS];
+	);
+	AST_STANDARD_APP_ARGS(args, parse);
+	unsigned int i, flushed = 0;
+	int res = 0;
+	for (i = 0; i < args.argc; i++) {
+		if (ast_strlen_zero(args.json[i]))
+			continue;
+		res |= json_cache_flush(chan, args.json[i]);
+		flushed++;
+	}
+	if (!flushed)
+		res = json_cache_flush(chan, NULL);
+	json_set_operation_result(chan, res ? ASTJSON_SET_FAILED : ASTJSON_OK);
+	return 0;
+
+}
+
+static int json_shared_get_paths(struct ast_channel *chan, struct json_shared *shared,
+	char *pathlist, struct ast_str **buf, ssize_t buflen
+) {
+// json_get_paths on a shared document, where no path means the whole document
+	if (!ast_strlen_zero(pathlist))
+		return json_get_paths(chan, shared->doc, pathlist, buf, buflen);
+	pbx_builtin_setvar_helper(chan, "JSONTYPE", json_value_str(shared->doc, buf, buflen));
+	return ASTJSON_OK;
+}
+
+static int json_shared_exec(struct ast_channel *chan, 
+	const char *cmd, char *parse, struct ast_str **buf, ssize_t buflen
+) {
+// gets elements out of a shared document, like JSONGET does out of a doc variable; the document
+//   was parsed when it was published, so nothing is parsed here
+
+	json_set_operation_result(chan, ASTJSON_UNDECIDED);
+	ast_str_reset(*buf);
+
+	// parse the function arguments
+	AST_DECLARE_APP_ARGS(args,
+		AST_APP_ARG(name);
+		AST_APP_ARG(path);
+	);
+	if (ast_strlen_zero(parse)) {
+		ast_log(LOG_WARNING, "json_shared requires arguments (name,path)\n");
+		json_set_operation_result(chan, ASTJSON_ARG_NEEDED);
+		return 0;
+	}
+	AST_STANDARD_APP_ARGS(args, parse);
+	if (ast_strlen_zero(args.name)) {
+		ast_log(LOG_WARNING, "a shared document name is required\n");
+		json_set_operation_result(chan, ASTJSON_ARG_NEEDED);
+		return 0;
+	}
+	struct json_shared *shared = json_shared_find(args.name);
+	if (!shared) {
+		ast_log(LOG_WARNING, "no shared json document named %s\n", args.name);
+		json_set_operation_result(chan, ASTJSON_NOTFOUND);
+		return 0;
+	}
+	int ret = json_shared_get_paths(chan, shared, args.path, buf, buflen);
+	ao2_ref(shared, -1);
+	json_set_operation_result(chan, ret);
+	return 0;
+
+}
+
+static int json_shared_write(struct ast_channel *chan, 
+	const char *cmd, char *parse, const char *value
+) {
+// publishes json text as the new version of a shared document, or removes the document when the
+//   text is empty
+
+	json_set_operation_result(chan, ASTJSON_UNDECIDED);
+
+	// parse the function arguments
+	AST_DECLARE_APP_ARGS(args,
+		AST_APP_ARG(name);
+	);
+	AST_STANDARD_APP_ARGS(args, parse);
+	if (ast_strlen_zero(args.name)) {
+		ast_log(LOG_WARNING, "a shared document name is required\n");
+		json_set_operation_result(chan, ASTJSON_ARG_NEEDED);
+		return 0;
+	}
+	int ret = json_shared_publish(args.name, value);
+	if (ret == ASTJSON_PARSE_ERROR)
+		ast_log(LOG_WARNING, "source json parsing error\n");
+	json_set_operation_result(chan, ret);
+	return 0;
+
+}
+
+static int jsonfile_exec(struct ast_channel *chan, 
+	const char *cmd, char *parse, struct ast_str **buf, ssize_t buflen
+) {
+// gets elements out of a json file, like JSONGET does out of a doc variable. the file is parsed
+//   the first time it is read and whenever it changes, not on every call
+
+	json_set_operation_result(chan, ASTJSON_UNDECIDED);
+	ast_str_reset(*buf);
+
+	// parse the function arguments
+	AST_DECLARE_APP_ARGS(args,
+		AST_APP_ARG(file);
+		AST_APP_ARG(path);
+	);
+	if (ast_strlen_zero(parse)) {
+		ast_log(LOG_WARNING, "jsonfile requires arguments (file,path)\n");
+		json_set_operation_result(chan, ASTJSON_ARG_NEEDED);
+		return 0;
+	}
+	AST_STANDARD_APP_ARGS(args, parse);
+	if (ast_strlen_zero(args.file)) {
+		ast_log(LOG_WARNING, "a json file name is required\n");
+		json_set_operation_result(chan, ASTJSON_ARG_NEEDED);
+		return 0;
+	}
+	// a relative name is looked for in the asterisk configuration directory
+	char filename[PATH_MAX];
+	json_file_name(args.file, filename, sizeof(filename));
+	int ret;
+	struct json_shared *shared = json_file_get(filename, &ret);
+	if (!shared) {
+		json_set_operation_result(chan, ret);
+		return 0;
 	}
-out:
-	ast_json_unref(doc);
-	json_set_operation_result(chan, ASTJSON_OK);
+	ret = json_shared_get_paths(chan, shared, args.path, buf, buflen);
+	ao2_ref(shared, -1);
+	json_set_operation_result(chan, ret);
 	return 0;
 
 }
 
-static int jsonadd_exec(struct ast_channel *chan, const char *data) {
-// add an element of a certain type into a json structure, at the path indicated
-// accepted types are bool, null, number, string or array
-// the value parameter is ignored for null and array types; boolean false are represented by an 
-//    empty string, 0, n, no, f or false (case insensitive) - anything else is considered true
-// if the element at the path is an array, append to the array (in this case the name is ignored)
-// rewrite the contents of the variable that contains the json doc and set an error code variable
+static int json_index_create_exec(struct ast_channel *chan, 
+	const char *cmd, char *parse, char *buffer, size_t buflen
+) {
+// indexes the elements of an array in a shared document by the value of one of their fields;
+//   returns the number of elements indexed
 
 	json_set_operation_result(chan, ASTJSON_UNDECIDED);
+	buffer[0] = 0;
 
-	// parse the app arguments
-	char *argcopy;
+	// parse the function arguments
 	AST_DECLARE_APP_ARGS(args,
-		AST_APP_ARG(json);
-		AST_APP_ARG(path);
-		AST_APP_ARG(type);
 		AST_APP_ARG(name);
-		AST_APP_ARG(value);
+		AST_APP_ARG(path);
+		AST_APP_ARG(key);
+		AST_APP_ARG(index);
 	);
-	if (ast_strlen_zero(data)) {
-		ast_log(LOG_WARNING, "jsonadd requires arguments (jsonvarname,path,type,name,value)\n");
+	if (ast_strlen_zero(parse)) {
+		ast_log(LOG_WARNING, "json_index_create requires arguments (name,arraypath,keyfield[,index])\n");
 		json_set_operation_result(chan, ASTJSON_ARG_NEEDED);
 		return 0;
 	}
-	argcopy = ast_strdupa(data);
-	AST_STANDARD_APP_ARGS(args, argcopy);
-	if (!ast_strlen_zero(args.json))
-		ast_log(LOG_DEBUG, "getting json and setting result back into variable '%s'\n", args.json);
-	else {
-		ast_log(LOG_WARNING, "a valid dialplan variable name is needed as first argument\n");
+	AST_STANDARD_APP_ARGS(args, parse);
+	if (ast_strlen_zero(args.name) || ast_strlen_zero(args.key)) {
+		ast_log(LOG_WARNING, "a shared document name and a key field are required\n");
 		json_set_operation_result(chan, ASTJSON_ARG_NEEDED);
 		return 0;
 	}
-	if (ast_strlen_zero(args.path))
-		ast_log(LOG_WARNING, "path is empty, adding element to the root\n");
+	const char *name = S_OR(args.index, args.name);
+	int ret = json_index_create(name, args.name, S_OR(args.path, ""), args.key);
+	if (ret == ASTJSON_OK) {
+		struct json_index *index = ao2_find(json_indexes, name, OBJ_SEARCH_KEY);
+		if (index) {
+			snprintf(buffer, buflen, "%u", index->count);
+			ao2_ref(index, -1);
+		}
+	} else if (ret == ASTJSON_INVALID_TYPE)
+		ast_log(LOG_WARNING, "%s in %s is not an array\n", S_OR(args.path, "/"), args.name);
+	else if (ret == ASTJSON_NOTFOUND)
+		ast_log(LOG_WARNING, "no array at %s in shared json document %s\n", S_OR(args.path, "/"),
+			args.name);
+	json_set_operation_result(chan, ret);
+	return 0;
 
-	// create the object to add
-	struct ast_json *newobject = NULL;
-	if (ast_strlen_zero(args.type)) {
-		ast_log(LOG_WARNING, "an element type is needed (bool, null, number, string, array or object)\n");
+}
+
+static int json_lookup_exec(struct ast_channel *chan, 
+	const char *cmd, char *parse, struct ast_str **buf, ssize_t buflen
+) {
+// finds the element with the given key through the index of a shared document and gets elements
+//   out of it, like JSONGET; without a path, the whole element
+
+	json_set_operation_result(chan, ASTJSON_UNDECIDED);
+	ast_str_reset(*buf);
+
+	// parse the function arguments
+	AST_DECLARE_APP_ARGS(args,
+		AST_APP_ARG(name);
+		AST_APP_ARG(key);
+		AST_APP_ARG(path);
+	);
+	if (ast_strlen_zero(parse)) {
+		ast_log(LOG_WARNING, "json_lookup requires arguments (name,key,path)\n");
 		json_set_operation_result(chan, ASTJSON_ARG_NEEDED);
 		return 0;
-	} else {
-		// get the element type
-		if (strcasecmp(args.type, "bool") == 0)
-			newobject = (
-				(args.value == 0) || (strlen(args.value) == 0) || 
-				(strcasecmp(args.value, "0") == 0) ||
-				(strcasecmp(args.value, "no") == 0) || (strcasecmp(args.value, "n") == 0) ||
-				(strcasecmp(args.value, "false") == 0) || (strcasecmp(args.value, "f") == 0) 
-			) ? ast_json_false() : ast_json_true();
-		else if (strcasecmp(args.type, "null") == 0)
-			newobject = ast_json_null();
-		else if (strcasecmp(args.type, "number") == 0)
-			newobject = ast_json_real_create((double)atof(args.value));
-		else if (strcasecmp(args.type, "string") == 0)
-			newobject = ast_json_string_create(args.value);
-		else if (strcasecmp(args.type, "array") == 0)
-			newobject = ast_json_array_create();
-		else if (strcasecmp(args.type, "node") == 0)
-			newobject = ast_json_object_create();
-		else {
-			ast_log(LOG_WARNING, "invalid element type '%s'; need bool, null, number, string or array\n", args.type);
-			json_set_operation_result(chan, ASTJSON_ARG_NEEDED);
-			return 0;
-		}
 	}
-	// parse document
-	int ret = ASTJSON_NOTFOUND;
-	struct ast_json *doc; char *thispath;
-	const char *jsondoc = pbx_builtin_getvar_helper(chan, args.json);
-	if ((jsondoc == 0) || (strlen(jsondoc) == 0)) {
-		// variable containing document is missing or empty string, 
-		// it needs to be initialized as either {} or []
-		doc = (ast_strlen_zero(args.name)) ? ast_json_array_create() : ast_json_object_create();
-		thispath = "\0";
-	} else {
-		doc = ast_json_load_string(jsondoc, NULL);
-		if (!doc) {
-			ast_log(LOG_WARNING, "json document parsing error\n");
-			ast_json_unref(newobject);
-			json_set_operation_result(chan, ASTJSON_PARSE_ERROR);
-			return 0;
-		}
-		thispath = ast_strdupa((char *)(args.path + ((args.path[0] == '/') ? 1 : 0)));
-		if (thispath[strlen(thispath) - 1] == '/') thispath[strlen(thispath) - 1] = 0;
+	AST_STANDARD_APP_ARGS(args, parse);
+	if (ast_strlen_zero(args.name)) {
+		ast_log(LOG_WARNING, "a shared document name is required\n");
+		json_set_operation_result(chan, ASTJSON_ARG_NEEDED);
+		return 0;
 	}
-	// go over the path
-	if (strlen(thispath) == 0) {
-		// no path - add to the json root
-		ast_log(LOG_DEBUG, "no path, adding to root of doc which is type %d\n", ast_json_typeof(doc));
-		switch (ast_json_typeof(doc)) {
-		case AST_JSON_ARRAY:
-			if (ast_json_array_append(doc, newobject) == 0)
-				ret = ASTJSON_OK;
-			else
-				ret = ASTJSON_ADD_FAILED;
-			break;
-		case AST_JSON_OBJECT:
-			if (ast_json_object_set(doc, args.name, newobject) == 0)
-				ret = ASTJSON_OK;
-			else
-				ret = ASTJSON_ADD_FAILED;
-			break;
-		default:
-			ret = ASTJSON_ADD_FAILED;
-			break;
-		}
-	} else {
-		struct ast_json *thisobject = doc, *nextobject = NULL;
-		int ixarray;
-		char *pathpiece = strsep(&thispath, "/");
-		while (pathpiece) {
-			ast_log(LOG_DEBUG, "on element %s... ", pathpiece);
-			// determine if we have an object with the given name or index
-			if (sscanf(pathpiece, "%3d", &ixarray) == 1)
-				nextobject = ast_json_array_get(thisobject, ixarray);
-			else
-				nextobject = ast_json_object_get(thisobject, pathpiece);
-			if (nextobject == NULL) break; // path element not found
-			ast_log(LOG_DEBUG, "object is:\n%s\n", ast_json_dump_string_format(nextobject, 0));
-			pathpiece = strsep(&thispath, "/");
-			if (pathpiece == NULL) {
-				// done going down the path, add object here
-				ast_log(LOG_DEBUG, "adding to type %d\n", ast_json_typeof(nextobject));
-				switch (ast_json_typeof(nextobject)) {
-				case AST_JSON_ARRAY:
-					if (ast_json_array_append(nextobject, newobject) == 0)
-						ret = ASTJSON_OK;
-					else
-						ret = ASTJSON_ADD_FAILED;
-					break;
-				case AST_JSON_OBJECT:
-					if (ast_json_object_set(nextobject, args.name, newobject) == 0)
-						ret = ASTJSON_OK;
-					else
-						ret = ASTJSON_ADD_FAILED;
-					break;
-				default:
-					ret = ASTJSON_ADD_FAILED;
-					break;
-				}
-				break;
-			} else
-				thisobject = nextobject;
-		}
-		ast_free(thispath);
+	struct json_index *index = ao2_find(json_indexes, args.name, OBJ_SEARCH_KEY);
+	if (!index) {
+		ast_log(LOG_WARNING, "no json index %s\n", args.name);
+		json_set_operation_result(chan, ASTJSON_NOTFOUND);
+		return 0;
 	}
-	// regenerate the source json
-	char *jsonresult = ast_json_dump_string_format(doc, 0);
-	if (ret == ASTJSON_OK)
-		pbx_builtin_setvar_helper(chan, args.json, jsonresult);
-	// cleanup the mess and let's get outta here
-	ast_log(LOG_DEBUG, "resulting json: %s\n", jsonresult);
-	ast_free(jsonresult);
-	ast_json_unref(doc);
+	struct ast_json *element = json_index_lookup(index, S_OR(args.key, ""));
+	int ret = ASTJSON_NOTFOUND;
+	if (element && !ast_strlen_zero(args.path))
+		ret = json_get_paths(chan, element, args.path, buf, buflen);
+	else if (element) {
+		pbx_builtin_setvar_helper(chan, "JSONTYPE", json_value_str(element, buf, buflen));
+		ret = ASTJSON_OK;
+	}
+	ao2_ref(index, -1);
 	json_set_operation_result(chan, ret);
 	return 0;
 
 }
 
-static int jsonset_exec(struct ast_channel *chan, const char *data) {
-// sets the value of the element at the path indicated (like "/path/to/element/3/value") 
-// the new value must be of the same type as the existing element. you cannot set the value of
-//    existing null elements, or array elements: you can only delete or add them (then for the 
-//    arrays you would need to add the elements with repeated "add" operations)
-// regarding boolean values to be set, false is represented by an empty string, 0, n, no, f or false 
-//    (case insensitive) - anything else is considered true
-// rewrite the contents of the variable that contains the json source and set an error code variable
+static int json_lpm_exec(struct ast_channel *chan, 
+	const char *cmd, char *parse, struct ast_str **buf, ssize_t buflen
+) {
+// finds the longest prefix of a number in a table of prefixes and returns what the table has for
+//   it (or the elements at the given paths inside that); the prefix itself goes into JSONPREFIX
 
 	json_set_operation_result(chan, ASTJSON_UNDECIDED);
+	ast_str_reset(*buf);
 
-	// parse the app arguments
-	char *argcopy;
+	// parse the function arguments
 	AST_DECLARE_APP_ARGS(args,
-		AST_APP_ARG(json);
+		AST_APP_ARG(table);
+		AST_APP_ARG(number);
 		AST_APP_ARG(path);
-		AST_APP_ARG(value);
 	);
-	if (ast_strlen_zero(data)) {
-		ast_log(LOG_WARNING, "jsonset requires arguments (jsonvarname,path,value)\n");
+	if (ast_strlen_zero(parse)) {
+		ast_log(LOG_WARNING, "json_lpm requires arguments (table,number,field)\n");
 		json_set_operation_result(chan, ASTJSON_ARG_NEEDED);
 		return 0;
 	}
-	argcopy = ast_strdupa(data);
-	AST_STANDARD_APP_ARGS(args, argcopy);
-	if (!ast_strlen_zero(args.json))
-		ast_log(LOG_DEBUG, "getting json and setting result back into variable '%s'\n", args.json);
-	else {
-		ast_log(LOG_WARNING, "a valid dialplan variable name is needed as first argument\n");
+	AST_STANDARD_APP_ARGS(args, parse);
+	if (ast_strlen_zero(args.table)) {
+		ast_log(LOG_WARNING, "a table name is required\n");
 		json_set_operation_result(chan, ASTJSON_ARG_NEEDED);
 		return 0;
 	}
-	if (ast_strlen_zero(args.path))
-		ast_log(LOG_WARNING, "path is empty, adding element to the root\n");
-
-	// parse source
-	struct ast_json *doc;
-	const char *source = pbx_builtin_getvar_helper(chan, args.json);
-	if (strlen(source) == 0) {
-		ast_log(LOG_WARNING, "source json is empty\n");
-		json_set_operation_result(chan, ASTJSON_INVALID_TYPE);
+	int ret;
+	struct json_lpm *lpm = json_compiled_get(json_lpms, &json_lpm_lock, json_lpm_build, args.table,
+		&ret);
+	if (!lpm) {
+		ast_log(LOG_WARNING, "no prefix table %s in the shared json documents\n", args.table);
+		json_set_operation_result(chan, ret);
 		return 0;
 	}
-	doc = ast_json_load_string(source, NULL);
-	if (!doc) {
-		ast_log(LOG_WARNING, "source json parsing error\n");
-		json_set_operation_result(chan, ASTJSON_PARSE_ERROR);
+	const struct json_lpm_node *match = json_lpm_match(lpm, S_OR(args.number, ""));
+	ret = ASTJSON_NOTFOUND;
+	if (match) {
+		pbx_builtin_setvar_helper(chan, "JSONPREFIX", match->prefix);
+		if (!ast_strlen_zero(args.path))
+			ret = json_get_paths(chan, match->value, args.path, buf, buflen);
+		else {
+			pbx_builtin_setvar_helper(chan, "JSONTYPE", json_value_str(match->value, buf, buflen));
+			ret = ASTJSON_OK;
+		}
+	}
+	ao2_ref(lpm, -1);
+	json_set_operation_result(chan, ret);
+	return 0;
+
+}
+
+static int json_template_exec(struct ast_channel *chan, 
+	const char *cmd, char *parse, struct ast_str **buf, ssize_t buflen
+) {
+// renders a template from res_json.conf with the variables of the channel
+
+	json_set_operation_result(chan, ASTJSON_UNDECIDED);
+	ast_str_reset(*buf);
+
+	char *name = ast_strip(parse);
+	if (ast_strlen_zero(name)) {
+		ast_log(LOG_WARNING, "json_template requires an argument (name)\n");
+		json_set_operation_result(chan, ASTJSON_ARG_NEEDED);
 		return 0;
 	}
-	// go over the path
-	int ret = ASTJSON_NOTFOUND;
-	char *thispath = ast_strdupa((char *)(args.path + ((args.path[0] == '/') ? 1 : 0)));
-	if (thispath[strlen(thispath) - 1] == '/') thispath[strlen(thispath) - 1] = 0;
-	if (strlen(thispath) == 0) {
-		ast_log(LOG_WARNING, "invalid path to the object we want to set\n");
+	struct ao2_container *templates = json_config_current()->templates;
+	struct json_template *template = templates ? ao2_find(templates, name, OBJ_SEARCH_KEY) : NULL;
+	if (!template) {
+		ast_log(LOG_WARNING, "no json template %s\n", name);
 		json_set_operation_result(chan, ASTJSON_NOTFOUND);
 		return 0;
 	}
-	struct ast_json *thisobject = doc, *nextobject = NULL, *newobject = NULL;
-	int ixarray;
-	char *pathpiece = strsep(&thispath, "/");
-	char *key;
-	while (pathpiece) {
-		// determine if we have an object with the given name or index
-		if (sscanf(pathpiece, "%3d", &ixarray) == 1)
-			nextobject = ast_json_array_get(thisobject, ixarray);
-		else
-			nextobject = ast_json_object_get(thisobject, pathpiece);
-		if (nextobject == NULL) break; // path element not found
-		key = pathpiece;
-		pathpiece = strsep(&thispath, "/");
-		if (pathpiece == NULL) {
-			newobject = NULL;
-			// done going down the path, this is the object we want to change the value for
-			switch (ast_json_typeof(nextobject)) {
-			case AST_JSON_FALSE:
-			case AST_JSON_TRUE:
-				newobject = (
-					(args.value == 0) || (strlen(args.value) == 0) || 
-					(strcasecmp(args.value, "0") == 0) ||
-					(strcasecmp(args.value, "no") == 0) || (strcasecmp(args.value, "n") == 0) ||
-					(strcasecmp(args.value, "false") == 0) || (strcasecmp(args.value, "f") == 0) 
-				) ? ast_json_false() : ast_json_true();
-				break;
-			case AST_JSON_NULL:
-				break;
-			case AST_JSON_REAL:
-				newobject = ast_json_real_create((double)atof(args.value));
-				break;
-			case AST_JSON_INTEGER:
-				newobject = ast_json_integer_create(atoi(args.value));
-			case AST_JSON_STRING:
-				newobject = ast_json_string_create(args.value);
-				break;
-			case AST_JSON_ARRAY:
-				break;
-			case AST_JSON_OBJECT:
-				newobject = ast_json_load_string(args.value, NULL);
-				break;
-			default:
-				break;
-			}
-			if (newobject) {
-				enum ast_json_type type;
-				type = ast_json_typeof(thisobject);
-				// replace in the parent object with what we've just created here
-				ret = ASTJSON_OK;
-				if (type == AST_JSON_ARRAY) {
-					if (ast_json_array_set(thisobject, ixarray, newobject) != 0)
-						ret = ASTJSON_SET_FAILED;
-				} else if (type == AST_JSON_OBJECT) {
-					if (ast_json_object_set(thisobject, key, newobject) != 0)
-						ret = ASTJSON_SET_FAILED;
-				} else
-					ret = ASTJSON_SET_FAILED;
-			} else
-				ret = ASTJSON_INVALID_TYPE;
-			break;
-		} else
-			thisobject = nextobject;
-	}
-	// regenerate the source json
-	char *jsonresult = ast_json_dump_string_format(doc, 0);
-	if (ret == ASTJSON_OK)
-		pbx_builtin_setvar_helper(chan, args.json, jsonresult);
-	// cleanup the mess and let's get outta here
-	ast_free(jsonresult);
-	ast_json_unref(doc);
+	int ret = json_template_render(chan, template, buf, buflen);
+	struct json_stats_call *call = json_stats_current();
+	if (call)
+		call->serialized += ast_str_strlen(*buf);
+	if (json_limits_output(buf, 0))
+		ret = ASTJSON_LIMIT;
+	ao2_ref(template, -1);
 	json_set_operation_result(chan, ret);
 	return 0;
 
 }
 
-static int jsondelete_exec(struct ast_channel *chan, const char *data) {
-// delete a json element in a path (like "/path/to/element/3/value")  
-// rewrite the contents of the variable that contains the json source and set an error code variable
+static int json_member_exec(struct ast_channel *chan, 
+	const char *cmd, char *parse, char *buffer, size_t buflen
+) {
+// returns 1 if a value is in a set (an array in a shared document), 0 if it is not
 
 	json_set_operation_result(chan, ASTJSON_UNDECIDED);
+	buffer[0] = 0;
 
-	// parse the app arguments
-	char *argcopy;
+	// parse the function arguments
 	AST_DECLARE_APP_ARGS(args,
-		AST_APP_ARG(jsonvarname);
-		AST_APP_ARG(path);
+		AST_APP_ARG(set);
+		AST_APP_ARG(value);
 	);
-	if (ast_strlen_zero(data)) {
-		ast_log(LOG_WARNING, "jsondelete requires arguments (jsonvarname,path)\n");
+	if (ast_strlen_zero(parse)) {
+		ast_log(LOG_WARNING, "json_member requires arguments (setname,value)\n");
 		json_set_operation_result(chan, ASTJSON_ARG_NEEDED);
 		return 0;
 	}
-	argcopy = ast_strdupa(data);
-	AST_STANDARD_APP_ARGS(args, argcopy);
-	if (!ast_strlen_zero(args.jsonvarname))
-		ast_log(LOG_DEBUG, "setting result into variable '%s'\n", args.jsonvarname);
-	else {
-		ast_log(LOG_WARNING, "a valid dialplan variable name is needed as first argument\n");
+	AST_STANDARD_APP_ARGS(args, parse);
+	if (ast_strlen_zero(args.set)) {
+		ast_log(LOG_WARNING, "a set name is required\n");
 		json_set_operation_result(chan, ASTJSON_ARG_NEEDED);
 		return 0;
 	}
-	if (ast_strlen_zero(args.path)) {
-		ast_log(LOG_WARNING, "path is empty, will not delete the whole doc\n");
-		json_set_operation_result(chan, ASTJSON_OK);
-		return 0;
-	}
-	// parse source
-	struct ast_json *doc;
-	const char *source = pbx_builtin_getvar_helper(chan, args.jsonvarname);
-	if (strlen(source)) {
-		doc = ast_json_load_string(source, NULL);
-		if (!doc) {
-			ast_log(LOG_WARNING, "source json parsing error\n");
-			json_set_operation_result(chan, ASTJSON_PARSE_ERROR);
-			return 0;
-		}
-	} else {
-		ast_log(LOG_WARNING, "source json is 0-length, delete would have no effect\n");
-		json_set_operation_result(chan, ASTJSON_NOTFOUND);
+	int ret;
+	struct json_set *set = json_compiled_get(json_sets, &json_set_lock, json_set_build, args.set,
+		&ret);
+	if (!set) {
+		ast_log(LOG_WARNING, "no set %s in the shared json documents\n", args.set);
+		json_set_operation_result(chan, ret);
 		return 0;
 	}
-	// go over the path
-	char *thispath = ast_strdupa((char *)(args.path + ((args.path[0] == '/') ? 1 : 0)));
-	if (thispath[strlen(thispath) - 1] == '/') thispath[strlen(thispath) - 1] = 0;
-	struct ast_json *thisobject = doc, *nextobject;
-	int ixarray;
-	char *deleteitem = NULL;
-	char *pathpiece = strsep(&thispath, "/");
-	int ret = ASTJSON_NOTFOUND;
-	while (pathpiece) {
-		deleteitem = ast_strdupa(pathpiece);
-		// determine if we have an object with the given name or index
-		if (sscanf(pathpiece, "%3d", &ixarray) == 1)
-			nextobject = ast_json_array_get(thisobject, ixarray);
-		else
-			nextobject = ast_json_object_get(thisobject, pathpiece);
-		if (!nextobject) break;
-		char *pathpiece = strsep(&thispath, "/");
-		if (pathpiece)
-			thisobject = nextobject;
-		else
-			// got to the end of our path, we need to delete 'nextobject' from 'thisobject'
-			switch (ast_json_typeof(thisobject)) {
-			case AST_JSON_ARRAY:
-				if (ast_json_array_remove(thisobject, ixarray) == 0)
-					ret = ASTJSON_OK;
-				break;
-			case AST_JSON_OBJECT:
-				if (ast_json_object_del(thisobject, deleteitem) == 0)
-					ret = ASTJSON_OK;
-				break;
-			default:
-				ret = ASTJSON_DELETE_FAILED;
-				break;
-			}
-	}
-
-	// regenerate the source json
-	char *jsonresult = ast_json_dump_string_format(doc, 0);
-	if (ret == ASTJSON_OK)
-		pbx_builtin_setvar_helper(chan, args.jsonvarname, jsonresult); 
-	ast_free(jsonresult);
-	ast_json_unref(doc);
-	json_set_operation_result(chan, ret);
+	ast_copy_string(buffer, json_set_contains(set, S_OR(args.value, "")) ? "1" : "0", buflen);
+	ao2_ref(set, -1);
+	json_set_operation_result(chan, ASTJSON_OK);
 	return 0;
 
 }
 
+// the functions and apps are registered through wrappers that keep their statistics
+#define JSON_STATS_FUNCTION(exec, id) \
+	static int exec##_counted(struct ast_channel *chan, \
+		const char *cmd, char *parse, char *buffer, size_t buflen \
+	) { \
+		struct json_stats_call *call = json_stats_begin(id); \
+		int res = exec(chan, cmd, parse, buffer, buflen); \
+		json_stats_end(call); \
+		return res; \
+	}
+#define JSON_STATS_FUNCTION_STR(exec, id) \
+	static int exec##_counted(struct ast_channel *chan, \
+		const char *cmd, char *parse, struct ast_str **buf, ssize_t len \
+	) { \
+		struct json_stats_call *call = json_stats_begin(id); \
+		int res = exec(chan, cmd, parse, buf, len); \
+		json_stats_end(call); \
+		return res; \
+	}
+#define JSON_STATS_FUNCTION_WRITE(exec, id) \
+	static int exec##_counted(struct ast_channel *chan, \
+		const char *cmd, char *parse, const char *value \
+	) { \
+		struct json_stats_call *call = json_stats_begin(id); \
+		int res = exec(chan, cmd, parse, value); \
+		json_stats_end(call); \
+		return res; \
+	}
+#define JSON_STATS_APP(exec, id) \
+	static int exec##_counted(struct ast_channel *chan, const char *data) { \
+		struct json_stats_call *call = json_stats_begin(id); \
+		int res = exec(chan, data); \
+		json_stats_end(call); \
+		return res; \
+	}
+
+JSON_STATS_FUNCTION_STR(jsonpretty_exec, JSON_STATS_JSONPRETTY)
+JSON_STATS_FUNCTION_STR(jsoncompress_exec, JSON_STATS_JSONCOMPRESS)
+JSON_STATS_FUNCTION_STR(jsonget_exec, JSON_STATS_JSONGET)
+JSON_STATS_APP(jsonvariables_exec, JSON_STATS_JSONVARIABLES)
+JSON_STATS_APP(jsonadd_exec, JSON_STATS_JSONADD)
+JSON_STATS_APP(jsonset_exec, JSON_STATS_JSONSET)
+JSON_STATS_APP(jsondelete_exec, JSON_STATS_JSONDELETE)
+JSON_STATS_APP(jsonedit_exec, JSON_STATS_JSONEDIT)
+JSON_STATS_APP(jsonpatch_exec, JSON_STATS_JSONPATCH)
+JSON_STATS_APP(jsonmergepatch_exec, JSON_STATS_JSONMERGEPATCH)
+JSON_STATS_FUNCTION(json_open_exec, JSON_STATS_JSON_OPEN)
+JSON_STATS_FUNCTION(json_close_exec, JSON_STATS_JSON_CLOSE)
+JSON_STATS_FUNCTION(json_iter_exec, JSON_STATS_JSON_ITER)
+JSON_STATS_FUNCTION(json_next_exec, JSON_STATS_JSON_NEXT)
+JSON_STATS_FUNCTION(json_flush_exec, JSON_STATS_JSON_FLUSH)
+JSON_STATS_FUNCTION_STR(json_shared_exec, JSON_STATS_JSON_SHARED)
+JSON_STATS_FUNCTION_WRITE(json_shared_write, JSON_STATS_JSON_SHARED)
+JSON_STATS_FUNCTION_STR(jsonfile_exec, JSON_STATS_JSONFILE)
+JSON_STATS_FUNCTION(json_index_create_exec, JSON_STATS_JSON_INDEX_CREATE)
+JSON_STATS_FUNCTION_STR(json_lookup_exec, JSON_STATS_JSON_LOOKUP)
+JSON_STATS_FUNCTION_STR(json_lpm_exec, JSON_STATS_JSON_LPM)
+JSON_STATS_FUNCTION(json_member_exec, JSON_STATS_JSON_MEMBER)
+JSON_STATS_FUNCTION_STR(json_template_exec, JSON_STATS_JSON_TEMPLATE)
+JSON_STATS_FUNCTION(jsonvalid_exec, JSON_STATS_JSONVALID)
+
 static struct ast_custom_function acf_jsonpretty = {
 	.name = "JSONPRETTY",
-	.read = jsonpretty_exec
+	.read2 = jsonpretty_exec_counted
 };
 static struct ast_custom_function acf_jsoncompress = {
 	.name = "JSONCOMPRESS",
-	.read = jsoncompress_exec
+	.read2 = jsoncompress_exec_counted
 };
 static struct ast_custom_function acf_jsonget = {
 	.name = "JSONGET",
-	.read = jsonget_exec
+	.read2 = jsonget_exec_counted
+};
+static struct ast_custom_function acf_json_open = {
+	.name = "JSON_OPEN",
+	.read = json_open_exec_counted
+};
+static struct ast_custom_function acf_json_close = {
+	.name = "JSON_CLOSE",
+	.read = json_close_exec_counted
 };
+static struct ast_custom_function acf_json_iter = {
+	.name = "JSON_ITER",
+	.read = json_iter_exec_counted
+};
+static struct ast_custom_function acf_json_next = {
+	.name = "JSON_NEXT",
+	.read = json_next_exec_counted
+};
+static struct ast_custom_function acf_json_flush = {
+	.name = "JSON_FLUSH",
+	.read = json_flush_exec_counted
+};
+static struct ast_custom_function acf_json_shared = {
+	.name = "JSON_SHARED",
+	.read2 = json_shared_exec_counted,
+	.write = json_shared_write_counted
+};
+static struct ast_custom_function acf_jsonfile = {
+	.name = "JSONFILE",
+	.read2 = jsonfile_exec_counted
+};
+static struct ast_custom_function acf_json_index_create = {
+	.name = "JSON_INDEX_CREATE",
+	.read = json_index_create_exec_counted
+};
+static struct ast_custom_function acf_json_lookup = {
+	.name = "JSON_LOOKUP",
+	.read2 = json_lookup_exec_counted
+};
+static struct ast_custom_function acf_json_lpm = {
+	.name = "JSON_LPM",
+	.read2 = json_lpm_exec_counted
+};
+static struct ast_custom_function acf_json_template = {
+	.name = "JSON_TEMPLATE",
+	.read2 = json_template_exec_counted
+};
+static struct ast_custom_function acf_json_member = {
+	.name = "JSON_MEMBER",
+	.read = json_member_exec_counted
+};
+static struct ast_custom_function acf_jsonvalid = {
+	.name = "JSONVALID",
+	.read = jsonvalid_exec_counted
+};
+
+static void json_config_limit(struct ast_variable *var, size_t *limit) {
+// reads one of the limits of res_json.conf: a number of bytes (or of levels, values), 0 for none
+	size_t value;
+	if (!json_parse_count(var->value, &value))
+		*limit = value;
+	else
+		ast_log(LOG_WARNING, "invalid %s '%s' in %s, using no limit\n", var->name, var->value,
+			JSON_CONFIG_FILE);
+}
+
+static void json_config_shared(const char *name, const char *value) {
+// publishes a shared document read from a file named in res_json.conf
+	char filename[PATH_MAX];
+	struct ast_json *doc;
+	size_t size;
+	json_config_path(value, filename, sizeof(filename));
+	if (json_file_parse(filename, &doc, &size) == ASTJSON_OK)
+		json_shared_set(name, doc, size, 0);
+}
+
+static int json_config_load(int reload) {
+// reads res_json.conf into new settings and swaps them in; a missing file gives the defaults. a
+//   reload that finds the file invalid keeps the settings running. returns -1 if there are none
+	struct ast_flags flags = { 0 };
+	struct ast_config *cfg = ast_config_load(JSON_CONFIG_FILE, flags);
+	if (cfg == CONFIG_STATUS_FILEINVALID) {
+		if (reload) {
+			ast_log(LOG_WARNING, "%s is invalid, keeping the current settings\n", JSON_CONFIG_FILE);
+			return 0;
+		}
+		ast_log(LOG_WARNING, "%s is invalid, using the default settings\n", JSON_CONFIG_FILE);
+		cfg = NULL;
+	}
+	struct json_config *config = ao2_alloc_options(sizeof(*config), json_config_destroy,
+		AO2_ALLOC_OPT_LOCK_NOLOCK);
+	if (config) {
+		*config = json_config_defaults;
+		config->templates = ao2_container_alloc_hash(AO2_ALLOC_OPT_LOCK_RWLOCK,
+			AO2_CONTAINER_ALLOC_OPT_DUPS_REPLACE, JSON_TEMPLATE_BUCKETS,
+			json_template_hash_fn, NULL, json_template_cmp_fn);
+	}
+	if (!config || !config->templates) {
+		ao2_cleanup(config);
+		if (cfg)
+			ast_config_destroy(cfg);
+		return -1;
+	}
+	if (!cfg) {
+		json_config_publish(config);
+		return 0;
+	}
+
+	struct ast_variable *var;
+	size_t depth = 0, cache_docs = config->cache_docs, path_cache = config->path_cache;
+	for (var = ast_variable_browse(cfg, "general"); var; var = var->next) {
+		if (!strcasecmp(var->name, "writeback")) {
+			if (!strcasecmp(var->value, "lazy"))
+				config->writeback_lazy = 1;
+			else if (strcasecmp(var->value, "immediate"))
+				ast_log(LOG_WARNING, "invalid writeback '%s' in %s, using immediate\n",
+					var->value, JSON_CONFIG_FILE);
+		} else if (!strcasecmp(var->name, "maxsize"))
+			json_config_limit(var, &config->limits.size);
+		else if (!strcasecmp(var->name, "maxdepth"))
+			json_config_limit(var, &depth);
+		else if (!strcasecmp(var->name, "maxelements"))
+			json_config_limit(var, &config->limits.elements);
+		else if (!strcasecmp(var->name, "maxoutput"))
+			json_config_limit(var, &config->limits.output);
+		else if (!strcasecmp(var->name, "cachedocs"))
+			json_config_limit(var, &cache_docs);
+		else if (!strcasecmp(var->name, "pathcache"))
+			json_config_limit(var, &path_cache);
+		else
+			ast_log(LOG_WARNING, "unknown setting '%s' in %s\n", var->name, JSON_CONFIG_FILE);
+	}
+	// deeper than the parser goes is no limit at all
+	config->limits.depth = (depth < JSON_SCAN_MAX_DEPTH) ? depth : 0;
+	config->cache_docs = MAX(1, MIN(cache_docs, JSON_CACHE_MAX_DOCS));
+	config->path_cache = MAX(1, MIN(path_cache, UINT_MAX));
+	// the templates, each name = json text or name = file
+	for (var = ast_variable_browse(cfg, "templates"); var; var = var->next)
+		json_template_load(config->templates, var->name, var->value);
+	// the shared documents published from files, each name = file
+	for (var = ast_variable_browse(cfg, "shared"); var; var = var->next)
+		json_config_shared(var->name, var->value);
+	ast_config_destroy(cfg);
+	json_config_publish(config);
+	return 0;
+}
 
 static int load_module(void) {
 	int ret = 0;
+	json_scan_init();
+	json_set_init();
+	json_shared_docs = ao2_container_alloc_hash(AO2_ALLOC_OPT_LOCK_RWLOCK,
+		AO2_CONTAINER_ALLOC_OPT_DUPS_REPLACE, JSON_SHARED_BUCKETS,
+		json_shared_hash_fn, NULL, json_shared_cmp_fn);
+	json_indexes = ao2_container_alloc_hash(AO2_ALLOC_OPT_LOCK_RWLOCK,
+		AO2_CONTAINER_ALLOC_OPT_DUPS_REPLACE, JSON_SHARED_BUCKETS,
+		json_index_hash_fn, NULL, json_index_cmp_fn);
+	json_lpms = ao2_container_alloc_hash(AO2_ALLOC_OPT_LOCK_RWLOCK,
+		AO2_CONTAINER_ALLOC_OPT_DUPS_REPLACE, JSON_SHARED_BUCKETS,
+		json_lpm_hash_fn, NULL, json_lpm_cmp_fn);
+	json_sets = ao2_container_alloc_hash(AO2_ALLOC_OPT_LOCK_RWLOCK,
+		AO2_CONTAINER_ALLOC_OPT_DUPS_REPLACE, JSON_SHARED_BUCKETS,
+		json_set_hash_fn, NULL, json_set_cmp_fn);
+	json_file_misses = ao2_container_alloc_hash(AO2_ALLOC_OPT_LOCK_RWLOCK,
+		AO2_CONTAINER_ALLOC_OPT_DUPS_REPLACE, JSON_SHARED_BUCKETS,
+		json_file_miss_hash_fn, NULL, json_file_miss_cmp_fn);
+	if (!json_shared_docs || !json_indexes || !json_lpms || !json_sets || !json_file_misses
+		|| json_config_load(0)
+	) {
+		ao2_cleanup(json_shared_docs);
+		ao2_cleanup(json_indexes);
+		ao2_cleanup(json_lpms);
+		ao2_cleanup(json_sets);
+		ao2_cleanup(json_file_misses);
+		return AST_MODULE_LOAD_DECLINE;
+	}
+	json_watch_start();
+	ret |= ast_cli_register_multiple(cli_json, ARRAY_LEN(cli_json));
 	ret |= ast_custom_function_register(&acf_jsonpretty);
 	ret |= ast_custom_function_register(&acf_jsoncompress);
 	ret |= ast_custom_function_register(&acf_jsonget);
-	ret |= ast_register_application_xml(app_jsonvariables, jsonvariables_exec);
-	ret |= ast_register_application_xml(app_jsonadd, jsonadd_exec);
-	ret |= ast_register_application_xml(app_jsonset, jsonset_exec);
-	ret |= ast_register_application_xml(app_jsondelete, jsondelete_exec);
+	ret |= ast_custom_function_register(&acf_json_open);
+	ret |= ast_custom_function_register(&acf_json_close);
+	ret |= ast_custom_function_register(&acf_json_iter);
+	ret |= ast_custom_function_register(&acf_json_next);
+	ret |= ast_custom_function_register(&acf_json_flush);
+	ret |= ast_custom_function_register(&acf_json_shared);
+	ret |= ast_custom_function_register_escalating(&acf_jsonfile, AST_CFE_READ);
+	ret |= ast_custom_function_register(&acf_json_index_create);
+	ret |= ast_custom_function_register(&acf_json_lookup);
+	ret |= ast_custom_function_register(&acf_json_lpm);
+	ret |= ast_custom_function_register(&acf_json_member);
+	ret |= ast_custom_function_register(&acf_json_template);
+	ret |= ast_custom_function_register(&acf_jsonvalid);
+	ret |= ast_register_application_xml(app_jsonvariables, jsonvariables_exec_counted);
+	ret |= ast_register_application_xml(app_jsonadd, jsonadd_exec_counted);
+	ret |= ast_register_application_xml(app_jsonset, jsonset_exec_counted);
+	ret |= ast_register_application_xml(app_jsondelete, jsondelete_exec_counted);
+	ret |= ast_register_application_xml(app_jsonedit, jsonedit_exec_counted);
+	ret |= ast_register_application_xml(app_jsonpatch, jsonpatch_exec_counted);
+	ret |= ast_register_application_xml(app_jsonmergepatch, jsonmergepatch_exec_counted);
 	return ret;
 }
 
 static int unload_module(void) {
 	int ret = 0;
+	ret |= ast_cli_unregister_multiple(cli_json, ARRAY_LEN(cli_json));
 	ret |= ast_custom_function_unregister(&acf_jsonpretty);
 	ret |= ast_custom_function_unregister(&acf_jsoncompress);
 	ret |= ast_custom_function_unregister(&acf_jsonget);
+	ret |= ast_custom_function_unregister(&acf_json_open);
+	ret |= ast_custom_function_unregister(&acf_json_close);
+	ret |= ast_custom_function_unregister(&acf_json_iter);
+	ret |= ast_custom_function_unregister(&acf_json_next);
+	ret |= ast_custom_function_unregister(&acf_json_flush);
+	ret |= ast_custom_function_unregister(&acf_json_shared);
+	ret |= ast_custom_function_unregister(&acf_jsonfile);
+	ret |= ast_custom_function_unregister(&acf_json_index_create);
+	ret |= ast_custom_function_unregister(&acf_json_lookup);
+	ret |= ast_custom_function_unregister(&acf_json_lpm);
+	ret |= ast_custom_function_unregister(&acf_json_member);
+	ret |= ast_custom_function_unregister(&acf_json_template);
+	ret |= ast_custom_function_unregister(&acf_jsonvalid);
 	ret |= ast_unregister_application(app_jsonvariables);
 	ret |= ast_unregister_application(app_jsonadd);
 	ret |= ast_unregister_application(app_jsonset);
 	ret |= ast_unregister_application(app_jsondelete);
+	ret |= ast_unregister_application(app_jsonedit);
+	ret |= ast_unregister_application(app_jsonpatch);
+	ret |= ast_unregister_application(app_jsonmergepatch);
+	json_path_cache_flush();
+	json_watch_stop();
+	ao2_cleanup(json_indexes);
+	json_indexes = NULL;
+	ao2_cleanup(json_lpms);
+	json_lpms = NULL;
+	ao2_cleanup(json_sets);
+	json_sets = NULL;
+	ao2_cleanup(json_file_misses);
+	json_file_misses = NULL;
+	json_config_publish(NULL);
+	ao2_cleanup(json_shared_docs);
+	json_shared_docs = NULL;
 	return ret;
 }
 
-AST_MODULE_INFO_STANDARD(ASTERISK_GPL_KEY, "json parser and builder functions");
+static int reload_module(void) {
+	return json_config_load(1) ? AST_MODULE_LOAD_DECLINE : AST_MODULE_LOAD_SUCCESS;
+}
+
+AST_MODULE_INFO(ASTERISK_GPL_KEY, AST_MODFLAG_LOAD_ORDER, "json parser and builder functions",
+	.load = load_module,
+	.unload = unload_module,
+	.reload = reload_module,
+	.load_pri = AST_MODPRI_DEFAULT,
+	.support_level = AST_MODULE_SUPPORT_CORE,
+);